@@ -0,0 +1,110 @@
+// Cache hit throughput in millions of gets per second as threads are added, for a single
+// shard (one lock, what every hit used to serialize on) and for the default shard count.
+//
+//   ./build/bin/cache_bench [max_threads] [milliseconds]
+
+#include "cache.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr size_t KEY_COUNT = 1024;
+constexpr size_t ENTRY_SIZE = 16 * 1024;
+
+std::vector<std::string> make_keys() {
+    std::vector<std::string> keys;
+    for (size_t i = 0; i < KEY_COUNT; ++i) {
+        keys.push_back("./public/static/assets/file-" + std::to_string(i) + ".js");
+    }
+    return keys;
+}
+
+// Every thread hits keys in its own order for duration, returns total gets per second
+double hits_per_second(LRUCache& cache, const std::vector<std::string>& keys, size_t threads,
+                       std::chrono::milliseconds duration) {
+    std::atomic<bool> start{false};
+    std::atomic<bool> stop{false};
+    std::vector<size_t> counts(threads, 0);
+    std::vector<std::thread> workers;
+
+    for (size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            while (!start.load(std::memory_order_acquire)) {
+                std::this_thread::yield();
+            }
+            size_t index = t * 7919;
+            size_t count = 0;
+            while (!stop.load(std::memory_order_relaxed)) {
+                for (int i = 0; i < 64; ++i) {
+                    index = (index + 104729) % keys.size();
+                    if (cache.get(keys[index])) {
+                        ++count;
+                    }
+                }
+            }
+            counts[t] = count;
+        });
+    }
+
+    auto begin = std::chrono::steady_clock::now();
+    start.store(true, std::memory_order_release);
+    std::this_thread::sleep_for(duration);
+    stop.store(true);
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    size_t total = 0;
+    for (size_t count : counts) {
+        total += count;
+    }
+    return total / seconds;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t max_threads = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : std::max(1u, std::thread::hardware_concurrency());
+    long milliseconds = argc > 2 ? std::strtol(argv[2], nullptr, 10) : 500;
+    if (max_threads == 0 || milliseconds <= 0) {
+        std::cerr << "Usage: " << argv[0] << " [max_threads] [milliseconds]" << std::endl;
+        return 1;
+    }
+
+    std::vector<std::string> keys = make_keys();
+    std::vector<char> data(ENTRY_SIZE, 'x');
+
+    //room for every key, so each get is a hit
+    LRUCache single(256, 0, EvictionPolicyType::LRU, 1);
+    LRUCache sharded(256, 0);
+    for (const auto& key : keys) {
+        single.put(key, data, "application/javascript");
+        sharded.put(key, data, "application/javascript");
+    }
+
+    std::printf("\nCache hits, %zu keys of %zu KB, Mgets/s\n\n", KEY_COUNT, ENTRY_SIZE / 1024);
+    std::printf("%-8s %14s %14s\n", "Threads", "1 shard", std::to_string(sharded.get_shard_count()).append(" shards").c_str());
+
+    //powers of two, then max_threads itself
+    std::vector<size_t> thread_counts;
+    for (size_t threads = 1; threads < max_threads; threads *= 2) {
+        thread_counts.push_back(threads);
+    }
+    thread_counts.push_back(max_threads);
+
+    for (size_t threads : thread_counts) {
+        double one = hits_per_second(single, keys, threads, std::chrono::milliseconds(milliseconds));
+        double many = hits_per_second(sharded, keys, threads, std::chrono::milliseconds(milliseconds));
+        std::printf("%-8zu %14.2f %14.2f\n", threads, one / 1e6, many / 1e6);
+    }
+    return 0;
+}
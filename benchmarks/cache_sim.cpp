@@ -0,0 +1,147 @@
+// Replays an access trace against the file cache once per eviction policy and reports hit
+// and byte hit ratios. The trace is an access log in common or combined format, whose
+// request path is the key and whose response size is the entry size, or lines of
+// "key size". Without one, a synthetic trace is generated: a Zipf-distributed hot set
+// with crawler scans of one-off files mixed in.
+//
+//   ./build/bin/cache_sim [cache_mb] [access_log]
+
+#include "cache.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Access {
+    std::string key;
+    size_t size;
+};
+
+// "1.2.3.4 - - [date] "GET /path HTTP/1.1" 200 5120 ..." or "key size"
+bool parse_line(const std::string& line, Access& access) {
+    size_t request = line.find('"');
+    if (request != std::string::npos) {
+        size_t request_end = line.find('"', request + 1);
+        if (request_end == std::string::npos) {
+            return false;
+        }
+        std::istringstream request_line(line.substr(request + 1, request_end - request - 1));
+        std::string method;
+        request_line >> method >> access.key;
+        if (method != "GET" || access.key.empty()) {
+            return false;
+        }
+
+        //status, then the response size, "-" when there was no body
+        std::istringstream rest(line.substr(request_end + 1));
+        std::string status, size;
+        rest >> status >> size;
+        if (status.empty() || status[0] != '2' || size.empty() || size == "-") {
+            return false;
+        }
+        access.size = std::strtoull(size.c_str(), nullptr, 10);
+        return access.size > 0;
+    }
+
+    std::istringstream fields(line);
+    return static_cast<bool>(fields >> access.key >> access.size) && access.size > 0;
+}
+
+std::vector<Access> load_trace(const char* path) {
+    std::vector<Access> trace;
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        std::cerr << "Could not open " << path << std::endl;
+        return trace;
+    }
+    std::string line;
+    Access access;
+    while (std::getline(file, line)) {
+        if (parse_line(line, access)) {
+            trace.push_back(access);
+        }
+    }
+    return trace;
+}
+
+// Hot files drawn with Zipf(0.9) popularity, and every so often a crawl of distinct cold files
+// large enough on its own to flush a plain LRU cache of cache_bytes
+std::vector<Access> synthetic_trace(size_t cache_bytes) {
+    constexpr size_t HOT_FILES = 4000;
+    constexpr size_t FILE_SIZE = 16 * 1024;
+    constexpr size_t REQUESTS = 400000;
+
+    std::vector<double> cumulative(HOT_FILES);
+    double total = 0;
+    for (size_t i = 0; i < HOT_FILES; ++i) {
+        total += 1.0 / std::pow(static_cast<double>(i + 1), 0.9);
+        cumulative[i] = total;
+    }
+
+    std::mt19937_64 generator(42);
+    std::uniform_real_distribution<double> uniform(0, total);
+    size_t scan_length = cache_bytes / FILE_SIZE * 2;
+    size_t next_cold = 0;
+
+    std::vector<Access> trace;
+    trace.reserve(REQUESTS);
+    while (trace.size() < REQUESTS) {
+        for (int i = 0; i < 20000 && trace.size() < REQUESTS; ++i) {
+            size_t file = std::lower_bound(cumulative.begin(), cumulative.end(), uniform(generator)) - cumulative.begin();
+            trace.push_back({"/static/hot-" + std::to_string(file), FILE_SIZE});
+        }
+        for (size_t i = 0; i < scan_length && trace.size() < REQUESTS; ++i) {
+            trace.push_back({"/archive/page-" + std::to_string(next_cold++), FILE_SIZE});
+        }
+    }
+    return trace;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t cache_mb = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 32;
+    if (cache_mb == 0) {
+        std::cerr << "Usage: " << argv[0] << " [cache_mb] [access_log]" << std::endl;
+        return 1;
+    }
+
+    std::vector<Access> trace = argc > 2 ? load_trace(argv[2]) : synthetic_trace(cache_mb * 1024 * 1024);
+    if (trace.empty()) {
+        std::cerr << "No GET accesses with a response size in the trace" << std::endl;
+        return 1;
+    }
+
+    size_t total_bytes = 0;
+    for (const Access& access : trace) {
+        total_bytes += access.size;
+    }
+
+    std::printf("\nReplaying %zu accesses (%s) against a %zu MB cache\n\n", trace.size(),
+                argc > 2 ? argv[2] : "synthetic hot set with scans", cache_mb);
+    std::printf("%-12s %12s %16s\n", "Policy", "Hit ratio", "Byte hit ratio");
+
+    for (EvictionPolicyType policy : {EvictionPolicyType::LRU, EvictionPolicyType::S3_FIFO, EvictionPolicyType::W_TINY_LFU}) {
+        //no TTL, so only eviction decides what is missed
+        LRUCache cache(cache_mb, 0, policy);
+        size_t hit_bytes = 0;
+        for (const Access& access : trace) {
+            if (cache.get(access.key)) {
+                hit_bytes += access.size;
+            } else {
+                cache.put(access.key, std::vector<char>(access.size), "application/octet-stream");
+            }
+        }
+        std::printf("%-12s %11.2f%% %15.2f%%\n", std::string(eviction_policy_name(policy)).c_str(),
+                    cache.get_hit_ratio() * 100.0, 100.0 * hit_bytes / total_bytes);
+    }
+    return 0;
+}
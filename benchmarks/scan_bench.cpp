@@ -0,0 +1,125 @@
+// Parser throughput in GB/s for every SIMD level the CPU supports: the byte-scanning
+// kernels on their own and RequestView::parse() over a stream of pipelined requests.
+//
+//   ./build/bin/scan_bench [megabytes]
+
+#include "http_parser.h"
+#include "simd_scan.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <string>
+
+namespace {
+
+const std::string REQUEST =
+    "GET /static/js/app.3f9c2b.js HTTP/1.1\r\n"
+    "Host: www.example.com\r\n"
+    "Connection: keep-alive\r\n"
+    "User-Agent: Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36 (KHTML, like Gecko) Chrome/124.0.0.0 Safari/537.36\r\n"
+    "Accept: */*\r\n"
+    "Sec-Fetch-Site: same-origin\r\n"
+    "Sec-Fetch-Mode: no-cors\r\n"
+    "Sec-Fetch-Dest: script\r\n"
+    "Referer: https://www.example.com/\r\n"
+    "Accept-Encoding: gzip, deflate, br, zstd\r\n"
+    "Accept-Language: en-US,en;q=0.9\r\n"
+    "Cookie: session=8f14e45fceea167a5a36dedd4bea2543; theme=dark\r\n"
+    "\r\n";
+
+// Repeats unit until the text is at least size bytes long
+std::string repeat_to(const std::string& unit, size_t size) {
+    std::string text;
+    text.reserve(size + unit.size());
+    while (text.size() < size) {
+        text += unit;
+    }
+    return text;
+}
+
+// GB/s over bytes processed per call, best of a few rounds
+double gigabytes_per_second(size_t bytes, const std::function<void()>& run_once) {
+    double best = 0;
+    for (int round = 0; round < 5; ++round) {
+        auto start = std::chrono::steady_clock::now();
+        run_once();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        best = std::max(best, bytes / seconds / 1e9);
+    }
+    return best;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t megabytes = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 16;
+    if (megabytes == 0) {
+        std::cerr << "Usage: " << argv[0] << " [megabytes]" << std::endl;
+        return 1;
+    }
+    size_t size = megabytes * 1024 * 1024;
+
+    //header lines without the final blank line, so the terminator search runs to the end
+    std::string head = REQUEST.substr(0, REQUEST.size() - 2);
+    std::string headers = repeat_to(head.substr(head.find('\n') + 1), size);
+    std::string printable = repeat_to("/static/assets/images/gallery/2024/summer-trip-photo-0042.jpg?", size);
+    std::string encoded = repeat_to("/docs/getting%20started/chapter%2001/intro+notes.html?", size);
+    std::string pipeline = repeat_to(REQUEST, size);
+
+    std::printf("Parser throughput, %zu MB per run, detected SIMD level: %s\n\n", megabytes,
+                simd_level_name(detected_simd_level()));
+    std::printf("%-8s %14s %14s %14s %14s %14s\n", "Level", "header end", "line scan", "printable",
+                "url decode", "parse");
+
+    volatile size_t sink = 0;
+    std::string decoded;
+
+    for (SimdLevel level : {SimdLevel::SCALAR, SimdLevel::SSE2, SimdLevel::AVX2}) {
+        if (!select_simd_level(level)) {
+            continue;
+        }
+
+        double header_end = gigabytes_per_second(headers.size(), [&] {
+            sink = sink + find_header_end(headers.data(), headers.size());
+        });
+
+        //walks every line, stopping at each colon and line feed like the parser does
+        double line_scan = gigabytes_per_second(headers.size(), [&] {
+            size_t pos = 0;
+            while (pos < headers.size()) {
+                pos += scan_for_either(headers.data() + pos, headers.size() - pos, ':', '\n') + 1;
+            }
+            sink = sink + pos;
+        });
+
+        double non_printable = gigabytes_per_second(printable.size(), [&] {
+            sink = sink + has_non_printable(printable.data(), printable.size());
+        });
+
+        double url_decode = gigabytes_per_second(encoded.size(), [&] {
+            url_decode_into(encoded, decoded);
+            sink = sink + decoded.size();
+        });
+
+        double parse = gigabytes_per_second(pipeline.size(), [&] {
+            RequestView request;
+            std::string_view remaining = pipeline;
+            size_t consumed = 0;
+            while (RequestView::parse(remaining, request, consumed) == ParseStatus::COMPLETE) {
+                remaining.remove_prefix(consumed);
+                sink = sink + request.header_count;
+            }
+        });
+
+        std::printf("%-8s %10.2f GB/s %9.2f GB/s %9.2f GB/s %9.2f GB/s %9.2f GB/s\n", simd_level_name(level),
+                    header_end, line_scan, non_printable, url_decode, parse);
+    }
+
+    std::printf("\nParse: %.0f requests per MB of pipelined %zu-byte requests\n",
+                1024.0 * 1024.0 / REQUEST.size(), REQUEST.size());
+    select_simd_level(detected_simd_level());
+    return 0;
+}
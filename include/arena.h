@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <vector>
+
+// Bump allocator for the short-lived objects of a request and its response. Allocating
+// advances a pointer through a block and deallocating does nothing; reset() rewinds to
+// the first block, which is kept, so a connection serving one request after another
+// stops calling malloc once its first block has been allocated.
+//
+// Not thread-safe: only the thread currently handling a connection's request allocates
+// from that connection's arena.
+class Arena : public std::pmr::memory_resource {
+public:
+    explicit Arena(size_t block_size = DEFAULT_BLOCK_SIZE) : block_size_(block_size) {}
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    // Invalidates everything allocated so far and frees all blocks but the first
+    void reset();
+    // Bytes handed out since the last reset
+    size_t bytes_allocated() const { return allocated_; }
+
+    static constexpr size_t DEFAULT_BLOCK_SIZE = 8 * 1024;
+
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void*, size_t, size_t) override {}
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+    char* new_block(size_t size);
+
+    size_t block_size_;
+    std::unique_ptr<char[]> first_block_;
+    // blocks added once the first is full, and allocations too large to share a block
+    std::vector<std::unique_ptr<char[]>> overflow_;
+    char* cursor_ = nullptr;
+    char* end_ = nullptr;
+    size_t allocated_ = 0;
+};
+
+// Makes arena the one HttpRequest and HttpResponse objects created on this thread allocate
+// from until the scope ends; scopes nest, and a null arena means the heap.
+class ArenaScope {
+public:
+    explicit ArenaScope(std::shared_ptr<Arena> arena);
+    ~ArenaScope();
+    ArenaScope(const ArenaScope&) = delete;
+    ArenaScope& operator=(const ArenaScope&) = delete;
+
+    // Arena of the innermost scope on this thread, null outside any scope
+    static const std::shared_ptr<Arena>& current();
+
+private:
+    std::shared_ptr<Arena> arena_;
+    const ArenaScope* previous_;
+};
+
+// The memory resource of an object whose members may live in an arena. It holds on to
+// the arena, so an arena is only reset once no object still refers to it.
+//
+// Follows std::pmr::polymorphic_allocator propagation, so it always names the resource the
+// object's pmr members use: a copy allocates from the heap, a move stays in the source's
+// arena, and assignment leaves the target where it was.
+class ArenaRef {
+public:
+    // The arena of the innermost ArenaScope, the heap outside any
+    ArenaRef() : arena_(ArenaScope::current()) {}
+    ArenaRef(const ArenaRef&) {}
+    // the source keeps its reference too, its emptied members still use the arena
+    ArenaRef(ArenaRef&& other) noexcept : arena_(other.arena_) {}
+    ArenaRef& operator=(const ArenaRef&) { return *this; }
+    ArenaRef& operator=(ArenaRef&&) noexcept { return *this; }
+
+    std::pmr::memory_resource* resource() const {
+        return arena_ ? static_cast<std::pmr::memory_resource*>(arena_.get()) : std::pmr::get_default_resource();
+    }
+
+private:
+    std::shared_ptr<Arena> arena_;
+};
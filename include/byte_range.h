@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// One range of a representation, both ends inclusive as in Content-Range
+struct ByteRange {
+    uint64_t first = 0;
+    uint64_t last = 0;
+    
+    uint64_t length() const { return last - first + 1; }
+};
+
+enum class RangeResult {
+    NONE,          // no usable Range header, send the whole representation
+    SATISFIABLE,   // ranges holds what to send, in the order requested
+    UNSATISFIABLE  // none of the ranges overlaps the representation, answer 416
+};
+
+// Resolves a Range header value against a representation of size bytes. Suffix ranges
+// ("-500") and open ranges ("9500-") are resolved, ranges past the end are dropped and
+// overlapping ones are merged. A header that is malformed, not in bytes, or asks for more
+// than MAX_RANGES ranges is ignored, as RFC 9110 lets a server do.
+RangeResult parse_range_header(std::string_view value, uint64_t size, std::vector<ByteRange>& ranges);
+
+// "bytes 0-499/1234"
+std::string content_range(const ByteRange& range, uint64_t size);
+
+constexpr size_t MAX_RANGES = 16;
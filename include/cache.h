@@ -1,68 +1,111 @@
 #pragma once
 
 #include <unordered_map>
-#include <list>
 #include <mutex>
+#include <shared_mutex>
+#include <atomic>
 #include <chrono>
 #include <vector>
-#include <optional>
+#include <memory>
+#include <string>
+#include <ctime>
+#include "eviction_policy.h"
 
+// One cached representation. Entries are immutable once built and handed out as
+// shared_ptr<const CacheEntry>, so a hit costs a reference count instead of a copy, and
+// replacing or evicting an entry never disturbs a response that is still sending it.
 struct CacheEntry {
     std::vector<char> data;
     std::string content_type;
+    // Status line and fixed headers of the response that serves data, serialized once when
+    // the entry is stored so a hit sends them as is; empty if none were stored
+    std::string head;
+    // Validators of data, so conditional requests are answered without touching it
+    std::string etag;
+    time_t last_modified = 0;
     std::chrono::steady_clock::time_point created;
-    std::chrono::steady_clock::time_point last_accessed;
-    size_t access_count;
+    // The one field that changes, counting the put and every hit since
+    mutable std::atomic<size_t> access_count{1};
     
-    CacheEntry() : access_count(0) {
-        auto now = std::chrono::steady_clock::now();
-        created = now;
-        last_accessed = now;
-    }
-    
-    CacheEntry(const std::vector<char>& file_data, const std::string& mime_type)
-        : data(file_data), content_type(mime_type), access_count(1) {
-        auto now = std::chrono::steady_clock::now();
-        created = now;
-        last_accessed = now;
-    }
+    CacheEntry(std::vector<char> file_data, std::string mime_type, std::string response_head = "",
+               std::string entity_tag = "", time_t modified = 0)
+        : data(std::move(file_data)), content_type(std::move(mime_type)), head(std::move(response_head)),
+          etag(std::move(entity_tag)), last_modified(modified), created(std::chrono::steady_clock::now()) {}
 };
 
+// entry's data and head as pointers of their own that keep the whole entry alive, for
+// responses that send them in place; the head is null when none was stored
+inline std::shared_ptr<const std::vector<char>> shared_data(const std::shared_ptr<const CacheEntry>& entry) {
+    return std::shared_ptr<const std::vector<char>>(entry, &entry->data);
+}
+inline std::shared_ptr<const std::string> shared_head(const std::shared_ptr<const CacheEntry>& entry) {
+    return entry->head.empty() ? nullptr : std::shared_ptr<const std::string>(entry, &entry->head);
+}
+
+// A size-bounded cache split into shards by key hash, each with its own lock, eviction policy
+// and share of the capacity. Hits only take their shard's lock shared and leave the policy a
+// hint in atomics; the policy, CLOCK-approximated LRU unless another is chosen, acts on it
+// when the shard has to make room.
 class LRUCache {
 public:
-    explicit LRUCache(size_t max_size_mb = 100, int ttl_seconds = 300);
+    explicit LRUCache(size_t max_size_mb = 100, int ttl_seconds = 300,
+                      EvictionPolicyType policy = EvictionPolicyType::LRU, size_t shard_count = DEFAULT_SHARD_COUNT);
     ~LRUCache() = default;
     
-    std::optional<CacheEntry> get(const std::string& key);
-    void put(const std::string& key, const std::vector<char>& data, const std::string& content_type);
+    // Null on a miss. record_miss=false lets speculative lookups probe without skewing the hit ratio
+    std::shared_ptr<const CacheEntry> get(const std::string& key, bool record_miss = true);
+    // Takes ownership of data, move it in to avoid a copy. Returns the entry built from it,
+    // whether or not it was kept, so the caller can serve the same bytes; null for an empty
+    // key or data
+    std::shared_ptr<const CacheEntry> put(const std::string& key, std::vector<char> data, std::string content_type,
+                                          std::string response_head = "", std::string etag = "",
+                                          time_t last_modified = 0);
     void remove(const std::string& key);
     void clear();
     
     size_t get_size() const;
     size_t get_count() const;
+    size_t get_shard_count() const { return shards_.size(); }
+    EvictionPolicyType get_policy() const { return policy_; }
     double get_hit_ratio() const;
     void get_stats(size_t& hits, size_t& misses, size_t& entries, size_t& memory_usage) const;
     
-    void set_max_size(size_t max_size_mb) { max_size_bytes_ = max_size_mb * 1024 * 1024; }
+    void set_max_size(size_t max_size_mb);
     void set_ttl(int ttl_seconds) { ttl_seconds_ = ttl_seconds; }
     
+    static constexpr size_t DEFAULT_SHARD_COUNT = 16;
+    // Shards are never smaller than this, so each holds several of the largest cacheable files
+    static constexpr size_t MIN_SHARD_SIZE = 4 * 1024 * 1024;
+    
 private:
-    void evict_lru();
-    void evict_expired();
-    bool is_expired(const CacheEntry& entry) const;
+    // What a hit changes is atomic, so hits can share the shard lock
+    struct Slot {
+        std::shared_ptr<const CacheEntry> entry;
+        PolicyNode node;
+    };
+    using CacheMap = std::unordered_map<std::string, Slot>;
     
-    using CacheList = std::list<std::string>;
-    using CacheMap = std::unordered_map<std::string, std::pair<CacheEntry, CacheList::iterator>>;
+    struct Shard {
+        mutable std::shared_mutex mutex;
+        CacheMap map;
+        std::unique_ptr<EvictionPolicy> policy;
+        size_t size = 0;
+    };
     
-    mutable std::mutex mutex_;
-    CacheMap cache_;
-    CacheList lru_list_;
+    Shard& shard_for(uint64_t hash) const;
+    // The shard's exclusive lock must be held
+    void erase(Shard& shard, CacheMap::iterator it);
+    void evict_expired();
+    bool is_expired(const CacheEntry& entry) const;
+    static size_t entry_size(const CacheEntry& entry);
     
+    EvictionPolicyType policy_;
+    std::vector<std::unique_ptr<Shard>> shards_;
     size_t max_size_bytes_;
-    int ttl_seconds_;
-    size_t current_size_;
+    std::atomic<size_t> shard_capacity_;
+    std::atomic<int> ttl_seconds_;
     
     // Statistics
-    mutable size_t cache_hits_;
-    mutable size_t cache_misses_;
+    mutable std::atomic<size_t> cache_hits_{0};
+    mutable std::atomic<size_t> cache_misses_{0};
 };
\ No newline at end of file
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+#include <vector>
+
+// Content-Encoding support for static files. A file is compressed once, when it is cached,
+// and the compressed variant is cached next to the original; see FileHandler.
+
+// Whether an Accept-Encoding value admits gzip: listed as gzip or x-gzip, or covered by
+// "*", with a non-zero q-value
+bool accepts_gzip(std::string_view accept_encoding);
+
+// False for media types whose formats are compressed already, e.g. JPEG, MP4, ZIP or WOFF2,
+// which gzip would only grow
+bool is_compressible(std::string_view mime_type);
+
+constexpr int DEFAULT_GZIP_LEVEL = 6;
+
+// The gzip stream (RFC 1952) of data; false if zlib fails
+bool gzip_compress(const char* data, size_t size, std::vector<char>& out, int level = DEFAULT_GZIP_LEVEL);
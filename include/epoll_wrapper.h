@@ -3,38 +3,38 @@
 #include <sys/epoll.h>
 #include <vector>
 #include <functional>
-#include <unordered_map>
-#include <mutex>
+#include "io_backend.h"
 
-class EpollWrapper {
+class EpollWrapper : public IoBackend {
 public:
-    struct Event {
-        int fd;
-        uint32_t events;
-        void* data;
-    };
-    
     using EventHandler = std::function<void(const Event&)>;
     
     EpollWrapper();
-    ~EpollWrapper();
+    ~EpollWrapper() override;
     
-    bool init();
-    bool add_fd(int fd, uint32_t events, void* data = nullptr);
-    bool modify_fd(int fd, uint32_t events, void* data = nullptr);
-    bool remove_fd(int fd);
+    bool init() override;
+    bool add_fd(int fd, uint32_t events, uint32_t generation = 0) override;
+    bool modify_fd(int fd, uint32_t events, uint32_t generation = 0) override;
+    bool remove_fd(int fd) override;
     
-    int wait_for_events(std::vector<Event>& events, int timeout_ms = -1);
+    int wait_for_events(std::vector<Event>& events, int timeout_ms = -1) override;
+    void wakeup() override;
     void set_event_handler(EventHandler handler) { event_handler_ = handler; }
     
+    const char* name() const override { return "epoll"; }
+    
     static bool set_non_blocking(int fd);
     
 private:
     int epoll_fd_;
+    int wakeup_fd_;
     std::vector<epoll_event> events_buffer_;
     EventHandler event_handler_;
-    std::unordered_map<int, void*> fd_data_;
-    mutable std::mutex fd_data_mutex_;
     
     static constexpr int MAX_EVENTS = 1024;
+    
+    //fd and generation travel in epoll_event.data, no side table needed
+    static uint64_t pack(int fd, uint32_t generation) {
+        return (static_cast<uint64_t>(generation) << 32) | static_cast<uint32_t>(fd);
+    }
 };
\ No newline at end of file
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <sys/stat.h>
+
+// Strong entity tag of a file from its inode, modification time and size, so it changes whenever
+// the file is replaced or written and is known without reading it. gzip tags the representation
+// compressed from the file, which must not share the tag of the file as it is
+std::string file_etag(const struct stat& file_stat, bool gzip = false);
+
+// Whether a list of entity tags such as an If-None-Match value, or "*", contains etag. The weak
+// comparison ignores W/ prefixes, the strong one never matches a weak tag
+bool etag_list_matches(std::string_view list, std::string_view etag, bool weak);
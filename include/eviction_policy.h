@@ -0,0 +1,82 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+
+enum class EvictionPolicyType {
+    LRU,        // CLOCK, a second-chance approximation of LRU
+    S3_FIFO,    // small probationary FIFO, main FIFO and a ghost queue of recent one-hit wonders
+    W_TINY_LFU  // LRU window, then a segmented main area guarded by a frequency sketch
+};
+
+// "lru", "s3-fifo" or "w-tinylfu", as written in config.json; nullopt for anything else
+std::optional<EvictionPolicyType> parse_eviction_policy(std::string_view name);
+std::string_view eviction_policy_name(EvictionPolicyType type);
+
+// A cache entry as an eviction policy sees it, embedded in the cache's slot for the entry
+struct PolicyNode {
+    const std::string* key = nullptr;
+    uint64_t hash = 0;
+    size_t size = 0;
+    // which of the policy's queues holds the node, and where
+    uint8_t queue = 0;
+    std::list<PolicyNode*>::iterator position;
+    // set or bumped by hits, which only hold the cache's shared lock
+    std::atomic<uint8_t> frequency{0};
+};
+
+// Decides which entries of one cache shard leave when it is full. on_hit() and on_miss() run
+// under the shard's shared lock, concurrently with each other, and may only touch atomics;
+// everything else runs under the exclusive lock.
+class EvictionPolicy {
+public:
+    explicit EvictionPolicy(size_t capacity) : capacity_(capacity) {}
+    virtual ~EvictionPolicy() = default;
+
+    virtual void on_hit(PolicyNode& node) = 0;
+    // A lookup of a key that is not cached; frequency-based policies count it too
+    virtual void on_miss(uint64_t hash) { (void)hash; }
+    virtual void insert(PolicyNode& node) = 0;
+    virtual void remove(PolicyNode& node) = 0;
+    // The entry to evict next, still tracked until the cache calls remove(); null when empty
+    virtual PolicyNode* victim() = 0;
+
+    // Bytes the shard may hold, which the policy's queues divide between them
+    void set_capacity(size_t capacity) { capacity_ = capacity; }
+
+protected:
+    size_t capacity_;
+};
+
+std::unique_ptr<EvictionPolicy> make_eviction_policy(EvictionPolicyType type, size_t capacity);
+
+// Approximate access counts in 4 rows of saturating 4-bit counters, 4 columns per expected
+// entry, all halved every 10 counts per expected entry so old popularity fades. Safe to
+// update concurrently.
+class CountMinSketch {
+public:
+    explicit CountMinSketch(size_t expected_entries);
+
+    void increment(uint64_t hash);
+    uint8_t estimate(uint64_t hash) const;
+
+private:
+    static constexpr size_t ROWS = 4;
+    static constexpr uint8_t MAX_COUNT = 15;
+
+    size_t index(uint64_t hash, size_t row) const;
+    void age();
+
+    size_t width_;
+    int width_bits_;
+    std::unique_ptr<std::atomic<uint8_t>[]> counters_;
+    std::atomic<size_t> additions_{0};
+    std::atomic<bool> aging_{false};
+    size_t sample_size_;
+};
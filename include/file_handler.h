@@ -1,10 +1,12 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <optional>
 #include <filesystem>
 #include <memory>
+#include "http_request.h"
 #include "http_response.h"
 #include "cache.h"
 
@@ -13,16 +15,25 @@ public:
     explicit FileHandler(const std::string& document_root = "./public", 
                         const std::string& default_file = "index.html",
                         bool enable_cache = true,
-                        size_t cache_size_mb = 100);
+                        size_t cache_size_mb = 100,
+                        EvictionPolicyType cache_policy = EvictionPolicyType::LRU);
     
-    HttpResponse handle_file_request(const std::string& request_path);
+    // The file at the request's path, gzip-encoded when Accept-Encoding allows it
+    HttpResponse handle_file_request(const HttpRequest& request);
+    // Serves a request from the cache, touching the filesystem only to check that the file is
+    // still there; returns nullopt when the file is not cached or no longer a regular file
+    std::optional<HttpResponse> get_cached_response(const HttpRequest& request);
     bool file_exists(const std::string& path) const;
     std::optional<std::vector<char>> read_file(const std::string& path) const;
     
     void set_document_root(const std::string& root) { document_root_ = root; }
     void set_default_file(const std::string& default_file) { default_file_ = default_file; }
+    // Larger files are refused with 403; 0, the default, serves files of any size. Only files
+    // below MAX_CACHED_FILE_SIZE are ever read into memory, so this bounds nothing else
     void set_max_file_size(size_t max_size) { max_file_size_ = max_size; }
     void enable_cache(bool enabled) { cache_enabled_ = enabled; }
+    // Compressible files are sent gzip-encoded to clients that accept it
+    void enable_gzip(bool enabled) { gzip_enabled_ = enabled; }
     
     const std::string& get_document_root() const { return document_root_; }
     
@@ -33,9 +44,44 @@ public:
     }
     
 private:
-    std::string resolve_path(const std::string& request_path) const;
+    std::string resolve_path(std::string_view request_path) const;
     bool is_safe_path(const std::string& resolved_path) const;
-    HttpResponse create_directory_listing(const std::string& dir_path, const std::string& request_path);
+    // How a file's bytes are encoded on the way out
+    enum class Encoding {
+        IDENTITY,
+        GZIP,     // compressed here, once, when the file is cached
+        SIDECAR   // read from a precompressed .gz file
+    };
+    
+    // The cached response for the variant selected by gzip, or a 304 when the request's
+    // preconditions show the client's copy is current
+    std::optional<HttpResponse> lookup_cache(const HttpRequest& request, const std::string& resolved_path, bool gzip,
+                                             bool record_miss = true);
+    // Reads a file below MAX_CACHED_FILE_SIZE into the cache and returns it; larger files, of any
+    // size, are sent from the descriptor with sendfile() and never held in memory. cache_key is
+    // where its variant for this encoding lives; vary marks responses whose encoding depends on
+    // Accept-Encoding
+    HttpResponse serve_file(const std::string& file_path, const std::string& cache_key, std::string_view mime_type,
+                            Encoding encoding, bool vary);
+    // A 206 for the request's ranges, a 416 when none is satisfiable, or the whole file when the
+    // Range header is unusable or If-Range no longer matches. Cacheable files are sliced from
+    // their cached copy, larger ones are sent from the descriptor
+    HttpResponse serve_ranges(const HttpRequest& request, const std::string& file_path, std::string_view mime_type,
+                              bool vary);
+    // Whether the ranges of a request with this If-Range value may be sent, true without one
+    static bool if_range_matches(std::string_view if_range, std::string_view etag, time_t last_modified);
+    // If-None-Match, or If-Modified-Since without it, evaluated against a representation's validators
+    static bool is_not_modified(const HttpRequest& request, std::string_view etag, time_t last_modified);
+    static HttpResponse create_not_modified_response(std::string_view etag, time_t last_modified, bool vary);
+    // A 304 when the request's preconditions match the validators serve_file() would send for
+    // file_path, taken from its metadata so nothing is read or compressed to answer it
+    std::optional<HttpResponse> check_preconditions(const HttpRequest& request, const std::string& file_path,
+                                                    Encoding encoding, bool vary) const;
+    // The entity tag of file_path sent with this encoding; only files small enough to cache are compressed
+    std::string representation_etag(const struct stat& file_stat, Encoding encoding) const;
+    // Response whose body is the open file, sent with sendfile() instead of being read
+    HttpResponse create_sendfile_response(const std::string& resolved_path, std::string_view mime_type) const;
+    HttpResponse create_directory_listing(const std::string& dir_path, std::string_view request_path);
     std::string get_file_size_string(uintmax_t size) const;
     std::string get_last_modified_string(const std::filesystem::file_time_type& time) const;
     
@@ -43,7 +89,9 @@ private:
     std::string default_file_;
     size_t max_file_size_;
     bool cache_enabled_;
+    bool gzip_enabled_ = true;
     std::unique_ptr<LRUCache> cache_;
     
-    static constexpr size_t DEFAULT_MAX_FILE_SIZE = 50 * 1024 * 1024; // 50MB
+    static constexpr size_t MAX_CACHED_FILE_SIZE = 1024 * 1024; // larger files are sent with sendfile()
+    static constexpr int CACHE_TTL_SECONDS = 300;
 };
\ No newline at end of file
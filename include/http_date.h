@@ -0,0 +1,18 @@
+#pragma once
+
+#include <ctime>
+#include <optional>
+#include <string>
+#include <string_view>
+
+// Length of an IMF-fixdate, e.g. "Sun, 06 Nov 1994 08:49:37 GMT"
+constexpr size_t HTTP_DATE_LENGTH = 29;
+
+// Writes the IMF-fixdate for time into out, which has room for HTTP_DATE_LENGTH characters;
+// no locale or stream machinery involved
+void format_http_date(time_t time, char* out);
+std::string format_http_date(time_t time);
+
+// Accepts the three formats HTTP/1.1 recipients must understand: IMF-fixdate, RFC 850
+// ("Sunday, 06-Nov-94 08:49:37 GMT") and asctime ("Sun Nov  6 08:49:37 1994")
+std::optional<time_t> parse_http_date(std::string_view value);
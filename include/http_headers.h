@@ -0,0 +1,127 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+
+// Header names the server reads or writes, each with a fixed id. Names are matched
+// case-insensitively through a perfect hash built at compile time, so resolving one
+// costs a hash and a single comparison, with no lowercased copy.
+enum class HeaderId : uint8_t {
+    ACCEPT,
+    ACCEPT_CHARSET,
+    ACCEPT_ENCODING,
+    ACCEPT_LANGUAGE,
+    ACCEPT_RANGES,
+    AGE,
+    ALLOW,
+    AUTHORIZATION,
+    CACHE_CONTROL,
+    CONNECTION,
+    CONTENT_DISPOSITION,
+    CONTENT_ENCODING,
+    CONTENT_LANGUAGE,
+    CONTENT_LENGTH,
+    CONTENT_LOCATION,
+    CONTENT_RANGE,
+    CONTENT_TYPE,
+    COOKIE,
+    DATE,
+    ETAG,
+    EXPECT,
+    EXPIRES,
+    FORWARDED,
+    HOST,
+    IF_MATCH,
+    IF_MODIFIED_SINCE,
+    IF_NONE_MATCH,
+    IF_RANGE,
+    IF_UNMODIFIED_SINCE,
+    KEEP_ALIVE,
+    LAST_MODIFIED,
+    LOCATION,
+    ORIGIN,
+    PRAGMA,
+    RANGE,
+    REFERER,
+    SERVER,
+    SET_COOKIE,
+    TE,
+    TRAILER,
+    TRANSFER_ENCODING,
+    UPGRADE,
+    USER_AGENT,
+    VARY,
+    VIA,
+    X_CACHE,
+    X_FORWARDED_FOR,
+    X_REQUESTED_WITH,
+    UNKNOWN
+};
+
+constexpr size_t KNOWN_HEADER_COUNT = static_cast<size_t>(HeaderId::UNKNOWN);
+
+// UNKNOWN for any name outside the table
+HeaderId lookup_header(std::string_view name);
+// Canonical spelling, e.g. "Content-Length"
+std::string_view header_name(HeaderId id);
+
+bool iequals(std::string_view a, std::string_view b);
+// value without the spaces and tabs around it, the optional whitespace of RFC 9110
+std::string_view trim_ows(std::string_view value);
+
+// Header fields of a request or response in insertion order. Known headers are found
+// through a slot per id, the rest by a case-insensitive scan; setting a header that is
+// already there replaces its value. Names and values are allocated from resource.
+class HeaderMap {
+public:
+    explicit HeaderMap(std::pmr::memory_resource* resource = std::pmr::get_default_resource()) : fields_(resource) {}
+
+    // Empty when the header is missing; valid until the header is set again
+    std::string_view get(HeaderId id) const;
+    std::string_view get(std::string_view name) const;
+    bool has(HeaderId id) const { return id != HeaderId::UNKNOWN && slots_[static_cast<size_t>(id)] != 0; }
+    bool has(std::string_view name) const;
+
+    void set(HeaderId id, std::string_view value);
+    // Resolves known names to their id; others keep the spelling they were set with
+    void set(std::string_view name, std::string_view value);
+    void remove(HeaderId id);
+
+    size_t size() const { return fields_.size(); }
+    bool empty() const { return fields_.empty(); }
+    void clear();
+
+    // fn(std::string_view name, std::string_view value) for every field in insertion order
+    template <typename Fn>
+    void for_each(Fn&& fn) const {
+        for (const auto& field : fields_) {
+            fn(field.id == HeaderId::UNKNOWN ? std::string_view(field.name) : header_name(field.id), std::string_view(field.value));
+        }
+    }
+
+private:
+    // Allocator-aware, so fields moved or copied between maps end up in the target's resource
+    struct Field {
+        using allocator_type = std::pmr::polymorphic_allocator<char>;
+
+        Field(HeaderId field_id, std::string_view field_name, std::string_view field_value, const allocator_type& alloc)
+            : id(field_id), name(field_name, alloc), value(field_value, alloc) {}
+        Field(const Field& other, const allocator_type& alloc)
+            : id(other.id), name(other.name, alloc), value(other.value, alloc) {}
+        Field(Field&& other, const allocator_type& alloc)
+            : id(other.id), name(std::move(other.name), alloc), value(std::move(other.value), alloc) {}
+
+        HeaderId id;
+        std::pmr::string name; // only for unknown headers
+        std::pmr::string value;
+    };
+
+    const Field* find_unknown(std::string_view name) const;
+
+    // 1-based position of each known header in fields_, 0 when it is not set
+    std::array<uint16_t, KNOWN_HEADER_COUNT> slots_{};
+    std::pmr::vector<Field> fields_;
+};
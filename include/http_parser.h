@@ -0,0 +1,126 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include "http_headers.h"
+#include "http_request.h"
+#include "request_body.h"
+
+enum class ParseStatus {
+    COMPLETE,
+    INCOMPLETE,
+    INVALID // framing is broken (bad Content-Length, too many headers), the stream cannot continue
+};
+
+struct HeaderView {
+    std::string_view name;
+    std::string_view value;
+    HeaderId id = HeaderId::UNKNOWN;
+};
+
+// One request parsed in place. Every view points into the buffer it was parsed from,
+// which has to stay unchanged while the view is used; nothing is allocated or copied.
+// Malformed request lines still parse, HttpRequest decides whether the request is valid.
+struct RequestView {
+    static constexpr size_t MAX_HEADERS = 64;
+
+    HttpMethod method = HttpMethod::UNKNOWN;
+    std::string_view method_name;
+    std::string_view path; // still percent-encoded
+    std::string_view query;
+    std::string_view version;
+    std::string_view body;
+
+    std::array<HeaderView, MAX_HEADERS> headers;
+    size_t header_count = 0;
+    size_t content_length = 0;
+
+    // Parses the first request in buffer; on COMPLETE, consumed is its length including the body.
+    // One-shot: bodies are framed by Content-Length only, connections use RequestParser
+    static ParseStatus parse(std::string_view buffer, RequestView& request, size_t& consumed);
+
+    // Case-insensitive lookup, empty when the header is missing
+    std::string_view header(HeaderId id) const;
+    std::string_view header(std::string_view name) const;
+    bool has_header(std::string_view name) const;
+};
+
+// Incremental parser for the request at the front of a connection's receive buffer.
+// Every call resumes where the previous one stopped, so a request trickling in is scanned
+// once instead of from byte 0 on each read: the header terminator search continues at the
+// end of the last search, the head is parsed once it is complete, and a body only has its
+// length checked (Content-Length) or its new chunks decoded (Transfer-Encoding: chunked).
+//
+// Between calls the buffer may grow and move, but the bytes already seen must not change.
+// Once COMPLETE the request stays available until its bytes are erased and reset() is called.
+//
+// A body too large to wait for in the buffer is streamed instead: after stream_body() every
+// body byte parsed is handed to the consumer, chunked bodies already decoded, and
+// discard_streamed() drops those bytes so only the head stays buffered.
+class RequestParser {
+public:
+    RequestParser() { reset(); }
+
+    ParseStatus parse(std::string_view buffer);
+
+    // The head is parsed and the body, if any, is still arriving
+    bool receiving_body() const;
+    // Only while receiving_body(); the consumer must outlive the request
+    void stream_body(BodyConsumer* consumer);
+    // Erases the body bytes already handed to the consumer, which sit right behind the head
+    void discard_streamed(std::string& buffer);
+
+    // Valid after COMPLETE while the buffer is unchanged; a chunked body points into the
+    // parser and a streamed one is empty
+    const RequestView& request() const { return request_; }
+    // Length of the request in the buffer, body and chunk framing included
+    size_t consumed() const { return consumed_; }
+
+    void reset();
+
+private:
+    enum class State {
+        HEAD,
+        BODY,
+        CHUNK_SIZE,
+        CHUNK_DATA,
+        CHUNK_DATA_END,
+        TRAILERS,
+        COMPLETE,
+        INVALID
+    };
+
+    // Position of a parsed field in the buffer, which may move between calls
+    struct Span {
+        size_t offset = 0;
+        size_t length = 0;
+    };
+
+    bool start_body();
+    ParseStatus parse_body(std::string_view buffer);
+    ParseStatus parse_chunks(std::string_view buffer);
+    bool deliver(const char* data, size_t size);
+    ParseStatus complete();
+    void save_spans(std::string_view buffer);
+    void restore_views(std::string_view buffer);
+
+    State state_;
+    size_t scan_pos_; // where the next search starts
+    size_t body_start_;
+    size_t body_remaining_; // of a Content-Length body
+    size_t chunk_remaining_;
+    size_t body_size_; // decoded so far
+    BodyConsumer* consumer_;
+    size_t consumed_;
+    const char* base_; // buffer the views in request_ point into
+    bool chunked_;
+
+    RequestView request_;
+    Span method_name_, path_, query_, version_;
+    std::array<Span, RequestView::MAX_HEADERS * 2> header_spans_;
+    std::string chunked_body_;
+
+    static constexpr size_t RETAINED_CAPACITY = 16 * 1024;
+};
@@ -1,8 +1,14 @@
 #pragma once
 
+#include <memory>
+#include <memory_resource>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <vector>
+#include "arena.h"
+#include "http_headers.h"
+#include "request_body.h"
 
 enum class HttpMethod {
     GET,
@@ -14,44 +20,62 @@ enum class HttpMethod {
     UNKNOWN
 };
 
+struct RequestView;
+
+// Strings, headers and query parameters are allocated from the arena of the ArenaScope
+// active when the request is created, or from the heap outside any.
 class HttpRequest {
 public:
-    HttpRequest() = default;
+    HttpRequest();
     
-    static HttpRequest parse(const std::string& raw_request);
+    // raw_request holds exactly one complete request, anything else yields an invalid request
+    static HttpRequest parse(std::string_view raw_request);
+    // Owning copy of a request parsed in place, with the path and query parameters decoded
+    static HttpRequest from_view(const RequestView& view);
     
     HttpMethod get_method() const { return method_; }
-    const std::string& get_path() const { return path_; }
-    const std::string& get_query_string() const { return query_string_; }
-    const std::string& get_version() const { return version_; }
-    const std::string& get_body() const { return body_; }
+    std::string_view get_path() const { return path_; }
+    std::string_view get_query_string() const { return query_string_; }
+    std::string_view get_version() const { return version_; }
+    std::string_view get_body() const { return body_; }
+    // Set instead of the in-memory body when an upload was spooled to a temporary file
+    const std::shared_ptr<OpenFile>& get_body_file() const { return body_file_; }
+    size_t get_body_size() const { return body_file_ ? body_file_size_ : body_.size(); }
+    // Takes over a body that was streamed while the request arrived
+    void set_streamed_body(SpooledBody& body);
+    
+    // Empty when the header is missing; known headers are found without hashing the name
+    std::string_view get_header(HeaderId id) const { return headers_.get(id); }
+    std::string_view get_header(std::string_view name) const { return headers_.get(name); }
+    bool has_header(HeaderId id) const { return headers_.has(id); }
+    bool has_header(std::string_view name) const { return headers_.has(name); }
+    const HeaderMap& get_headers() const { return headers_; }
     
-    std::string get_header(const std::string& name) const;
-    bool has_header(const std::string& name) const;
-    const std::unordered_map<std::string, std::string>& get_headers() const { return headers_; }
+    using QueryParams = std::pmr::unordered_map<std::pmr::string, std::pmr::string>;
     
-    std::string get_query_param(const std::string& name) const;
-    const std::unordered_map<std::string, std::string>& get_query_params() const { return query_params_; }
+    std::string get_query_param(std::string_view name) const;
+    const QueryParams& get_query_params() const { return query_params_; }
     
     bool is_keep_alive() const;
     bool is_valid() const { return valid_; }
     bool is_request_valid() const;
     
     static std::string method_to_string(HttpMethod method);
-    static HttpMethod string_to_method(const std::string& method_str);
+    static HttpMethod string_to_method(std::string_view method_str);
     
 private:
-    void parse_request_line(const std::string& line);
-    void parse_header_line(const std::string& line);
     void parse_query_string();
-    std::string url_decode(const std::string& str);
     
+    // first, so the arena outlives the members allocated from it
+    ArenaRef arena_;
     HttpMethod method_ = HttpMethod::UNKNOWN;
-    std::string path_;
-    std::string query_string_;
-    std::string version_;
-    std::string body_;
-    std::unordered_map<std::string, std::string> headers_;
-    std::unordered_map<std::string, std::string> query_params_;
+    std::pmr::string path_;
+    std::pmr::string query_string_;
+    std::pmr::string version_;
+    std::pmr::string body_;
+    std::shared_ptr<OpenFile> body_file_;
+    size_t body_file_size_ = 0;
+    HeaderMap headers_;
+    QueryParams query_params_;
     bool valid_ = false;
 };
\ No newline at end of file
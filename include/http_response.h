@@ -1,13 +1,24 @@
 #pragma once
 
+#include <memory_resource>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <vector>
+#include <memory>
+#include <optional>
+#include <functional>
+#include <sys/types.h>
+#include <sys/uio.h>
+#include "arena.h"
+#include "http_headers.h"
+#include "open_file.h"
 
 enum class HttpStatus {
     OK = 200,
     CREATED = 201,
     NO_CONTENT = 204,
+    PARTIAL_CONTENT = 206,
     MOVED_PERMANENTLY = 301,
     FOUND = 302,
     NOT_MODIFIED = 304,
@@ -16,45 +27,118 @@ enum class HttpStatus {
     FORBIDDEN = 403,
     NOT_FOUND = 404,
     METHOD_NOT_ALLOWED = 405,
+    CONTENT_TOO_LARGE = 413,
+    RANGE_NOT_SATISFIABLE = 416,
     INTERNAL_SERVER_ERROR = 500,
     NOT_IMPLEMENTED = 501,
     BAD_GATEWAY = 502,
     SERVICE_UNAVAILABLE = 503
 };
 
+// A byte range of a file that is sent with sendfile() instead of being read into memory
+struct FileRange {
+    std::shared_ptr<OpenFile> file;
+    off_t offset = 0;
+    size_t length = 0;
+};
+
+// Body bytes sent in place instead of being copied into the response, e.g. a cached file;
+// owner keeps them alive for as long as the response or connection needs them
+struct BodySegment {
+    std::shared_ptr<const void> owner;
+    const char* data = nullptr;
+    size_t size = 0;
+};
+
+// Dynamic content produced while the response is sent rather than up front: each call writes
+// at most capacity bytes into buffer and returns how many, 0 once the body is complete. It
+// runs on whichever thread is sending, so it only formats and never blocks.
+using BodyGenerator = std::function<size_t(char* buffer, size_t capacity)>;
+
+// Headers and the in-memory body are allocated from the arena of the ArenaScope active
+// when the response is created, or from the heap outside any.
 class HttpResponse {
 public:
     HttpResponse(HttpStatus status = HttpStatus::OK);
     
     void set_status(HttpStatus status);
-    void set_header(const std::string& name, const std::string& value);
-    void set_body(const std::string& body);
+    void set_header(HeaderId id, std::string_view value);
+    void set_header(std::string_view name, std::string_view value);
+    void set_body(std::string_view body);
     void set_body(const std::vector<char>& body);
-    void append_body(const std::string& data);
+    void append_body(std::string_view data);
+    // The body is sent straight from the file; replaces any in-memory body
+    void set_file_body(std::shared_ptr<OpenFile> file, off_t offset, size_t length);
+    // The body references data instead of copying it; replaces any other body
+    void set_shared_body(std::shared_ptr<const std::vector<char>> data);
+    void append_body_segment(BodySegment segment);
+    // The body is pulled from generator piece by piece as it is sent, with
+    // Transfer-Encoding: chunked since its length is not known; replaces any other body
+    void set_generated_body(BodyGenerator generator);
+    // Moves the generator out, to the connection that runs it
+    BodyGenerator take_generated_body() { return std::move(generator_); }
+    // Drops the body but keeps the headers describing it, Content-Length included, as the
+    // answer to a HEAD request or a 304 does; a generated body is never run
+    void omit_body();
     
-    void set_content_type(const std::string& content_type);
+    void set_content_type(std::string_view content_type);
     void set_content_length(size_t length);
     void set_keep_alive(bool keep_alive);
-    void set_server_header(const std::string& server_name = "MultithreadedWebServer/1.0");
+    void set_server_header(std::string_view server_name = "MultithreadedWebServer/1.0");
     
+    // Status line and headers, up to and including the blank line
+    std::string serialize_headers() const;
+    // Status line and every header but Date, Connection and Keep-Alive, without the blank
+    // line: the part of the response that can be sent again as is, see create_serialized_response()
+    std::string serialize_fixed_headers() const;
+    // Appends the headers to out so a caller can keep reusing one buffer
+    void serialize_headers(std::string& out) const;
+    // One iovec per non-empty piece of the in-memory body, the owned body before any segments;
+    // they point into this response and stay valid while it is neither modified nor moved
+    void append_body_iovecs(std::vector<iovec>& iov) const;
+    // Headers plus the in-memory body; a file or generated body is not included, see
+    // get_file_body() and has_generated_body()
     std::string to_string() const;
     std::vector<char> to_bytes() const;
     
     HttpStatus get_status() const { return status_; }
-    const std::string& get_body() const { return body_; }
-    size_t get_body_size() const { return body_.size(); }
+    std::string_view get_header(HeaderId id) const { return headers_.get(id); }
+    std::string_view get_header(std::string_view name) const { return headers_.get(name); }
+    std::string_view get_body() const { return body_; }
+    const std::optional<FileRange>& get_file_body() const { return file_body_; }
+    bool has_generated_body() const { return static_cast<bool>(generator_); }
+    size_t get_body_size() const { return file_body_ ? file_body_->length : body_.size() + segments_size_; }
     
-    static std::string get_mime_type(const std::string& file_extension);
-    static std::string get_status_text(HttpStatus status);
+    // Both look up constant tables; the views stay valid for the life of the program
+    static std::string_view get_mime_type(std::string_view file_extension);
+    static std::string_view get_status_text(HttpStatus status);
+    // The Date header value for the current second, formatted at most once a second per
+    // thread; valid until the thread's next call
+    static std::string_view current_date();
     static HttpResponse create_error_response(HttpStatus status, const std::string& message = "");
     static HttpResponse create_file_response(const std::string& file_path, const std::vector<char>& file_content);
+    // A 200 response serialized beforehand, e.g. stored with a cached file: head, from
+    // serialize_fixed_headers(), is sent as is, followed by Date and whatever is set afterwards
+    // such as Connection, then body. Neither is copied.
+    static HttpResponse create_serialized_response(std::shared_ptr<const std::string> head,
+                                                   std::shared_ptr<const std::vector<char>> body);
     
 private:
     void set_default_headers();
-    std::string format_date() const;
+    // Drops every kind of body, ahead of setting a new one
+    void clear_body();
+    void append_status_line(std::string& out) const;
+    void append_headers(std::string& out, bool fixed_only) const;
     
+    // first, so the arena outlives the members allocated from it
+    ArenaRef arena_;
     HttpStatus status_;
-    std::unordered_map<std::string, std::string> headers_;
-    std::string body_;
-    std::string version_ = "HTTP/1.1";
+    // status line and fixed headers sent ahead of headers_, set by create_serialized_response()
+    std::shared_ptr<const std::string> serialized_head_;
+    HeaderMap headers_;
+    std::pmr::string body_;
+    std::pmr::vector<BodySegment> segments_;
+    size_t segments_size_ = 0;
+    std::optional<FileRange> file_body_;
+    BodyGenerator generator_;
 };
\ No newline at end of file
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <sys/epoll.h>
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+struct msghdr;
+
+enum class IoBackendType {
+    EPOLL,
+    IO_URING
+};
+
+// Event source for one reactor. Readiness backends (epoll) report EPOLLIN/EPOLLOUT and
+// leave accept/recv to the caller; completion backends (io_uring) may hand over an
+// accepted socket or the received bytes directly in the event.
+//
+// Every registration carries a generation that comes back in its events, so the caller
+// can tell an event for a closed socket from one for a new socket reusing the fd number.
+class IoBackend {
+public:
+    struct Event {
+        int fd;
+        uint32_t events;
+        uint32_t generation;
+        int accepted_fd = -1;           // listener: socket already accepted by the backend
+        const char* payload = nullptr;  // client: bytes already received, valid until the next wait
+        size_t payload_size = 0;
+        bool send_completed = false;    // client: a submit_send() finished with send_result
+        int send_result = 0;            // bytes written, or -errno
+    };
+    
+    virtual ~IoBackend() = default;
+    
+    virtual bool init() = 0;
+    // exclusive: the listener is shared by several reactors, wake only one per connection
+    virtual bool add_listener(int fd, bool exclusive = false) { return add_fd(fd, EPOLLIN | (exclusive ? static_cast<uint32_t>(EPOLLEXCLUSIVE) : 0u)); }
+    virtual bool add_fd(int fd, uint32_t events, uint32_t generation = 0) = 0;
+    virtual bool modify_fd(int fd, uint32_t events, uint32_t generation = 0) = 0;
+    virtual bool remove_fd(int fd) = 0;
+    
+    virtual int wait_for_events(std::vector<Event>& events, int timeout_ms = -1) = 0;
+    
+    // Completion backends write for the caller: the send goes to the kernel with the reactor's
+    // next batch and comes back as an event with send_completed set. message and the memory it
+    // points to must stay untouched until then; owner is held until the kernel is done with
+    // them, even if the fd is removed meanwhile. False when the caller has to write itself.
+    virtual bool submit_send(int /*fd*/, const msghdr* /*message*/, int /*flags*/, uint32_t /*generation*/,
+                             std::shared_ptr<void> /*owner*/) { return false; }
+    
+    // Makes a wait_for_events() blocked in another thread return early
+    virtual void wakeup() = 0;
+    
+    virtual const char* name() const = 0;
+    virtual bool is_completion_based() const { return false; }
+    
+    // Returns an initialized backend of the requested type, falling back to epoll
+    // when the kernel lacks support; nullptr only if epoll itself cannot be created
+    static std::unique_ptr<IoBackend> create(IoBackendType type);
+};
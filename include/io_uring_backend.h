@@ -0,0 +1,145 @@
+#pragma once
+
+#include <vector>
+#include <mutex>
+#include <thread>
+#include <memory>
+#include <unordered_map>
+#include "io_backend.h"
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+
+// io_uring reactor backend built on the raw syscalls (no liburing dependency).
+// Listeners use multishot accept, clients a multishot recv into a provided-buffer
+// ring, responses a SENDMSG per submit_send(), and write readiness a oneshot POLLOUT.
+// All submissions queued during a loop iteration, sends included, go to the kernel in
+// the same io_uring_enter() that waits for completions.
+//
+// Only the thread calling wait_for_events() touches the rings; add/modify/remove from
+// other threads are queued and wake that thread through an eventfd.
+class IoUringBackend : public IoBackend {
+public:
+    IoUringBackend();
+    ~IoUringBackend() override;
+
+    bool init() override;
+    bool add_listener(int fd, bool exclusive = false) override;
+    bool add_fd(int fd, uint32_t events, uint32_t generation = 0) override;
+    bool modify_fd(int fd, uint32_t events, uint32_t generation = 0) override;
+    bool remove_fd(int fd) override;
+
+    int wait_for_events(std::vector<Event>& events, int timeout_ms = -1) override;
+    bool submit_send(int fd, const msghdr* message, int flags, uint32_t generation,
+                     std::shared_ptr<void> owner) override;
+    void wakeup() override;
+
+    const char* name() const override { return "io_uring"; }
+    bool is_completion_based() const override { return true; }
+
+private:
+    enum class OpType : uint8_t {
+        ACCEPT = 1,
+        RECV,
+        POLL_OUT,
+        SEND,
+        WAKEUP,
+        CANCEL
+    };
+
+    enum class Request : uint8_t {
+        ADD_LISTENER,
+        ADD,
+        MODIFY,
+        REMOVE
+    };
+
+    struct PendingRequest {
+        Request type;
+        int fd;
+        uint32_t events;
+        uint32_t tag;
+    };
+
+    struct PendingSend {
+        int fd;
+        uint32_t tag;
+        const msghdr* message;
+        int flags;
+        std::shared_ptr<void> owner;
+    };
+
+    struct FdState {
+        uint32_t generation = 0;
+        uint32_t tag = 0;  // caller's generation, reported back in events
+        bool registered = false;
+        bool listener = false;
+        bool recv_armed = false;
+        bool pollout_armed = false;
+        bool send_armed = false;
+    };
+
+    bool setup_rings();
+    bool setup_buffer_ring();
+    bool probe_opcodes();
+    void release_rings();
+
+    bool queue_request(const PendingRequest& request);
+    void apply_pending_requests();
+    void recycle_buffers();
+
+    io_uring_sqe* next_sqe();
+    void arm_accept(int fd);
+    void arm_recv(int fd);
+    void arm_pollout(int fd);
+    void arm_send(const PendingSend& send);
+    void arm_wakeup();
+    void cancel(uint64_t user_data);
+    int submit_and_wait(unsigned wait_nr, int timeout_ms);
+    void process_completion(const io_uring_cqe& cqe, std::vector<Event>& events);
+
+    FdState& state_for(int fd);
+    static uint64_t encode(OpType type, uint32_t generation, int fd);
+
+    int ring_fd_;
+    int wakeup_fd_;
+
+    void* sq_ring_;
+    void* cq_ring_;
+    size_t ring_size_;
+    io_uring_sqe* sqes_;
+    size_t sqes_size_;
+    unsigned* sq_head_;
+    unsigned* sq_tail_;
+    unsigned sq_mask_;
+    unsigned sq_entries_;
+    unsigned sq_local_tail_;
+    unsigned* cq_head_;
+    unsigned* cq_tail_;
+    unsigned cq_mask_;
+    io_uring_cqe* cqes_;
+
+    void* buffer_ring_;
+    size_t buffer_ring_size_;
+    std::unique_ptr<char[]> buffers_;
+    unsigned short* buffer_ring_tail_;
+    std::vector<uint16_t> buffers_to_recycle_;
+
+    std::vector<FdState> fd_states_;
+    std::vector<int> recv_rearm_;
+    std::vector<int> accept_rearm_;
+    // Owners of the buffers of sends the kernel has not completed yet, by user_data
+    std::unordered_map<uint64_t, std::shared_ptr<void>> sends_in_flight_;
+
+    std::mutex pending_mutex_;
+    std::vector<PendingRequest> pending_;
+    std::vector<PendingRequest> applying_;
+    std::vector<PendingSend> pending_sends_;
+    std::vector<PendingSend> applying_sends_;
+    std::thread::id owner_thread_;
+
+    static constexpr unsigned RING_ENTRIES = 1024;
+    static constexpr unsigned BUFFER_COUNT = 512;
+    static constexpr unsigned BUFFER_SIZE = 4096;
+    static constexpr uint16_t BUFFER_GROUP = 0;
+};
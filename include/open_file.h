@@ -0,0 +1,22 @@
+#pragma once
+
+#include <unistd.h>
+
+// An open file descriptor, closed when the last response, request or connection referencing it goes away
+class OpenFile {
+public:
+    explicit OpenFile(int fd) : fd_(fd) {}
+    ~OpenFile() {
+        if (fd_ != -1) {
+            close(fd_);
+        }
+    }
+    
+    OpenFile(const OpenFile&) = delete;
+    OpenFile& operator=(const OpenFile&) = delete;
+    
+    int fd() const { return fd_; }
+    
+private:
+    int fd_;
+};
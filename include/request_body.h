@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include "open_file.h"
+
+// Receives a request body piece by piece as it arrives, already de-chunked
+class BodyConsumer {
+public:
+    virtual ~BodyConsumer() = default;
+    
+    // false stops the request, e.g. on a write error or a size limit
+    virtual bool consume(const char* data, size_t size) = 0;
+    // Called once after the last byte
+    virtual bool finish() { return true; }
+};
+
+// Keeps a body in memory up to memory_limit and moves it to an anonymous temporary file
+// beyond that, so an upload of any size holds at most memory_limit bytes per connection.
+// Writes to the file are batched into WRITE_CHUNK sized blocks.
+class SpooledBody : public BodyConsumer {
+public:
+    SpooledBody(size_t memory_limit, size_t max_size, std::string temp_dir);
+    
+    bool consume(const char* data, size_t size) override;
+    bool finish() override;
+    
+    size_t size() const { return size_; }
+    bool in_memory() const { return !file_; }
+    // The body while it is in memory; taken by the request once complete
+    std::string& data() { return memory_; }
+    // The temporary file once spilled, already unlinked
+    const std::shared_ptr<OpenFile>& file() const { return file_; }
+    
+    // Why consume() or finish() failed
+    const std::string& error() const { return error_; }
+    // Whether that was the body outgrowing max_size rather than a temporary file error
+    bool too_large() const { return too_large_; }
+    
+    static constexpr size_t WRITE_CHUNK = 64 * 1024;
+    
+private:
+    bool spill();
+    bool flush();
+    bool fail(const std::string& message);
+    
+    size_t memory_limit_;
+    size_t max_size_;
+    std::string temp_dir_;
+    size_t size_ = 0;
+    // the body while in memory, afterwards bytes not yet written to file_
+    std::string memory_;
+    std::shared_ptr<OpenFile> file_;
+    std::string error_;
+    bool too_large_ = false;
+};
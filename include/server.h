@@ -7,74 +7,292 @@
 #include <unordered_map>
 #include <mutex>
 #include <chrono>
+#include <vector>
+#include <optional>
+#include <deque>
+#include <sys/socket.h>
+#include "arena.h"
 #include "epoll_wrapper.h"
+#include "io_backend.h"
+#include "timer_wheel.h"
 #include "thread_pool.h"
 #include "http_request.h"
+#include "http_parser.h"
 #include "http_response.h"
 #include "file_handler.h"
 #include "rate_limiter.h"
 #include "logger.h"
 
+struct Reactor;
+
+// Where complete requests are handled: always on the thread pool, on the reactor
+// thread when they cannot block (errors, API routes, cache hits), or always inline.
+enum class DispatchMode {
+    OFFLOAD,
+    INLINE_CHEAP,
+    INLINE_ALL
+};
+
+// How reactors get new connections: each binds its own SO_REUSEPORT listener and the
+// kernel hashes connections across them, or all share one listener registered with
+// EPOLLEXCLUSIVE so whichever reactor is idle takes the next connection.
+enum class AcceptMode {
+    REUSEPORT,
+    EXCLUSIVE
+};
+
 struct Connection {
     int fd;
+    Reactor* reactor;
+    uint32_t generation;
     std::string buffer;
+    // Progress on the request at the front of buffer, carried over between reads
+    RequestParser parser;
+    // Body of the request in front while it is streamed instead of buffered
+    std::unique_ptr<SpooledBody> upload;
+    // Pipelined requests moved out of a full buffer while waiting for their turn, so the
+    // parser can get to an upload behind them; they come before anything still in buffer
+    std::deque<HttpRequest> waiting_requests;
+    // Status refusing the request being received, whose body is over the size limit or could
+    // not be stored; the rest of it is dropped as it arrives. The refusal is answered once the
+    // waiting requests in front of it are, and the connection closes after it
+    std::optional<HttpStatus> rejected_upload;
+    bool rejection_answered = false;
+    // Requests and responses allocate from here while the connection's request is handled;
+    // only the thread handling it allocates, see request_arena()
+    std::shared_ptr<Arena> arena;
     bool keep_alive;
     std::chrono::steady_clock::time_point last_activity;
     mutable std::mutex mutex_;
     
-    // Fields for handling partial writes
+    // A queued response and where its headers end in pending_response
+    struct QueuedResponse {
+        HttpResponse message;
+        size_t header_end;
+    };
+    
+    // Fields for handling partial writes. Responses to pipelined requests are queued and
+    // sent together: their headers are serialized back to back into pending_response, whose
+    // capacity is reused, and pending_messages own the bodies. pending_iov references both
+    // and is trimmed in place as bytes go out, iov_index is the first entry not fully sent
     std::string pending_response;
-    size_t response_offset;
+    std::vector<QueuedResponse> pending_messages;
+    std::vector<iovec> pending_iov;
+    size_t iov_index;
+    // File body of the last queued response, sent with sendfile() once pending_iov is out
+    FileRange pending_file;
+    // Generated body of the last queued response, run once pending_iov is out. Only one
+    // chunk of it is held at a time: generated_chunk[chunk_offset, chunk_end) is what is
+    // left to send of the current one
+    BodyGenerator pending_generator;
+    std::string generated_chunk;
+    size_t chunk_offset = 0;
+    size_t chunk_end = 0;
+    // The write handed to a completion backend, which the kernel reads until it completes;
+    // nothing pending may change or be freed while send_in_flight is set
+    msghdr send_message{};
+    iovec chunk_iov{};
+    bool send_in_flight = false;
+    // Pipelined request already parsed that has to wait until the queued responses are out
+    std::optional<HttpRequest> deferred_request;
     bool has_pending_write;
     bool processing_request;
     
-    Connection(int socket_fd) : fd(socket_fd), keep_alive(false), 
-                               last_activity(std::chrono::steady_clock::now()),
-                               response_offset(0), has_pending_write(false), 
-                               processing_request(false) {}
+    // Set once the socket is closed; workers still holding the connection check it
+    // under mutex_ instead of looking the fd up again
+    bool closed;
+    
+    Connection(int socket_fd, Reactor* owner, uint32_t gen) : fd(socket_fd), reactor(owner), generation(gen),
+                               keep_alive(false), last_activity(std::chrono::steady_clock::now()),
+                               iov_index(0), has_pending_write(false), 
+                               processing_request(false), closed(false) {}
+    
+    // Re-initializes a pooled connection for a new socket, keeping its buffer capacity
+    void reuse(int socket_fd, Reactor* owner, uint32_t gen) {
+        fd = socket_fd;
+        reactor = owner;
+        generation = gen;
+        keep_alive = false;
+        last_activity = std::chrono::steady_clock::now();
+        
+        //keep small buffers around, give back what a large request or response grew
+        if (buffer.capacity() > RETAINED_CAPACITY) std::string().swap(buffer); else buffer.clear();
+        parser.reset();
+        upload.reset();
+        waiting_requests.clear();
+        rejected_upload.reset();
+        rejection_answered = false;
+        if (pending_response.capacity() > RETAINED_CAPACITY) std::string().swap(pending_response); else pending_response.clear();
+        pending_messages.clear();
+        pending_iov.clear();
+        iov_index = 0;
+        pending_file = FileRange{};
+        pending_generator = nullptr;
+        chunk_offset = chunk_end = 0;
+        send_in_flight = false;
+        deferred_request.reset();
+        has_pending_write = false;
+        processing_request = false;
+        closed = false;
+    }
+    
+    // The caller holds mutex_ for all of these.
+    // Parses whatever arrived since the last call; true once the request at the front of
+    // buffer is complete, or cannot be framed and has to be answered with a 400
+    bool request_ready() {
+        return !waiting_requests.empty() || (rejected_upload && !rejection_answered) ||
+               parser.parse(buffer) != ParseStatus::INCOMPLETE;
+    }
+    // Refuses the request at the front of buffer with status and drops what it sent so far
+    void reject_upload(HttpStatus status);
+    // The response refusing a rejected upload once it is next in line, nullopt otherwise
+    std::optional<HttpResponse> take_rejection();
+    // Arena for the next request, rewound first when nothing allocated from it is left; null
+    // (the heap) when earlier objects are still around and it has already grown too large
+    std::shared_ptr<Arena> request_arena();
+    // Appends the response to the ones going out in the next write
+    void queue_response(HttpResponse response);
+    // Another response can only follow when no file or generated body has to go out first
+    bool can_queue_response() const {
+        return pending_file.length == 0 && !pending_generator && pending_messages.size() < MAX_PIPELINED_RESPONSES;
+    }
+    // Builds pending_iov over everything queued; nothing may be queued until it is sent
+    void prepare_send();
+    // Skips the iovecs a write sent completely and trims the one it stopped in
+    void advance_iov(size_t written);
+    // True while a generated body still has bytes to go out
+    bool generating() const { return pending_generator || chunk_offset < chunk_end; }
+    // Frames the generator's next piece as a chunk, or the last chunk once it is done
+    void next_chunk();
+    // Drops everything sent, keeping buffer capacity for the next responses
+    void clear_pending_response();
+    
+    static constexpr size_t RETAINED_CAPACITY = 16 * 1024;
+    static constexpr size_t MAX_PIPELINED_RESPONSES = 32;
+    static constexpr size_t MAX_ARENA_SIZE = 256 * 1024;
+    static constexpr size_t GENERATED_CHUNK_SIZE = 16 * 1024;
+};
+
+// Connections of one reactor indexed directly by fd. Only the reactor thread inserts,
+// looks up and releases slots, so the event path takes no shared lock and does no hashing.
+// Each slot's generation is registered with the I/O backend and comes back in events;
+// an event queued for a socket that has since been closed, or whose fd number now belongs
+// to a newer connection, no longer matches and is dropped.
+//
+// Released connections that no worker still references go back to a free list, so
+// accepting a socket normally allocates nothing.
+class ConnectionTable {
+public:
+    ConnectionTable() : slots_(INITIAL_SLOTS) {}
+    
+    void preallocate(size_t count);
+    const std::shared_ptr<Connection>& insert(int fd, Reactor* owner);
+    const std::shared_ptr<Connection>& get(int fd, uint32_t generation) const;
+    void release(int fd);
+    
+    template <typename Fn>
+    void for_each(Fn&& fn) const {
+        for (const auto& slot : slots_) {
+            if (slot.conn) {
+                fn(slot.conn);
+            }
+        }
+    }
+    
+private:
+    struct Slot {
+        std::shared_ptr<Connection> conn;
+        uint32_t generation = 0;
+    };
+    
+    void recycle(std::shared_ptr<Connection>& conn);
+    
+    std::vector<Slot> slots_;
+    std::vector<std::shared_ptr<Connection>> free_;
+    
+    static const std::shared_ptr<Connection> empty_;
+    static constexpr size_t INITIAL_SLOTS = 1024;
+};
+
+// One event loop: its listening socket, I/O backend and connection table.
+// With SO_REUSEPORT the kernel spreads incoming connections across reactors.
+struct Reactor {
+    size_t id;
+    int listen_fd;
+    std::unique_ptr<IoBackend> io;
+    std::unique_ptr<std::thread> thread;
+    
+    ConnectionTable connections;
+    TimerWheel idle_timers;
+    
+    explicit Reactor(size_t reactor_id) : id(reactor_id), listen_fd(-1) {}
 };
 
 class Server {
 public:
-    explicit Server(int port = 8080, const std::string& host = "0.0.0.0", size_t thread_count = 0);
+    explicit Server(int port = 8080, const std::string& host = "0.0.0.0", size_t thread_count = 0,
+                    size_t reactor_count = 0);
     ~Server();
     
     bool start();
     void stop();
     bool is_running() const { return running_.load(); }
+    size_t get_reactor_count() const { return reactor_count_; }
     
 private:
-    void event_loop();
-    void handle_accept();
-    void handle_client_data(int client_fd);
-    void handle_client_request(std::shared_ptr<Connection> conn);
-    void handle_client_write(int client_fd);
+    int create_listen_socket();
+    void close_listen_sockets();
+    void event_loop(Reactor* reactor);
+    void handle_accept(Reactor& reactor);
+    void register_connection(Reactor& reactor, int client_fd);
+    void handle_client_data(const std::shared_ptr<Connection>& conn, const char* payload = nullptr, size_t payload_size = 0);
+    void offload_request(std::shared_ptr<Connection> conn, HttpRequest request);
+    void handle_parsed_request(std::shared_ptr<Connection> conn, HttpRequest& request);
+    void dispatch_request(std::shared_ptr<Connection> conn);
+    HttpResponse build_response(const HttpRequest& request);
+    std::optional<HttpResponse> try_build_response_inline(const HttpRequest& request);
+    void finish_request(std::shared_ptr<Connection> conn, HttpRequest request, HttpResponse response, bool on_worker);
     void send_response_async(std::shared_ptr<Connection> conn);
-    void close_connection(int client_fd);
-    void cleanup_inactive_connections();
+    void complete_send(const std::shared_ptr<Connection>& conn, int result);
+    void close_connection(Connection& conn);
+    uint32_t client_events(bool want_write) const;
+    void cleanup_inactive_connections(Reactor& reactor);
+    size_t get_connection_count() const;
     HttpResponse handle_api_request(const HttpRequest& request);
     std::string get_client_ip(int client_fd);
-    bool is_http_request_complete(const std::string& buffer);
+    HttpRequest take_request(Connection& conn);
+    HttpRequest take_parsed_request(Connection& conn);
+    bool stream_upload(Connection& conn);
     bool is_likely_http_request(const std::string& buffer);
     
-    int server_fd_;
     int port_;
     std::string host_;
     std::atomic<bool> running_;
     
-    std::unique_ptr<EpollWrapper> epoll_;
+    std::vector<std::unique_ptr<Reactor>> reactors_;
     std::unique_ptr<ThreadPool> thread_pool_;
-    std::unique_ptr<std::thread> event_thread_;
     std::unique_ptr<FileHandler> file_handler_;
     std::unique_ptr<RateLimiter> rate_limiter_;
     
-    std::unordered_map<int, std::shared_ptr<Connection>> connections_;
-    std::mutex connections_mutex_;
+    std::atomic<size_t> total_connections_;
     
     static constexpr int BUFFER_SIZE = 4096;
     static constexpr int BACKLOG = 1024;
+    static constexpr int ACCEPT_BATCH = 64;
     static constexpr int CONNECTION_TIMEOUT_SECONDS = 30;
     static constexpr size_t MAX_REQUEST_SIZE = 64 * 1024;
+    // Larger request bodies are streamed; an upload keeps up to this much in memory
+    // before it moves to a temporary file
+    static constexpr size_t UPLOAD_MEMORY_LIMIT = 256 * 1024;
+    // Upper bound on the bytes handed to a single sendfile() call
+    static constexpr size_t MAX_SENDFILE_CHUNK = 1024 * 1024;
     
     size_t max_connections_;
+    size_t reactor_count_;
+    DispatchMode dispatch_mode_;
+    bool edge_triggered_;
+    AcceptMode accept_mode_;
+    IoBackendType io_backend_type_;
+    size_t max_upload_size_;
+    std::string upload_temp_dir_;
 };
\ No newline at end of file
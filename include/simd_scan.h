@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+
+enum class SimdLevel {
+    SCALAR,
+    SSE2,
+    AVX2
+};
+
+// Byte-scanning kernels behind request parsing. The widest instruction set the CPU
+// supports is picked once at startup, with a scalar fallback everywhere else.
+// select_simd_level() forces another supported level so tests and benchmarks can compare
+// implementations; it must not be called while other threads are parsing.
+SimdLevel detected_simd_level();
+SimdLevel active_simd_level();
+bool select_simd_level(SimdLevel level);
+const char* simd_level_name(SimdLevel level);
+
+// Index of the first byte equal to a or b, size when there is none
+size_t scan_for_either(const char* data, size_t size, char a, char b);
+
+// Index just past the first "\r\n\r\n", 0 while the header block is incomplete
+size_t find_header_end(const char* data, size_t size);
+
+// True when any byte falls outside printable ASCII (0x20-0x7E)
+bool has_non_printable(const char* data, size_t size);
+
+// Percent-decodes src into out ('+' becomes a space); malformed escapes are kept as is.
+// Instantiated for std::string and std::pmr::string
+template <typename String>
+void url_decode_into(std::string_view src, String& out);
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+// Two-level hierarchical timing wheel for connection deadlines. The inner wheel has
+// one slot per tick, the outer wheel one slot per full turn of the inner wheel; outer
+// slots cascade into the inner wheel as time reaches them. Scheduling is O(1) and
+// advancing costs O(expired + cascaded), independent of how many timers are pending.
+//
+// Timers cannot be cancelled. Callers validate an expired timer against the current
+// state (fd generation, last activity) and schedule it again if it fired too early,
+// so activity never has to touch the wheel. Not thread-safe; each reactor owns one.
+class TimerWheel {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Timer {
+        int fd;
+        uint32_t generation;
+    };
+
+    explicit TimerWheel(std::chrono::milliseconds tick = std::chrono::milliseconds(100),
+                        Clock::time_point start = Clock::now());
+
+    // Deadlines past the wheel's range are clamped to its last slot
+    void schedule(const Timer& timer, Clock::time_point deadline);
+
+    // Moves every timer whose deadline is at or before now into expired
+    void advance(Clock::time_point now, std::vector<Timer>& expired);
+
+    // Milliseconds until the earliest pending timer may fire, -1 when none is pending
+    int next_timeout_ms(Clock::time_point now) const;
+
+    size_t size() const { return pending_; }
+
+private:
+    struct Entry {
+        Timer timer;
+        uint64_t deadline_tick;
+    };
+
+    uint64_t to_tick(Clock::time_point time) const;
+    void place(const Entry& entry);
+    void cascade();
+
+    static constexpr size_t INNER_BITS = 8;
+    static constexpr size_t INNER_SLOTS = 1 << INNER_BITS;
+    static constexpr size_t OUTER_SLOTS = 64;
+
+    std::array<std::vector<Entry>, INNER_SLOTS> inner_;
+    std::array<std::vector<Entry>, OUTER_SLOTS> outer_;
+
+    Clock::time_point start_;
+    std::chrono::milliseconds tick_;
+    uint64_t current_tick_;
+    size_t pending_;
+    size_t inner_pending_;
+};
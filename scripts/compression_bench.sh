@@ -0,0 +1,113 @@
+#!/bin/bash
+
+# Bytes on the wire with and without gzip: fetches every text asset in public/ once with
+# Accept-Encoding: gzip and once without, and reports the transferred size of each next to
+# the time a batch of keep-alive requests for it takes
+
+set -e
+
+SERVER_BIN="$(realpath ${SERVER_BIN:-./build/bin/webserver})"
+PROJECT_DIR="$(pwd)"
+SERVER_HOST="127.0.0.1"
+SERVER_PORT="8080"
+REQUESTS="${1:-200}"
+RESULTS_FILE="results/compression_bench.txt"
+
+GREEN='\033[0;32m'
+BLUE='\033[0;34m'
+RED='\033[0;31m'
+NC='\033[0m'
+
+print_header() {
+    echo -e "\n${BLUE}$1${NC}\n"
+}
+
+print_success() {
+    echo -e "${GREEN}[OK] $1${NC}"
+}
+
+print_error() {
+    echo -e "${RED}[ERROR] $1${NC}"
+}
+
+check_tool() {
+    if ! command -v $1 &> /dev/null; then
+        print_error "$1 is not installed. Please install it first."
+        exit 1
+    fi
+}
+
+wait_for_server() {
+    local count=0
+    local timeout=15
+
+    while ! curl -s -o /dev/null http://$SERVER_HOST:$SERVER_PORT/; do
+        sleep 1
+        count=$((count + 1))
+        if [ $count -ge $timeout ]; then
+            print_error "Timeout waiting for server"
+            return 1
+        fi
+    done
+}
+
+# prints "<bytes per response> <seconds for REQUESTS requests>" for one path and encoding
+measure() {
+    local path=$1
+    local encoding=$2
+    local url="http://$SERVER_HOST:$SERVER_PORT/$path"
+    local urls=()
+    for i in $(seq $REQUESTS); do
+        urls+=("$url")
+    done
+
+    #the first request fills the cache, the batch reuses one connection
+    local bytes=$(curl -s -o /dev/null -H "Accept-Encoding: $encoding" -w "%{size_download}" "$url")
+    local start=$(date +%s.%N)
+    curl -s -H "Accept-Encoding: $encoding" "${urls[@]}" > /dev/null
+    local end=$(date +%s.%N)
+
+    awk -v b="$bytes" -v s="$start" -v e="$end" 'BEGIN { printf "%d %.3f", b, e - s }'
+}
+
+main() {
+    print_header "Bytes on the Wire: gzip vs identity"
+
+    check_tool curl
+
+    if [ ! -x "$SERVER_BIN" ]; then
+        print_error "Server binary not found at $SERVER_BIN (build first or set SERVER_BIN)"
+        exit 1
+    fi
+
+    mkdir -p "$(dirname $RESULTS_FILE)"
+
+    local workdir=$(mktemp -d)
+    cp "$PROJECT_DIR/config.json" "$workdir/config.json"
+    cp -r "$PROJECT_DIR/public" "$workdir/public"
+    (cd "$workdir" && exec "$SERVER_BIN" $SERVER_PORT > /dev/null 2>&1) &
+    local server_pid=$!
+    wait_for_server
+
+    echo "Configuration:"
+    echo "- Requests per asset and encoding: $REQUESTS"
+    echo ""
+
+    {
+        printf "%-28s %-12s %-12s %-8s %-14s %-14s\n" "Asset" "identity" "gzip" "ratio" "identity time" "gzip time"
+        for file in $(cd "$workdir/public" && find . -type f \( -name "*.html" -o -name "*.css" -o -name "*.js" -o -name "*.json" -o -name "*.svg" -o -name "*.txt" \) | sed 's|^\./||' | sort); do
+            read plain_bytes plain_time <<< "$(measure "$file" identity)"
+            read gzip_bytes gzip_time <<< "$(measure "$file" gzip)"
+            local ratio=$(awk -v p="$plain_bytes" -v g="$gzip_bytes" 'BEGIN { printf "%.2f", (p > 0 ? g / p : 1) }')
+            printf "%-28s %-12s %-12s %-8s %-14s %-14s\n" "$file" "$plain_bytes" "$gzip_bytes" "$ratio" "${plain_time}s" "${gzip_time}s"
+        done
+    } | tee "$RESULTS_FILE"
+
+    kill -INT $server_pid 2>/dev/null || true
+    wait $server_pid 2>/dev/null || true
+    rm -rf "$workdir"
+
+    print_success "Results saved to $RESULTS_FILE"
+}
+
+main "$@"
@@ -0,0 +1,124 @@
+#!/bin/bash
+
+# Connection storm benchmark: accepts/sec
+# Every request opens a fresh connection (no keep-alive), so the server spends its time
+# accepting and tearing down sockets. Runs each accept mode with 1 and N reactors
+
+set -e
+
+SERVER_BIN="$(realpath ${SERVER_BIN:-./build/bin/webserver})"
+PROJECT_DIR="$(pwd)"
+SERVER_HOST="127.0.0.1"
+SERVER_PORT="8080"
+CONNECTIONS="${1:-50000}"
+CONCURRENCY="${2:-500}"
+MAX_REACTORS="$(nproc)"
+RESULTS_FILE="results/connection_storm.txt"
+
+GREEN='\033[0;32m'
+BLUE='\033[0;34m'
+RED='\033[0;31m'
+NC='\033[0m'
+
+print_header() {
+    echo -e "\n${BLUE}$1${NC}\n"
+}
+
+print_success() {
+    echo -e "${GREEN}[OK] $1${NC}"
+}
+
+print_error() {
+    echo -e "${RED}[ERROR] $1${NC}"
+}
+
+check_tool() {
+    if ! command -v $1 &> /dev/null; then
+        print_error "$1 is not installed. Please install it first."
+        exit 1
+    fi
+}
+
+wait_for_server() {
+    local count=0
+    local timeout=15
+
+    while ! nc -z $SERVER_HOST $SERVER_PORT 2>/dev/null; do
+        sleep 1
+        count=$((count + 1))
+        if [ $count -ge $timeout ]; then
+            print_error "Timeout waiting for server"
+            return 1
+        fi
+    done
+}
+
+# prints "<accepts/sec> <failed>" for one accept mode and reactor count
+measure() {
+    local mode=$1
+    local reactors=$2
+    local workdir=$(mktemp -d)
+
+    # run from a scratch directory so config.json can be switched per run
+    sed -e "s/\"accept_mode\": \"[a-z]*\"/\"accept_mode\": \"$mode\"/" \
+        -e "s/\"reactor_count\": [0-9]*/\"reactor_count\": $reactors/" \
+        "$PROJECT_DIR/config.json" > "$workdir/config.json"
+    cp -r "$PROJECT_DIR/public" "$workdir/public"
+
+    (cd "$workdir" && exec "$SERVER_BIN" $SERVER_PORT > /dev/null 2>&1) &
+    local server_pid=$!
+    wait_for_server
+
+    # one request per connection, every request is an accept
+    local output=$(ab -q -n $CONNECTIONS -c $CONCURRENCY http://$SERVER_HOST:$SERVER_PORT/)
+
+    kill -INT $server_pid 2>/dev/null || true
+    wait $server_pid 2>/dev/null || true
+    rm -rf "$workdir"
+
+    local rate=$(echo "$output" | awk '/Requests per second/ {print $4}')
+    local failed=$(echo "$output" | awk '/Failed requests/ {print $3}')
+    echo "$rate $failed"
+}
+
+main() {
+    print_header "Connection Storm Benchmark (accepts/sec)"
+
+    check_tool ab
+    check_tool nc
+
+    if [ ! -x "$SERVER_BIN" ]; then
+        print_error "Server binary not found at $SERVER_BIN (build first or set SERVER_BIN)"
+        exit 1
+    fi
+
+    if nc -z $SERVER_HOST $SERVER_PORT 2>/dev/null; then
+        print_error "Port $SERVER_PORT is already in use, stop the running server first"
+        exit 1
+    fi
+
+    mkdir -p "$(dirname $RESULTS_FILE)"
+
+    echo "Configuration:"
+    echo "- Connections: $CONNECTIONS (one request each)"
+    echo "- Concurrency: $CONCURRENCY"
+    echo ""
+
+    {
+        printf "%-12s %-10s %-15s %-10s\n" "Accept mode" "Reactors" "Accepts/sec" "Failed"
+        for mode in reuseport exclusive; do
+            for reactors in $(printf "1\n$MAX_REACTORS\n" | sort -un); do
+                # a single reactor has nobody to share the listener with
+                if [ "$mode" = "exclusive" ] && [ $reactors -eq 1 ]; then
+                    continue
+                fi
+                read rate failed <<< "$(measure $mode $reactors)"
+                printf "%-12s %-10s %-15s %-10s\n" "$mode" "$reactors" "$rate" "$failed"
+            done
+        done
+    } | tee "$RESULTS_FILE"
+
+    print_success "Results saved to $RESULTS_FILE"
+}
+
+main "$@"
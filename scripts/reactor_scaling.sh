@@ -0,0 +1,128 @@
+#!/bin/bash
+
+# Reactor scaling benchmark
+# Restarts the server with 1..N reactors and records requests/sec for each run
+
+set -e
+
+SERVER_BIN="${SERVER_BIN:-./build/bin/webserver}"
+SERVER_HOST="127.0.0.1"
+SERVER_PORT="8080"
+WORKER_THREADS="${WORKER_THREADS:-0}"
+MAX_REACTORS="${1:-$(nproc)}"
+DURATION="15s"
+CONNECTIONS="1000"
+THREADS="$(nproc)"
+RESULTS_FILE="results/reactor_scaling.txt"
+
+GREEN='\033[0;32m'
+BLUE='\033[0;34m'
+RED='\033[0;31m'
+NC='\033[0m'
+
+print_header() {
+    echo -e "\n${BLUE}$1${NC}\n"
+}
+
+print_success() {
+    echo -e "${GREEN}[OK] $1${NC}"
+}
+
+print_error() {
+    echo -e "${RED}[ERROR] $1${NC}"
+}
+
+wait_for_server() {
+    local count=0
+    local timeout=15
+
+    while ! nc -z $SERVER_HOST $SERVER_PORT 2>/dev/null; do
+        sleep 1
+        count=$((count + 1))
+        if [ $count -ge $timeout ]; then
+            print_error "Timeout waiting for server"
+            return 1
+        fi
+    done
+}
+
+stop_server() {
+    if [ -n "$SERVER_PID" ]; then
+        kill $SERVER_PID 2>/dev/null || true
+        wait $SERVER_PID 2>/dev/null || true
+        SERVER_PID=""
+    fi
+}
+
+run_with_reactors() {
+    local reactors=$1
+
+    $SERVER_BIN $SERVER_PORT $WORKER_THREADS $reactors > /dev/null 2>&1 &
+    SERVER_PID=$!
+    wait_for_server
+
+    # warm the file cache before measuring
+    wrk -t2 -c50 -d2s http://$SERVER_HOST:$SERVER_PORT/ > /dev/null
+
+    local rps=$(wrk -t$THREADS -c$CONNECTIONS -d$DURATION http://$SERVER_HOST:$SERVER_PORT/ \
+        | awk '/Requests\/sec/ {print $2}')
+
+    stop_server
+    sleep 1
+
+    echo "$rps"
+}
+
+main() {
+    print_header "Reactor Scaling Benchmark (1..$MAX_REACTORS reactors)"
+
+    if [ ! -x "$SERVER_BIN" ]; then
+        print_error "Server binary not found at $SERVER_BIN (build first or set SERVER_BIN)"
+        exit 1
+    fi
+
+    if ! command -v wrk &> /dev/null; then
+        print_error "wrk is not installed. Please install it first."
+        exit 1
+    fi
+
+    if nc -z $SERVER_HOST $SERVER_PORT 2>/dev/null; then
+        print_error "Port $SERVER_PORT is already in use, stop the running server first"
+        exit 1
+    fi
+
+    trap stop_server EXIT
+    mkdir -p "$(dirname $RESULTS_FILE)"
+
+    echo "Configuration:"
+    echo "- Duration: $DURATION"
+    echo "- Connections: $CONNECTIONS"
+    echo "- wrk threads: $THREADS"
+    echo ""
+
+    local baseline=""
+    {
+        printf "%-10s %-15s %-10s\n" "Reactors" "Requests/sec" "Speedup"
+        local reactors=1
+        while [ $reactors -le $MAX_REACTORS ]; do
+            local rps=$(run_with_reactors $reactors)
+            if [ -z "$baseline" ]; then
+                baseline=$rps
+            fi
+            local speedup=$(awk -v r="$rps" -v b="$baseline" 'BEGIN { if (b > 0) printf "%.2fx", r / b; else print "-" }')
+            printf "%-10s %-15s %-10s\n" "$reactors" "$rps" "$speedup"
+
+            if [ $reactors -eq $MAX_REACTORS ]; then
+                break
+            fi
+            reactors=$((reactors * 2))
+            if [ $reactors -gt $MAX_REACTORS ]; then
+                reactors=$MAX_REACTORS
+            fi
+        done
+    } | tee "$RESULTS_FILE"
+
+    print_success "Results saved to $RESULTS_FILE"
+}
+
+main "$@"
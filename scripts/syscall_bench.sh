@@ -0,0 +1,115 @@
+#!/bin/bash
+
+# Syscalls per request: level-triggered vs edge-triggered epoll
+# Runs the server under strace -c for a fixed number of keep-alive requests in each mode
+
+set -e
+
+SERVER_BIN="$(realpath ${SERVER_BIN:-./build/bin/webserver})"
+PROJECT_DIR="$(pwd)"
+SERVER_HOST="127.0.0.1"
+SERVER_PORT="8080"
+REQUESTS="${1:-20000}"
+CONCURRENCY="50"
+RESULTS_FILE="results/syscall_bench.txt"
+
+GREEN='\033[0;32m'
+BLUE='\033[0;34m'
+RED='\033[0;31m'
+NC='\033[0m'
+
+print_header() {
+    echo -e "\n${BLUE}$1${NC}\n"
+}
+
+print_success() {
+    echo -e "${GREEN}[OK] $1${NC}"
+}
+
+print_error() {
+    echo -e "${RED}[ERROR] $1${NC}"
+}
+
+check_tool() {
+    if ! command -v $1 &> /dev/null; then
+        print_error "$1 is not installed. Please install it first."
+        exit 1
+    fi
+}
+
+wait_for_server() {
+    local count=0
+    local timeout=15
+
+    while ! nc -z $SERVER_HOST $SERVER_PORT 2>/dev/null; do
+        sleep 1
+        count=$((count + 1))
+        if [ $count -ge $timeout ]; then
+            print_error "Timeout waiting for server"
+            return 1
+        fi
+    done
+}
+
+# prints "<syscalls> <syscalls per request>" for one mode and url
+measure() {
+    local edge_triggered=$1
+    local path=$2
+    local workdir=$(mktemp -d)
+
+    # run from a scratch directory so config.json can be switched per mode
+    sed "s/\"edge_triggered\": [a-z]*/\"edge_triggered\": $edge_triggered/" "$PROJECT_DIR/config.json" > "$workdir/config.json"
+    cp -r "$PROJECT_DIR/public" "$workdir/public"
+    head -c 262144 /dev/urandom > "$workdir/public/bench_256k.bin"
+
+    (cd "$workdir" && exec strace -f -c -o "$workdir/strace.txt" "$SERVER_BIN" $SERVER_PORT > /dev/null 2>&1) &
+    local strace_pid=$!
+    wait_for_server
+
+    ab -k -q -n $REQUESTS -c $CONCURRENCY http://$SERVER_HOST:$SERVER_PORT$path > /dev/null
+
+    pkill -INT -f "^$SERVER_BIN $SERVER_PORT" || true
+    wait $strace_pid 2>/dev/null || true
+
+    local total=$(awk '/^100.00/ {print $4}' "$workdir/strace.txt")
+    rm -rf "$workdir"
+
+    awk -v t="$total" -v n="$REQUESTS" 'BEGIN { printf "%d %.2f", t, t / n }'
+}
+
+main() {
+    print_header "Syscalls per Request: Level-Triggered vs Edge-Triggered"
+
+    check_tool strace
+    check_tool ab
+
+    if [ ! -x "$SERVER_BIN" ]; then
+        print_error "Server binary not found at $SERVER_BIN (build first or set SERVER_BIN)"
+        exit 1
+    fi
+
+    mkdir -p "$(dirname $RESULTS_FILE)"
+
+    echo "Configuration:"
+    echo "- Requests: $REQUESTS (keep-alive)"
+    echo "- Concurrency: $CONCURRENCY"
+    echo ""
+
+    {
+        printf "%-20s %-18s %-12s %-12s\n" "URL" "Mode" "Syscalls" "Per request"
+        for path in /test.html /bench_256k.bin; do
+            for mode in false true; do
+                local label="level-triggered"
+                if [ "$mode" = "true" ]; then
+                    label="edge-triggered"
+                fi
+                read total per_request <<< "$(measure $mode $path)"
+                printf "%-20s %-18s %-12s %-12s\n" "$path" "$label" "$total" "$per_request"
+            done
+        done
+    } | tee "$RESULTS_FILE"
+
+    print_success "Results saved to $RESULTS_FILE"
+}
+
+main "$@"
@@ -0,0 +1,114 @@
+#!/bin/bash
+
+# Upload throughput: POSTs one large body to /api/upload, once with Content-Length and once
+# chunked, and reports MB/s next to the server's peak resident memory, which should stay
+# flat whatever the body size since bodies are streamed to a temporary file
+
+set -e
+
+SERVER_BIN="$(realpath ${SERVER_BIN:-./build/bin/webserver})"
+PROJECT_DIR="$(pwd)"
+SERVER_HOST="127.0.0.1"
+SERVER_PORT="8080"
+UPLOAD_MB="${1:-512}"
+RESULTS_FILE="results/upload_bench.txt"
+
+GREEN='\033[0;32m'
+BLUE='\033[0;34m'
+RED='\033[0;31m'
+NC='\033[0m'
+
+print_header() {
+    echo -e "\n${BLUE}$1${NC}\n"
+}
+
+print_success() {
+    echo -e "${GREEN}[OK] $1${NC}"
+}
+
+print_error() {
+    echo -e "${RED}[ERROR] $1${NC}"
+}
+
+check_tool() {
+    if ! command -v $1 &> /dev/null; then
+        print_error "$1 is not installed. Please install it first."
+        exit 1
+    fi
+}
+
+wait_for_server() {
+    local count=0
+    local timeout=15
+
+    while ! curl -s -o /dev/null http://$SERVER_HOST:$SERVER_PORT/; do
+        sleep 1
+        count=$((count + 1))
+        if [ $count -ge $timeout ]; then
+            print_error "Timeout waiting for server"
+            return 1
+        fi
+    done
+}
+
+# prints "<status> <MB/s> <server VmHWM in KB>" for one upload against a fresh server
+measure() {
+    local encoding=$1
+    local body=$2
+    local workdir=$(mktemp -d)
+
+    cp "$PROJECT_DIR/config.json" "$workdir/config.json"
+    cp -r "$PROJECT_DIR/public" "$workdir/public"
+
+    (cd "$workdir" && exec "$SERVER_BIN" $SERVER_PORT > /dev/null 2>&1) &
+    local server_pid=$!
+    wait_for_server
+
+    local headers=()
+    if [ "$encoding" = "chunked" ]; then
+        headers=(-H "Transfer-Encoding: chunked")
+    fi
+    local result=$(curl -s -o /dev/null -w "%{http_code} %{speed_upload}" -X POST "${headers[@]}" \
+                   --data-binary @"$body" http://$SERVER_HOST:$SERVER_PORT/api/upload)
+    local peak=$(awk '/^VmHWM/ {print $2}' /proc/$server_pid/status)
+
+    kill -INT $server_pid 2>/dev/null || true
+    wait $server_pid 2>/dev/null || true
+    rm -rf "$workdir"
+
+    read status bytes_per_second <<< "$result"
+    awk -v s="$status" -v b="$bytes_per_second" -v p="$peak" 'BEGIN { printf "%s %.1f %d", s, b / 1048576, p }'
+}
+
+main() {
+    print_header "Upload Throughput: Content-Length vs Chunked"
+
+    check_tool curl
+
+    if [ ! -x "$SERVER_BIN" ]; then
+        print_error "Server binary not found at $SERVER_BIN (build first or set SERVER_BIN)"
+        exit 1
+    fi
+
+    mkdir -p "$(dirname $RESULTS_FILE)"
+
+    local body=$(mktemp)
+    head -c $((UPLOAD_MB * 1024 * 1024)) /dev/urandom > "$body"
+
+    echo "Configuration:"
+    echo "- Body size: ${UPLOAD_MB}MB"
+    echo ""
+
+    {
+        printf "%-16s %-8s %-10s %-16s\n" "Encoding" "Status" "MB/s" "Server peak RSS"
+        for encoding in content-length chunked; do
+            read status speed peak <<< "$(measure $encoding "$body")"
+            printf "%-16s %-8s %-10s %-16s\n" "$encoding" "$status" "$speed" "$((peak / 1024))MB"
+        done
+    } | tee "$RESULTS_FILE"
+
+    rm -f "$body"
+    print_success "Results saved to $RESULTS_FILE"
+}
+
+main "$@"
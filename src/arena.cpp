@@ -0,0 +1,66 @@
+#include "arena.h"
+#include <cstdint>
+
+namespace {
+
+thread_local const ArenaScope* active_scope = nullptr;
+
+const std::shared_ptr<Arena> NO_ARENA;
+
+size_t padding_for(const char* ptr, size_t alignment) {
+    size_t misalignment = reinterpret_cast<uintptr_t>(ptr) & (alignment - 1);
+    return misalignment ? alignment - misalignment : 0;
+}
+
+} // namespace
+
+void Arena::reset() {
+    overflow_.clear();
+    cursor_ = first_block_.get();
+    end_ = cursor_ ? cursor_ + block_size_ : nullptr;
+    allocated_ = 0;
+}
+
+void* Arena::do_allocate(size_t bytes, size_t alignment) {
+    allocated_ += bytes;
+
+    size_t padding = padding_for(cursor_, alignment);
+    if (cursor_ && padding + bytes <= static_cast<size_t>(end_ - cursor_)) {
+        char* result = cursor_ + padding;
+        cursor_ = result + bytes;
+        return result;
+    }
+
+    //a large body gets a block of its own and the current block stays in use
+    if (bytes > block_size_ / 4) {
+        char* block = new_block(bytes + alignment);
+        return block + padding_for(block, alignment);
+    }
+
+    cursor_ = new_block(block_size_);
+    end_ = cursor_ + block_size_;
+    char* result = cursor_ + padding_for(cursor_, alignment);
+    cursor_ = result + bytes;
+    return result;
+}
+
+char* Arena::new_block(size_t size) {
+    if (!first_block_ && size == block_size_) {
+        first_block_.reset(new char[size]);
+        return first_block_.get();
+    }
+    overflow_.emplace_back(new char[size]);
+    return overflow_.back().get();
+}
+
+ArenaScope::ArenaScope(std::shared_ptr<Arena> arena) : arena_(std::move(arena)), previous_(active_scope) {
+    active_scope = this;
+}
+
+ArenaScope::~ArenaScope() {
+    active_scope = previous_;
+}
+
+const std::shared_ptr<Arena>& ArenaScope::current() {
+    return active_scope ? active_scope->arena_ : NO_ARENA;
+}
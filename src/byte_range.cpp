@@ -0,0 +1,117 @@
+#include "byte_range.h"
+#include "http_headers.h"
+#include <algorithm>
+#include <charconv>
+
+namespace {
+
+// Digits only, no sign or whitespace
+bool parse_number(std::string_view text, uint64_t& number) {
+    if (text.empty()) {
+        return false;
+    }
+    auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), number);
+    return error == std::errc() && end == text.data() + text.size();
+}
+
+} // namespace
+
+RangeResult parse_range_header(std::string_view value, uint64_t size, std::vector<ByteRange>& ranges) {
+    ranges.clear();
+    
+    //the unit is case-insensitive, anything but bytes is left alone
+    value = trim_ows(value);
+    if (value.size() < 6 || !iequals(value.substr(0, 5), "bytes") || value[5] != '=') {
+        return RangeResult::NONE;
+    }
+    value.remove_prefix(6);
+    
+    size_t specs = 0;
+    while (!value.empty()) {
+        size_t comma = value.find(',');
+        std::string_view spec = trim_ows(value.substr(0, comma));
+        value.remove_prefix(comma == std::string_view::npos ? value.size() : comma + 1);
+        if (spec.empty()) {
+            continue; //empty list elements are allowed
+        }
+        if (++specs > MAX_RANGES) {
+            ranges.clear();
+            return RangeResult::NONE;
+        }
+        
+        size_t dash = spec.find('-');
+        if (dash == std::string_view::npos) {
+            ranges.clear();
+            return RangeResult::NONE;
+        }
+        
+        uint64_t first = 0;
+        uint64_t last = 0;
+        if (dash == 0) {
+            //the last n bytes
+            uint64_t suffix = 0;
+            if (!parse_number(spec.substr(1), suffix)) {
+                ranges.clear();
+                return RangeResult::NONE;
+            }
+            if (suffix == 0 || size == 0) {
+                continue;
+            }
+            first = suffix >= size ? 0 : size - suffix;
+            last = size - 1;
+        } else {
+            if (!parse_number(spec.substr(0, dash), first)) {
+                ranges.clear();
+                return RangeResult::NONE;
+            }
+            std::string_view last_text = spec.substr(dash + 1);
+            if (last_text.empty()) {
+                last = UINT64_MAX;
+            } else if (!parse_number(last_text, last) || last < first) {
+                ranges.clear();
+                return RangeResult::NONE;
+            }
+            if (first >= size) {
+                continue;
+            }
+            last = std::min(last, size - 1);
+        }
+        ranges.push_back({first, last});
+    }
+    
+    if (specs == 0) {
+        return RangeResult::NONE;
+    }
+    if (ranges.empty()) {
+        return RangeResult::UNSATISFIABLE;
+    }
+    
+    //overlapping ranges would send the same bytes twice, they are merged into ascending order
+    std::vector<ByteRange> sorted = ranges;
+    std::sort(sorted.begin(), sorted.end(), [](const ByteRange& a, const ByteRange& b) { return a.first < b.first; });
+    bool overlapping = false;
+    for (size_t i = 1; i < sorted.size(); ++i) {
+        overlapping = overlapping || sorted[i].first <= sorted[i - 1].last;
+    }
+    if (overlapping) {
+        ranges.clear();
+        for (const ByteRange& range : sorted) {
+            if (!ranges.empty() && range.first <= ranges.back().last) {
+                ranges.back().last = std::max(ranges.back().last, range.last);
+            } else {
+                ranges.push_back(range);
+            }
+        }
+    }
+    return RangeResult::SATISFIABLE;
+}
+
+std::string content_range(const ByteRange& range, uint64_t size) {
+    std::string header = "bytes ";
+    header += std::to_string(range.first);
+    header += '-';
+    header += std::to_string(range.last);
+    header += '/';
+    header += std::to_string(size);
+    return header;
+}
@@ -1,190 +1,210 @@
 #include "cache.h"
 #include <algorithm>
+#include <functional>
 #include <iostream>
 
-LRUCache::LRUCache(size_t max_size_mb, int ttl_seconds)
-    : max_size_bytes_(max_size_mb * 1024 * 1024)
-    , ttl_seconds_(ttl_seconds)
-    , current_size_(0)
-    , cache_hits_(0)
-    , cache_misses_(0) {
+LRUCache::LRUCache(size_t max_size_mb, int ttl_seconds, EvictionPolicyType policy, size_t shard_count)
+    : policy_(policy)
+    , max_size_bytes_(max_size_mb * 1024 * 1024)
+    , shard_capacity_(0)
+    , ttl_seconds_(ttl_seconds) {
+    
+    //small caches get fewer shards rather than shards too small for a large file
+    shard_count = std::max<size_t>(1, std::min(shard_count, max_size_bytes_ / MIN_SHARD_SIZE));
+    shard_capacity_ = max_size_bytes_ / shard_count;
+    for (size_t i = 0; i < shard_count; ++i) {
+        shards_.push_back(std::make_unique<Shard>());
+        shards_.back()->policy = make_eviction_policy(policy_, shard_capacity_);
+    }
     
-    std::cout << "LRU Cache initialized: " << max_size_mb << "MB max, " 
-              << ttl_seconds << "s TTL" << std::endl;
+    std::cout << "LRU Cache initialized: " << max_size_mb << "MB max, "
+              << ttl_seconds << "s TTL, " << shard_count << " shards, "
+              << eviction_policy_name(policy_) << " eviction" << std::endl;
 }
 
-std::optional<CacheEntry> LRUCache::get(const std::string& key) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    
-    auto it = cache_.find(key);
-    if (it == cache_.end()) {
-        cache_misses_++;
-        return std::nullopt;
+LRUCache::Shard& LRUCache::shard_for(uint64_t hash) const {
+    return *shards_[hash % shards_.size()];
+}
+
+std::shared_ptr<const CacheEntry> LRUCache::get(const std::string& key, bool record_miss) {
+    uint64_t hash = std::hash<std::string>{}(key);
+    Shard& shard = shard_for(hash);
+    bool expired = false;
+    {
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        
+        auto it = shard.map.find(key);
+        if (it != shard.map.end()) {
+            Slot& slot = it->second;
+            expired = is_expired(*slot.entry);
+            if (!expired) {
+                //the policy only records the hit, no list is touched, so no exclusive lock
+                shard.policy->on_hit(slot.node);
+                slot.entry->access_count.fetch_add(1, std::memory_order_relaxed);
+                cache_hits_.fetch_add(1, std::memory_order_relaxed);
+                return slot.entry;
+            }
+        } else {
+            shard.policy->on_miss(hash);
+        }
     }
     
-    auto& [entry, list_it] = it->second;
-    
-    //check if entry is expired
-    if (is_expired(entry)) {
-        lru_list_.erase(list_it);
-        current_size_ -= entry.data.size();
-        cache_.erase(it);
-        cache_misses_++;
-        return std::nullopt;
+    if (expired) {
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        auto it = shard.map.find(key);
+        if (it != shard.map.end() && is_expired(*it->second.entry)) {
+            erase(shard, it);
+        }
     }
-    
-    //move to front - most recently used 
-    lru_list_.erase(list_it);
-    lru_list_.push_front(key);
-    it->second.second = lru_list_.begin();
-    
-    //update access statistics
-    entry.last_accessed = std::chrono::steady_clock::now();
-    entry.access_count++;
-    
-    cache_hits_++;
-    return entry;
+    if (record_miss) {
+        cache_misses_.fetch_add(1, std::memory_order_relaxed);
+    }
+    return nullptr;
 }
 
-void LRUCache::put(const std::string& key, const std::vector<char>& data, const std::string& content_type) {
+std::shared_ptr<const CacheEntry> LRUCache::put(const std::string& key, std::vector<char> data, std::string content_type,
+                                                std::string response_head, std::string etag, time_t last_modified) {
     //inpput validation
     if (key.empty() || data.empty()) {
-        return;
+        return nullptr;
     }
     
-    std::lock_guard<std::mutex> lock(mutex_);
+    //built outside the lock, and never changed again
+    auto entry = std::make_shared<const CacheEntry>(std::move(data), std::move(content_type), std::move(response_head),
+                                                    std::move(etag), last_modified);
+    size_t new_entry_size = entry_size(*entry);
+    size_t capacity = shard_capacity_.load(std::memory_order_relaxed);
     
-    auto it = cache_.find(key);
-    if (it != cache_.end()) {
-        auto& [entry, list_it] = it->second;
-        current_size_ -= entry.data.size();
-        current_size_ += data.size();
-        
-        entry.data = data;
-        entry.content_type = content_type;
-        entry.created = std::chrono::steady_clock::now();
-        entry.last_accessed = entry.created;
-        entry.access_count = 1;
-        
-        lru_list_.erase(list_it);
-        lru_list_.push_front(key);
-        it->second.second = lru_list_.begin();
-        return;
+    // skip caching if single entry is too large
+    if (new_entry_size > capacity) {
+        std::cerr << "Warning: File too large to cache: " << new_entry_size
+                  << " bytes > " << capacity << " bytes" << std::endl;
+        return entry;
     }
     
-    size_t entry_size = data.size();
+    uint64_t hash = std::hash<std::string>{}(key);
+    Shard& shard = shard_for(hash);
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
     
-    //evict entries if necessary
-    while (current_size_ + entry_size > max_size_bytes_ && !cache_.empty()) {
-        evict_lru();
+    auto it = shard.map.find(key);
+    if (it != shard.map.end()) {
+        //a fresh entry, responses still sending the old one keep it alive
+        erase(shard, it);
     }
     
-    // skip caching if single entry is too large
-    if (entry_size > max_size_bytes_) {
-        std::cerr << "Warning: File too large to cache: " << entry_size 
-                  << " bytes > " << max_size_bytes_ << " bytes" << std::endl;
-        return;
+    //evict entries if necessary
+    while (shard.size + new_entry_size > capacity) {
+        PolicyNode* victim = shard.policy->victim();
+        if (!victim) {
+            break;
+        }
+        erase(shard, shard.map.find(*victim->key));
     }
     
     //add new entry
-    lru_list_.push_front(key);
-    CacheEntry entry(data, content_type);
-    cache_[key] = std::make_pair(entry, lru_list_.begin());
-    current_size_ += entry_size;
+    auto inserted = shard.map.try_emplace(key).first;
+    Slot& slot = inserted->second;
+    slot.entry = entry;
+    slot.node.key = &inserted->first;
+    slot.node.hash = hash;
+    slot.node.size = new_entry_size;
+    shard.policy->insert(slot.node);
+    shard.size += new_entry_size;
+    return entry;
 }
 
 void LRUCache::remove(const std::string& key) {
-    std::lock_guard<std::mutex> lock(mutex_);
+    Shard& shard = shard_for(std::hash<std::string>{}(key));
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
     
-    auto it = cache_.find(key);
-    if (it != cache_.end()) {
-        auto& [entry, list_it] = it->second;
-        current_size_ -= entry.data.size();
-        lru_list_.erase(list_it);
-        cache_.erase(it);
+    auto it = shard.map.find(key);
+    if (it != shard.map.end()) {
+        erase(shard, it);
     }
 }
 
 void LRUCache::clear() {
-    std::lock_guard<std::mutex> lock(mutex_);
-    
-    cache_.clear();
-    lru_list_.clear();
-    current_size_ = 0;
+    for (auto& shard : shards_) {
+        std::unique_lock<std::shared_mutex> lock(shard->mutex);
+        shard->map.clear();
+        shard->policy = make_eviction_policy(policy_, shard_capacity_);
+        shard->size = 0;
+    }
     cache_hits_ = 0;
     cache_misses_ = 0;
 }
 
-void LRUCache::evict_lru() {
-    // called from put() which already holds the mutex
-    if (lru_list_.empty()) {
-        return;
-    }
-    
-    // remove least recently used (back of list)
-    const std::string lru_key = lru_list_.back();
-    lru_list_.pop_back();
-    
-    auto it = cache_.find(lru_key);
-    if (it != cache_.end()) {
-        current_size_ -= it->second.first.data.size();
-        cache_.erase(it);
+void LRUCache::set_max_size(size_t max_size_mb) {
+    //shrinking takes effect as later puts evict
+    max_size_bytes_ = max_size_mb * 1024 * 1024;
+    shard_capacity_ = max_size_bytes_ / shards_.size();
+    for (auto& shard : shards_) {
+        std::unique_lock<std::shared_mutex> lock(shard->mutex);
+        shard->policy->set_capacity(shard_capacity_);
     }
 }
 
+void LRUCache::erase(Shard& shard, CacheMap::iterator it) {
+    shard.size -= entry_size(*it->second.entry);
+    shard.policy->remove(it->second.node);
+    shard.map.erase(it);
+}
+
 void LRUCache::evict_expired() {
-    std::lock_guard<std::mutex> lock(mutex_);
-    
-    std::vector<std::string> expired_keys;
-    
-    // first pass where we identify expired entries
-    for (const auto& [key, value] : cache_) {
-        if (is_expired(value.first)) {
-            expired_keys.push_back(key);
-        }
-    }
-    
-    //second pass where we safely remove expired entries
-    for (const std::string& key : expired_keys) {
-        auto it = cache_.find(key);
-        if (it != cache_.end()) {
-            current_size_ -= it->second.first.data.size();
-            lru_list_.erase(it->second.second);
-            cache_.erase(it);
+    for (auto& shard : shards_) {
+        std::unique_lock<std::shared_mutex> lock(shard->mutex);
+        for (auto it = shard->map.begin(); it != shard->map.end();) {
+            auto next = std::next(it);
+            if (is_expired(*it->second.entry)) {
+                erase(*shard, it);
+            }
+            it = next;
         }
     }
 }
 
 bool LRUCache::is_expired(const CacheEntry& entry) const {
-    if (ttl_seconds_ <= 0) {
+    int ttl_seconds = ttl_seconds_.load(std::memory_order_relaxed);
+    if (ttl_seconds <= 0) {
         return false;
     }
     
     auto now = std::chrono::steady_clock::now();
     auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(now - entry.created);
-    return elapsed.count() >= ttl_seconds_;
+    return elapsed.count() >= ttl_seconds;
+}
+
+size_t LRUCache::entry_size(const CacheEntry& entry) {
+    return entry.data.size() + entry.head.size();
 }
 
 size_t LRUCache::get_size() const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return current_size_;
+    size_t size = 0;
+    for (const auto& shard : shards_) {
+        std::shared_lock<std::shared_mutex> lock(shard->mutex);
+        size += shard->size;
+    }
+    return size;
 }
 
 size_t LRUCache::get_count() const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return cache_.size();
+    size_t count = 0;
+    for (const auto& shard : shards_) {
+        std::shared_lock<std::shared_mutex> lock(shard->mutex);
+        count += shard->map.size();
+    }
+    return count;
 }
 
 double LRUCache::get_hit_ratio() const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    size_t total_requests = cache_hits_ + cache_misses_;
-    return total_requests > 0 ? static_cast<double>(cache_hits_) / total_requests : 0.0;
+    size_t hits = cache_hits_.load(std::memory_order_relaxed);
+    size_t total_requests = hits + cache_misses_.load(std::memory_order_relaxed);
+    return total_requests > 0 ? static_cast<double>(hits) / total_requests : 0.0;
 }
 
 void LRUCache::get_stats(size_t& hits, size_t& misses, size_t& entries, size_t& memory_usage) const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    hits = cache_hits_;
-    misses = cache_misses_;
-    entries = cache_.size();
-    memory_usage = current_size_;
+    hits = cache_hits_.load(std::memory_order_relaxed);
+    misses = cache_misses_.load(std::memory_order_relaxed);
+    entries = get_count();
+    memory_usage = get_size();
 }
\ No newline at end of file
@@ -0,0 +1,98 @@
+#include "compression.h"
+#include "http_headers.h"
+#include <array>
+#include <climits>
+#include <iostream>
+#include <zlib.h>
+
+namespace {
+
+// Formats that carry their own compression
+constexpr std::array<std::string_view, 12> COMPRESSED_TYPES{{
+    "image/jpeg", "image/png", "image/gif", "image/webp",
+    "video/mp4", "video/quicktime", "video/x-msvideo", "audio/mpeg",
+    "application/zip", "application/gzip", "font/woff", "font/woff2"
+}};
+
+// q=0, q=0.0 and so on refuse a coding, any other weight accepts it
+bool has_nonzero_weight(std::string_view parameters) {
+    while (!parameters.empty()) {
+        size_t semicolon = parameters.find(';');
+        std::string_view parameter = trim_ows(parameters.substr(0, semicolon));
+        parameters.remove_prefix(semicolon == std::string_view::npos ? parameters.size() : semicolon + 1);
+
+        if (parameter.size() >= 2 && (parameter[0] == 'q' || parameter[0] == 'Q') && parameter[1] == '=') {
+            return parameter.find_first_of("123456789", 2) != std::string_view::npos;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+bool accepts_gzip(std::string_view accept_encoding) {
+    int gzip = -1; // -1 not listed, else whether it is accepted
+    bool wildcard = false;
+
+    while (!accept_encoding.empty()) {
+        size_t comma = accept_encoding.find(',');
+        std::string_view item = accept_encoding.substr(0, comma);
+        accept_encoding.remove_prefix(comma == std::string_view::npos ? accept_encoding.size() : comma + 1);
+
+        size_t semicolon = item.find(';');
+        std::string_view coding = trim_ows(item.substr(0, semicolon));
+        bool accepted = semicolon == std::string_view::npos || has_nonzero_weight(item.substr(semicolon + 1));
+
+        if (iequals(coding, "gzip") || iequals(coding, "x-gzip")) {
+            gzip = (gzip == 1 || accepted) ? 1 : 0;
+        } else if (coding == "*") {
+            wildcard = accepted;
+        }
+    }
+
+    //an explicit entry, refusal included, wins over the wildcard
+    return gzip == -1 ? wildcard : gzip == 1;
+}
+
+bool is_compressible(std::string_view mime_type) {
+    mime_type = trim_ows(mime_type.substr(0, mime_type.find(';')));
+    if (mime_type.empty() || iequals(mime_type, "application/octet-stream")) {
+        return false;
+    }
+    for (std::string_view compressed : COMPRESSED_TYPES) {
+        if (iequals(mime_type, compressed)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool gzip_compress(const char* data, size_t size, std::vector<char>& out, int level) {
+    if (size > UINT_MAX) {
+        return false;
+    }
+
+    z_stream stream{};
+    //15 window bits plus 16 selects the gzip wrapper instead of zlib's own
+    if (deflateInit2(&stream, level, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        std::cerr << "gzip: deflateInit2 failed" << std::endl;
+        return false;
+    }
+
+    out.resize(deflateBound(&stream, static_cast<uLong>(size)));
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+    stream.avail_in = static_cast<uInt>(size);
+    stream.next_out = reinterpret_cast<Bytef*>(out.data());
+    stream.avail_out = static_cast<uInt>(out.size());
+
+    //the output buffer holds the worst case, so one call finishes the stream
+    int result = deflate(&stream, Z_FINISH);
+    out.resize(stream.total_out);
+    deflateEnd(&stream);
+
+    if (result != Z_STREAM_END) {
+        std::cerr << "gzip: deflate failed (" << result << ")" << std::endl;
+        return false;
+    }
+    return true;
+}
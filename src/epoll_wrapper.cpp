@@ -1,14 +1,18 @@
 #include "epoll_wrapper.h"
 #include <unistd.h>
 #include <fcntl.h>
+#include <sys/eventfd.h>
 #include <iostream>
 #include <cstring>
 
-EpollWrapper::EpollWrapper() : epoll_fd_(-1) {
+EpollWrapper::EpollWrapper() : epoll_fd_(-1), wakeup_fd_(-1) {
     events_buffer_.resize(MAX_EVENTS);
 }
 
 EpollWrapper::~EpollWrapper() {
+    if (wakeup_fd_ != -1) {
+        close(wakeup_fd_);
+    }
     if (epoll_fd_ != -1) {
         close(epoll_fd_);
     }
@@ -20,13 +24,19 @@ bool EpollWrapper::init() {
         std::cerr << "Failed to create epoll instance: " << strerror(errno) << std::endl;
         return false;
     }
+    
+    wakeup_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wakeup_fd_ == -1 || !add_fd(wakeup_fd_, EPOLLIN)) {
+        std::cerr << "Failed to create epoll wakeup eventfd: " << strerror(errno) << std::endl;
+        return false;
+    }
     return true;
 }
 
-bool EpollWrapper::add_fd(int fd, uint32_t events, void* data) {
+bool EpollWrapper::add_fd(int fd, uint32_t events, uint32_t generation) {
     epoll_event event{};
     event.events = events;
-    event.data.fd = fd;
+    event.data.u64 = pack(fd, generation);
     
     if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &event) == -1) {
         if (errno == ENOMEM || errno == ENOSPC) {
@@ -37,29 +47,19 @@ bool EpollWrapper::add_fd(int fd, uint32_t events, void* data) {
         return false;
     }
     
-    if (data) {
-        std::lock_guard<std::mutex> lock(fd_data_mutex_);
-        fd_data_[fd] = data;
-    }
-    
     return true;
 }
 
-bool EpollWrapper::modify_fd(int fd, uint32_t events, void* data) {
+bool EpollWrapper::modify_fd(int fd, uint32_t events, uint32_t generation) {
     epoll_event event{};
     event.events = events;
-    event.data.fd = fd;
+    event.data.u64 = pack(fd, generation);
     
     if (epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, fd, &event) == -1) {
         std::cerr << "Failed to modify fd " << fd << " in epoll: " << strerror(errno) << std::endl;
         return false;
     }
     
-    if (data) {
-        std::lock_guard<std::mutex> lock(fd_data_mutex_);
-        fd_data_[fd] = data;
-    }
-    
     return true;
 }
 
@@ -73,11 +73,6 @@ bool EpollWrapper::remove_fd(int fd) {
         epoll_success = false;
     }
     
-    {
-        std::lock_guard<std::mutex> lock(fd_data_mutex_);
-        fd_data_.erase(fd);
-    }
-    
     return epoll_success;
 }
 
@@ -94,20 +89,31 @@ int EpollWrapper::wait_for_events(std::vector<Event>& events, int timeout_ms) {
     events.clear();
     events.reserve(num_events);
     
-    std::lock_guard<std::mutex> lock(fd_data_mutex_);
-    
     for (int i = 0; i < num_events; ++i) {
         Event event{};
-        event.fd = events_buffer_[i].data.fd;
-        event.events = events_buffer_[i].events;
+        event.fd = static_cast<int>(events_buffer_[i].data.u64 & 0xFFFFFFFF);
         
-        auto it = fd_data_.find(event.fd);
-        event.data = (it != fd_data_.end()) ? it->second : nullptr;
+        if (event.fd == wakeup_fd_) {
+            uint64_t value;
+            while (read(wakeup_fd_, &value, sizeof(value)) > 0) {}
+            continue;
+        }
+        
+        event.generation = static_cast<uint32_t>(events_buffer_[i].data.u64 >> 32);
+        event.events = events_buffer_[i].events;
         
         events.push_back(event);
     }
     
-    return num_events;
+    return static_cast<int>(events.size());
+}
+
+void EpollWrapper::wakeup() {
+    if (wakeup_fd_ != -1) {
+        uint64_t one = 1;
+        ssize_t ignored = write(wakeup_fd_, &one, sizeof(one));
+        (void)ignored;
+    }
 }
 
 bool EpollWrapper::set_non_blocking(int fd) {
@@ -0,0 +1,86 @@
+#include "etag.h"
+#include <cstdint>
+
+namespace {
+
+void append_hex(std::string& out, uint64_t value) {
+    static constexpr char HEX[] = "0123456789abcdef";
+    char digits[16];
+    size_t count = 0;
+    do {
+        digits[count++] = HEX[value & 0xf];
+        value >>= 4;
+    } while (value != 0);
+    while (count > 0) {
+        out += digits[--count];
+    }
+}
+
+std::string_view opaque_tag(std::string_view tag) {
+    if (tag.size() >= 2 && tag[0] == 'W' && tag[1] == '/') {
+        tag.remove_prefix(2);
+    }
+    return tag;
+}
+
+} // namespace
+
+std::string file_etag(const struct stat& file_stat, bool gzip) {
+    uint64_t modified = static_cast<uint64_t>(file_stat.st_mtim.tv_sec) * 1000000000ULL +
+                        static_cast<uint64_t>(file_stat.st_mtim.tv_nsec);
+    std::string etag = "\"";
+    append_hex(etag, static_cast<uint64_t>(file_stat.st_ino));
+    etag += '-';
+    append_hex(etag, modified);
+    etag += '-';
+    append_hex(etag, static_cast<uint64_t>(file_stat.st_size));
+    if (gzip) {
+        etag += "-gz";
+    }
+    etag += '"';
+    return etag;
+}
+
+bool etag_list_matches(std::string_view list, std::string_view etag, bool weak) {
+    if (etag.empty()) {
+        return false;
+    }
+    if (weak) {
+        etag = opaque_tag(etag);
+    } else if (opaque_tag(etag).size() != etag.size()) {
+        return false;
+    }
+    
+    size_t at = 0;
+    while (at < list.size()) {
+        char c = list[at];
+        if (c == ' ' || c == '\t' || c == ',') {
+            ++at;
+            continue;
+        }
+        if (c == '*') {
+            return true;
+        }
+        
+        //an opaque tag may itself contain commas, so it runs to its closing quote
+        size_t start = at;
+        bool weak_tag = list.compare(at, 2, "W/") == 0;
+        if (weak_tag) {
+            at += 2;
+        }
+        if (at >= list.size() || list[at] != '"') {
+            return false;
+        }
+        size_t close = list.find('"', at + 1);
+        if (close == std::string_view::npos) {
+            return false;
+        }
+        std::string_view tag = list.substr(start, close + 1 - start);
+        at = close + 1;
+        
+        if (weak ? opaque_tag(tag) == etag : (!weak_tag && tag == etag)) {
+            return true;
+        }
+    }
+    return false;
+}
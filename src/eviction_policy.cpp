@@ -0,0 +1,320 @@
+#include "eviction_policy.h"
+#include <algorithm>
+#include <deque>
+#include <unordered_map>
+
+namespace {
+
+// Files average a few KB, which sizes the sketch from a shard's capacity
+constexpr size_t ASSUMED_ENTRY_SIZE = 4096;
+
+// A FIFO or recency list of nodes with the bytes it holds; front is newest
+class Queue {
+public:
+    explicit Queue(uint8_t id) : id_(id) {}
+
+    bool empty() const { return nodes_.empty(); }
+    size_t bytes() const { return bytes_; }
+    size_t count() const { return nodes_.size(); }
+    PolicyNode* back() const { return nodes_.back(); }
+
+    void push_front(PolicyNode& node) {
+        nodes_.push_front(&node);
+        node.position = nodes_.begin();
+        node.queue = id_;
+        bytes_ += node.size;
+    }
+    void erase(PolicyNode& node) {
+        nodes_.erase(node.position);
+        bytes_ -= node.size;
+    }
+    // Moves node, which may be in another queue, to the front of this one
+    void move_to_front(PolicyNode& node, Queue& from) {
+        from.erase(node);
+        push_front(node);
+    }
+
+private:
+    uint8_t id_;
+    std::list<PolicyNode*> nodes_;
+    size_t bytes_ = 0;
+};
+
+class ClockPolicy : public EvictionPolicy {
+public:
+    using EvictionPolicy::EvictionPolicy;
+
+    void on_hit(PolicyNode& node) override { node.frequency.store(1, std::memory_order_relaxed); }
+    void insert(PolicyNode& node) override {
+        //unreferenced, so a one-off is the first to go
+        node.frequency.store(0, std::memory_order_relaxed);
+        queue_.push_front(node);
+    }
+    void remove(PolicyNode& node) override { queue_.erase(node); }
+
+    PolicyNode* victim() override {
+        //every referenced entry gets its bit cleared on the way, so at most one full sweep
+        while (!queue_.empty()) {
+            PolicyNode* node = queue_.back();
+            if (node->frequency.exchange(0, std::memory_order_relaxed) == 0) {
+                return node;
+            }
+            //second chance: moved to the front as if it had just been inserted
+            queue_.move_to_front(*node, queue_);
+        }
+        return nullptr;
+    }
+
+private:
+    Queue queue_{0};
+};
+
+// S3-FIFO (Yang et al., SOSP '23): new entries go to a small FIFO holding a tenth of the
+// bytes. Ones hit while there move on to the main FIFO, the rest leave after a single pass
+// and are remembered in a ghost queue, so a scan never reaches main. A ghost that comes back
+// goes straight to main. Main gives entries hit since their last pass another one.
+class S3FifoPolicy : public EvictionPolicy {
+public:
+    using EvictionPolicy::EvictionPolicy;
+
+    void on_hit(PolicyNode& node) override {
+        //a racing hit may be lost, the count is only a hint
+        uint8_t frequency = node.frequency.load(std::memory_order_relaxed);
+        if (frequency < MAX_FREQUENCY) {
+            node.frequency.store(frequency + 1, std::memory_order_relaxed);
+        }
+    }
+
+    void insert(PolicyNode& node) override {
+        node.frequency.store(0, std::memory_order_relaxed);
+        auto ghost = ghost_counts_.find(node.hash);
+        if (ghost != ghost_counts_.end()) {
+            //the ghost stays queued and is skipped when it reaches the front
+            if (--ghost->second == 0) {
+                ghost_counts_.erase(ghost);
+            }
+            main_.push_front(node);
+        } else {
+            small_.push_front(node);
+        }
+    }
+
+    void remove(PolicyNode& node) override { (node.queue == SMALL ? small_ : main_).erase(node); }
+
+    PolicyNode* victim() override {
+        while (true) {
+            if (!small_.empty() && (small_.bytes() >= capacity_ / 10 || main_.empty())) {
+                PolicyNode* node = small_.back();
+                if (node->frequency.load(std::memory_order_relaxed) > 0) {
+                    node->frequency.store(0, std::memory_order_relaxed);
+                    main_.move_to_front(*node, small_);
+                    continue;
+                }
+                remember(node->hash);
+                return node;
+            }
+            if (main_.empty()) {
+                return nullptr;
+            }
+
+            //frequencies only go down here, so this ends within MAX_FREQUENCY passes
+            PolicyNode* node = main_.back();
+            uint8_t frequency = node->frequency.load(std::memory_order_relaxed);
+            if (frequency == 0) {
+                return node;
+            }
+            node->frequency.store(frequency - 1, std::memory_order_relaxed);
+            main_.move_to_front(*node, main_);
+        }
+    }
+
+private:
+    enum : uint8_t { SMALL, MAIN };
+    static constexpr uint8_t MAX_FREQUENCY = 3;
+
+    // The ghost queue holds as many keys as the cache holds entries
+    void remember(uint64_t hash) {
+        ghosts_.push_back(hash);
+        ++ghost_counts_[hash];
+        size_t limit = std::max<size_t>(small_.count() + main_.count(), 64);
+        while (ghosts_.size() > limit) {
+            auto oldest = ghost_counts_.find(ghosts_.front());
+            if (oldest != ghost_counts_.end() && --oldest->second == 0) {
+                ghost_counts_.erase(oldest);
+            }
+            ghosts_.pop_front();
+        }
+    }
+
+    Queue small_{SMALL};
+    Queue main_{MAIN};
+    std::deque<uint64_t> ghosts_;
+    std::unordered_map<uint64_t, uint32_t> ghost_counts_;
+};
+
+// W-TinyLFU (Einziger et al., 2017): new entries go to a window holding 1% of the bytes.
+// Entries leaving the window join the main area only by beating main's next victim on the
+// frequency sketch, which every lookup feeds, so a scan of cold keys loses to the hot set.
+// Main is segmented: probation, and protected for entries hit again while on probation.
+// Hits only set a flag; promotions happen when the flagged entry reaches the end of probation.
+class WTinyLfuPolicy : public EvictionPolicy {
+public:
+    explicit WTinyLfuPolicy(size_t capacity)
+        : EvictionPolicy(capacity), sketch_(std::max<size_t>(capacity / ASSUMED_ENTRY_SIZE, 1)) {}
+
+    void on_hit(PolicyNode& node) override {
+        sketch_.increment(node.hash);
+        node.frequency.store(1, std::memory_order_relaxed);
+    }
+    void on_miss(uint64_t hash) override { sketch_.increment(hash); }
+
+    void insert(PolicyNode& node) override {
+        node.frequency.store(0, std::memory_order_relaxed);
+        window_.push_front(node);
+    }
+
+    void remove(PolicyNode& node) override { queue(node.queue).erase(node); }
+
+    PolicyNode* victim() override {
+        //the window's overflow joins probation, the newest arrival then has to win its place
+        PolicyNode* candidate = nullptr;
+        while (window_.bytes() > capacity_ / 100) {
+            candidate = window_.back();
+            probation_.move_to_front(*candidate, window_);
+        }
+
+        PolicyNode* main_victim = next_main_victim();
+        if (!main_victim) {
+            return window_.empty() ? nullptr : window_.back();
+        }
+        //ties go to the resident, a new key has to prove itself
+        if (candidate && candidate != main_victim && sketch_.estimate(candidate->hash) <= sketch_.estimate(main_victim->hash)) {
+            return candidate;
+        }
+        return main_victim;
+    }
+
+private:
+    enum : uint8_t { WINDOW, PROBATION, PROTECTED };
+
+    Queue& queue(uint8_t id) { return id == WINDOW ? window_ : id == PROBATION ? probation_ : protected_; }
+
+    // The oldest unflagged entry on probation, after promoting the flagged ones it passes
+    PolicyNode* next_main_victim() {
+        while (!probation_.empty()) {
+            PolicyNode* node = probation_.back();
+            if (node->frequency.exchange(0, std::memory_order_relaxed) == 0) {
+                return node;
+            }
+            protected_.move_to_front(*node, probation_);
+
+            //protected keeps four fifths of main, its overflow steps back down
+            size_t protected_capacity = (capacity_ - capacity_ / 100) / 5 * 4;
+            while (protected_.bytes() > protected_capacity && protected_.count() > 1) {
+                demote();
+            }
+        }
+
+        //everything in main is protected, its oldest goes back on probation to be judged
+        if (!protected_.empty()) {
+            demote();
+            return probation_.back();
+        }
+        return nullptr;
+    }
+
+    // Protected is ordered by promotion; its oldest keeps its flag, so one hit since the
+    // promotion sends it straight back. Flags are only cleared on promotion, so the victim
+    // search clears each at most once and ends.
+    void demote() { probation_.move_to_front(*protected_.back(), protected_); }
+
+    Queue window_{WINDOW};
+    Queue probation_{PROBATION};
+    Queue protected_{PROTECTED};
+    CountMinSketch sketch_;
+};
+
+// Independent multipliers, one per sketch row
+constexpr uint64_t ROW_SEEDS[] = {0x9E3779B97F4A7C15ULL, 0xC2B2AE3D27D4EB4FULL, 0x165667B19E3779F9ULL,
+                                  0xD6E8FEB86659FD93ULL};
+
+} // namespace
+
+std::optional<EvictionPolicyType> parse_eviction_policy(std::string_view name) {
+    if (name == "lru") {
+        return EvictionPolicyType::LRU;
+    }
+    if (name == "s3-fifo") {
+        return EvictionPolicyType::S3_FIFO;
+    }
+    if (name == "w-tinylfu") {
+        return EvictionPolicyType::W_TINY_LFU;
+    }
+    return std::nullopt;
+}
+
+std::string_view eviction_policy_name(EvictionPolicyType type) {
+    switch (type) {
+        case EvictionPolicyType::LRU: return "lru";
+        case EvictionPolicyType::S3_FIFO: return "s3-fifo";
+        case EvictionPolicyType::W_TINY_LFU: return "w-tinylfu";
+    }
+    return "unknown";
+}
+
+std::unique_ptr<EvictionPolicy> make_eviction_policy(EvictionPolicyType type, size_t capacity) {
+    switch (type) {
+        case EvictionPolicyType::S3_FIFO: return std::make_unique<S3FifoPolicy>(capacity);
+        case EvictionPolicyType::W_TINY_LFU: return std::make_unique<WTinyLfuPolicy>(capacity);
+        case EvictionPolicyType::LRU: break;
+    }
+    return std::make_unique<ClockPolicy>(capacity);
+}
+
+CountMinSketch::CountMinSketch(size_t expected_entries) {
+    //a power of two of at least four columns per expected entry, so collisions stay rare and a row index is a shift
+    width_bits_ = 8;
+    while ((size_t{1} << width_bits_) < 4 * expected_entries && width_bits_ < 24) {
+        ++width_bits_;
+    }
+    width_ = size_t{1} << width_bits_;
+    counters_.reset(new std::atomic<uint8_t>[ROWS * width_]());
+    sample_size_ = 10 * std::max<size_t>(expected_entries, 1);
+}
+
+size_t CountMinSketch::index(uint64_t hash, size_t row) const {
+    return row * width_ + static_cast<size_t>((hash * ROW_SEEDS[row]) >> (64 - width_bits_));
+}
+
+void CountMinSketch::increment(uint64_t hash) {
+    for (size_t row = 0; row < ROWS; ++row) {
+        std::atomic<uint8_t>& counter = counters_[index(hash, row)];
+        uint8_t count = counter.load(std::memory_order_relaxed);
+        if (count < MAX_COUNT) {
+            counter.store(count + 1, std::memory_order_relaxed);
+        }
+    }
+    if (additions_.fetch_add(1, std::memory_order_relaxed) + 1 >= sample_size_) {
+        age();
+    }
+}
+
+uint8_t CountMinSketch::estimate(uint64_t hash) const {
+    uint8_t estimate = MAX_COUNT;
+    for (size_t row = 0; row < ROWS; ++row) {
+        estimate = std::min(estimate, counters_[index(hash, row)].load(std::memory_order_relaxed));
+    }
+    return estimate;
+}
+
+void CountMinSketch::age() {
+    //one thread halves, increments racing with it only blur counts that are estimates anyway
+    if (aging_.exchange(true, std::memory_order_acquire)) {
+        return;
+    }
+    for (size_t i = 0; i < ROWS * width_; ++i) {
+        counters_[i].store(counters_[i].load(std::memory_order_relaxed) / 2, std::memory_order_relaxed);
+    }
+    additions_.store(sample_size_ / 2, std::memory_order_relaxed);
+    aging_.store(false, std::memory_order_release);
+}
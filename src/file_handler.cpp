@@ -1,16 +1,151 @@
 #include "file_handler.h"
+#include "compression.h"
+#include "byte_range.h"
+#include "http_date.h"
+#include "etag.h"
 #include <fstream>
 #include <sstream>
 #include <chrono>
 #include <iomanip>
 #include <algorithm>
 #include <iostream>
+#include <cstring>
+#include <random>
+#include <fcntl.h>
+#include <sys/stat.h>
 
-FileHandler::FileHandler(const std::string& document_root, const std::string& default_file, bool enable_cache, size_t cache_size_mb)
-    : document_root_(document_root), default_file_(default_file), max_file_size_(DEFAULT_MAX_FILE_SIZE), cache_enabled_(enable_cache) {
+namespace {
+
+// The gzip variant of a file is cached under its path plus a suffix no path can contain
+constexpr std::string_view GZIP_VARIANT_SUFFIX("\0gzip", 5);
+
+std::string gzip_cache_key(const std::string& resolved_path) {
+    std::string key = resolved_path;
+    key += GZIP_VARIANT_SUFFIX;
+    return key;
+}
+
+// ".html" for "/srv/public/index.html", empty without an extension
+std::string_view extension_of(std::string_view path) {
+    size_t dot = path.find_last_of("./");
+    if (dot == std::string_view::npos || path[dot] != '.' || dot == 0 || path[dot - 1] == '/') {
+        return {};
+    }
+    return path.substr(dot);
+}
+
+// 16 random hex digits; a boundary only has to be unlikely to occur inside the parts
+std::string multipart_boundary() {
+    thread_local std::mt19937_64 generator(std::random_device{}());
+    static constexpr char HEX[] = "0123456789abcdef";
+    
+    uint64_t bits = generator();
+    std::string boundary(16, '0');
+    for (char& digit : boundary) {
+        digit = HEX[bits & 0xf];
+        bits >>= 4;
+    }
+    return boundary;
+}
+
+HttpResponse create_unsatisfiable_response(uint64_t size) {
+    HttpResponse response = HttpResponse::create_error_response(HttpStatus::RANGE_NOT_SATISFIABLE, "Requested range not satisfiable");
+    std::string content_range = "bytes */";
+    content_range += std::to_string(size);
+    response.set_header(HeaderId::CONTENT_RANGE, content_range);
+    return response;
+}
+
+// A multipart/byteranges body: the delimiters and part headers are formatted into one string
+// and every part's bytes, at parts[i] for ranges[i], are sent in place from owner
+HttpResponse create_multipart_response(const std::vector<ByteRange>& ranges, uint64_t size, std::string_view mime_type,
+                                       std::shared_ptr<const void> owner, const std::vector<const char*>& parts) {
+    std::string boundary = multipart_boundary();
+    
+    //offsets into delimiters, which must not grow once segments point into it
+    auto delimiters = std::make_shared<std::string>();
+    std::vector<std::pair<size_t, size_t>> pieces;
+    for (const ByteRange& range : ranges) {
+        size_t start = delimiters->size();
+        delimiters->append("\r\n--").append(boundary).append("\r\n");
+        delimiters->append("Content-Type: ").append(mime_type).append("\r\n");
+        delimiters->append("Content-Range: ").append(content_range(range, size)).append("\r\n\r\n");
+        pieces.emplace_back(start, delimiters->size() - start);
+    }
+    size_t closing = delimiters->size();
+    delimiters->append("\r\n--").append(boundary).append("--\r\n");
+    
+    HttpResponse response(HttpStatus::PARTIAL_CONTENT);
+    std::shared_ptr<const std::string> text = std::move(delimiters);
+    for (size_t i = 0; i < ranges.size(); ++i) {
+        response.append_body_segment(BodySegment{text, text->data() + pieces[i].first, pieces[i].second});
+        response.append_body_segment(BodySegment{owner, parts[i], static_cast<size_t>(ranges[i].length())});
+    }
+    response.append_body_segment(BodySegment{text, text->data() + closing, text->size() - closing});
+    response.set_content_type("multipart/byteranges; boundary=" + boundary);
+    return response;
+}
+
+// A directory listing that is turned into HTML a row at a time while it is sent, so only
+// one row of it is ever held as text
+class DirectoryListing {
+public:
+    struct Row {
+        std::string name;
+        std::string link;
+        std::string size;
+        std::string modified;
+    };
+    
+    // head is the page up to the first row
+    DirectoryListing(std::string head, std::vector<Row> rows) : piece_(std::move(head)), rows_(std::move(rows)) {}
+    
+    // BodyGenerator
+    size_t operator()(char* buffer, size_t capacity) {
+        size_t written = 0;
+        while (written < capacity && (piece_offset_ < piece_.size() || next_piece())) {
+            size_t length = std::min(capacity - written, piece_.size() - piece_offset_);
+            memcpy(buffer + written, piece_.data() + piece_offset_, length);
+            piece_offset_ += length;
+            written += length;
+        }
+        return written;
+    }
+    
+private:
+    bool next_piece() {
+        piece_.clear();
+        piece_offset_ = 0;
+        if (next_row_ < rows_.size()) {
+            const Row& row = rows_[next_row_++];
+            piece_.append("<tr><td><a href=\"").append(row.link).append("\">").append(row.name).append("</a></td>");
+            piece_.append("<td>").append(row.size).append("</td>");
+            piece_.append("<td>").append(row.modified).append("</td></tr>\n");
+            return true;
+        }
+        if (!finished_) {
+            piece_ = "</table>\n<hr>\n<p><em>MultithreadedWebServer/1.0</em></p>\n</body></html>\n";
+            finished_ = true;
+            return true;
+        }
+        return false;
+    }
+    
+    std::string piece_;
+    size_t piece_offset_ = 0;
+    std::vector<Row> rows_;
+    size_t next_row_ = 0;
+    bool finished_ = false;
+};
+
+} // namespace
+
+FileHandler::FileHandler(const std::string& document_root, const std::string& default_file, bool enable_cache, size_t cache_size_mb,
+                         EvictionPolicyType cache_policy)
+    : document_root_(document_root), default_file_(default_file), max_file_size_(0), cache_enabled_(enable_cache) {
     
     if (cache_enabled_) {
-        cache_ = std::make_unique<LRUCache>(cache_size_mb, 300);
+        cache_ = std::make_unique<LRUCache>(cache_size_mb, CACHE_TTL_SECONDS, cache_policy);
     }
     
     if (!document_root_.empty() && document_root_.back() != '/') {
@@ -24,7 +159,8 @@ FileHandler::FileHandler(const std::string& document_root, const std::string& de
     }
 }
 
-HttpResponse FileHandler::handle_file_request(const std::string& request_path) {
+HttpResponse FileHandler::handle_file_request(const HttpRequest& request) {
+    std::string_view request_path = request.get_path();
     std::string resolved_path = resolve_path(request_path);
     
     if (!is_safe_path(resolved_path)) {
@@ -54,40 +190,48 @@ HttpResponse FileHandler::handle_file_request(const std::string& request_path) {
             return HttpResponse::create_error_response(HttpStatus::FORBIDDEN, "Not a regular file");
         }
         
-        // check file size
-        uintmax_t file_size = std::filesystem::file_size(resolved_path);
-        if (file_size > max_file_size_) {
+        //only when a limit is configured, files too large to cache are streamed, not read
+        if (max_file_size_ != 0 && std::filesystem::file_size(resolved_path) > max_file_size_) {
             return HttpResponse::create_error_response(HttpStatus::FORBIDDEN, "File too large");
         }
         
-        //Try cache first
-        if (cache_enabled_ && cache_) {
-            auto cached_entry = cache_->get(resolved_path);
-            if (cached_entry) {
-                HttpResponse response(HttpStatus::OK);
-                response.set_body(cached_entry->data);
-                response.set_content_type(cached_entry->content_type);
-                response.set_header("X-Cache", "HIT");
-                return response;
-            }
-        }
+        bool gzip = gzip_enabled_ && accepts_gzip(request.get_header(HeaderId::ACCEPT_ENCODING));
+        std::string_view mime_type = HttpResponse::get_mime_type(extension_of(resolved_path));
+        bool vary = gzip_enabled_ && is_compressible(mime_type);
         
-        auto file_content = read_file(resolved_path);
-        if (!file_content) {
-            return HttpResponse::create_error_response(HttpStatus::INTERNAL_SERVER_ERROR, "Could not read file");
+        //ranges address the identity bytes; a gzip-encoded answer ignores Range, as RFC 9110 allows
+        std::string_view range = request.get_header(HeaderId::RANGE);
+        if (!range.empty() && request.get_method() == HttpMethod::GET && !(gzip && vary)) {
+            return serve_ranges(request, resolved_path, mime_type, vary);
         }
         
-        //cache the file if caching is enabled
-        std::string extension = std::filesystem::path(resolved_path).extension().string();
-        std::string mime_type = HttpResponse::get_mime_type(extension);
+        //Try cache first
+        auto cached_response = lookup_cache(request, resolved_path, gzip);
+        if (cached_response) {
+            return *cached_response;
+        }
         
-        if (cache_enabled_ && cache_ && file_content->size() < 1024 * 1024) { // Cache files < 1MB
-            cache_->put(resolved_path, *file_content, mime_type);
+        std::string file_path = resolved_path;
+        std::string cache_key = resolved_path;
+        Encoding encoding = Encoding::IDENTITY;
+        if (gzip && vary) {
+            cache_key = gzip_cache_key(resolved_path);
+            encoding = Encoding::GZIP;
+            
+            //a precompressed file next to this one is sent as is
+            std::string sidecar_path = resolved_path + ".gz";
+            std::error_code error;
+            if (std::filesystem::is_regular_file(sidecar_path, error) && (max_file_size_ == 0 || std::filesystem::file_size(sidecar_path, error) <= max_file_size_) && !error) {
+                file_path = std::move(sidecar_path);
+                encoding = Encoding::SIDECAR;
+            }
         }
         
-        HttpResponse response = HttpResponse::create_file_response(resolved_path, *file_content);
-        response.set_header("X-Cache", "MISS");
-        return response;
+        //a revalidation that misses the cache is still answered without reading the file
+        if (auto not_modified = check_preconditions(request, file_path, encoding, vary)) {
+            return *not_modified;
+        }
+        return serve_file(file_path, cache_key, mime_type, encoding, vary);
         
     } catch (const std::exception& e) {
         std::cerr << "File handler error: " << e.what() << std::endl;
@@ -95,18 +239,358 @@ HttpResponse FileHandler::handle_file_request(const std::string& request_path) {
     }
 }
 
-std::string FileHandler::resolve_path(const std::string& request_path) const {
-    std::string path = request_path;
+std::optional<HttpResponse> FileHandler::get_cached_response(const HttpRequest& request) {
+    //only paths that passed is_safe_path() in handle_file_request() are ever cached
+    //a miss here is retried by handle_file_request() on a worker, so count it only once
+    //range requests are sliced on the worker
+    if (request.has_header(HeaderId::RANGE)) {
+        return std::nullopt;
+    }
+    //like handle_file_request(), a file deleted or replaced by something else is not served from
+    //its entry; the worker answers it instead. The stat() is of a path just served, its inode is hot
+    std::string resolved_path = resolve_path(request.get_path());
+    struct stat file_stat;
+    if (stat(resolved_path.c_str(), &file_stat) == -1 || !S_ISREG(file_stat.st_mode)) {
+        return std::nullopt;
+    }
+    bool gzip = gzip_enabled_ && accepts_gzip(request.get_header(HeaderId::ACCEPT_ENCODING));
+    return lookup_cache(request, resolved_path, gzip, false);
+}
+
+std::optional<HttpResponse> FileHandler::lookup_cache(const HttpRequest& request, const std::string& resolved_path, bool gzip,
+                                                      bool record_miss) {
+    if (!cache_enabled_ || !cache_) {
+        return std::nullopt;
+    }
+    
+    //files that are never compressed are cached once, under their path
+    bool compressible = is_compressible(HttpResponse::get_mime_type(extension_of(resolved_path)));
+    bool variant = gzip && compressible;
+    auto cached_entry = cache_->get(variant ? gzip_cache_key(resolved_path) : resolved_path, record_miss);
+    if (!cached_entry) {
+        return std::nullopt;
+    }
+    
+    //the entry's validators answer a revalidation, its data is never looked at
+    if (is_not_modified(request, cached_entry->etag, cached_entry->last_modified)) {
+        return create_not_modified_response(cached_entry->etag, cached_entry->last_modified, gzip_enabled_ && compressible);
+    }
+    
+    if (!cached_entry->head.empty()) {
+        return HttpResponse::create_serialized_response(shared_head(cached_entry), shared_data(cached_entry));
+    }
+    
+    HttpResponse response(HttpStatus::OK);
+    response.set_shared_body(shared_data(cached_entry));
+    response.set_content_type(cached_entry->content_type);
+    response.set_header(HeaderId::X_CACHE, "HIT");
+    return response;
+}
+
+HttpResponse FileHandler::serve_file(const std::string& file_path, const std::string& cache_key, std::string_view mime_type,
+                                     Encoding encoding, bool vary) {
+    uintmax_t file_size = std::filesystem::file_size(file_path);
     
-    if (!path.empty() && path[0] == '/') {
-        path = path.substr(1);
+    //files that will not be cached are never read into memory, the connection
+    //sends them straight from the page cache with sendfile(); they are not compressed
+    if (!cache_enabled_ || !cache_ || file_size >= MAX_CACHED_FILE_SIZE) {
+        HttpResponse response = create_sendfile_response(file_path, mime_type);
+        if (response.get_status() == HttpStatus::OK) {
+            if (encoding == Encoding::SIDECAR) {
+                response.set_header(HeaderId::CONTENT_ENCODING, "gzip");
+            } else {
+                response.set_header(HeaderId::ACCEPT_RANGES, "bytes");
+            }
+            if (vary) {
+                response.set_header(HeaderId::VARY, "Accept-Encoding");
+            }
+        }
+        return response;
     }
     
-    if (path.empty()) {
-        path = default_file_;
+    struct stat file_stat;
+    auto file_content = read_file(file_path);
+    if (!file_content || stat(file_path.c_str(), &file_stat) == -1) {
+        return HttpResponse::create_error_response(HttpStatus::INTERNAL_SERVER_ERROR, "Could not read file");
     }
     
-    return document_root_ + path;
+    //compressed once here, every later hit is served from the cached variant. When gzip
+    //does not make the file smaller, the variant is the file as it is
+    bool gzipped = encoding == Encoding::SIDECAR;
+    if (encoding == Encoding::GZIP) {
+        std::vector<char> compressed;
+        if (gzip_compress(file_content->data(), file_content->size(), compressed) && compressed.size() < file_content->size()) {
+            *file_content = std::move(compressed);
+            gzipped = true;
+        }
+    }
+    
+    //the same tag check_preconditions() derives from the file, so misses and hits agree
+    std::string etag = representation_etag(file_stat, encoding);
+    
+    HttpResponse response(HttpStatus::OK);
+    response.set_content_length(file_content->size());
+    response.set_content_type(mime_type);
+    response.set_header(HeaderId::ETAG, etag);
+    response.set_header(HeaderId::LAST_MODIFIED, format_http_date(file_stat.st_mtime));
+    if (gzipped) {
+        response.set_header(HeaderId::CONTENT_ENCODING, "gzip");
+    } else if (encoding == Encoding::IDENTITY) {
+        response.set_header(HeaderId::ACCEPT_RANGES, "bytes");
+    }
+    if (vary) {
+        response.set_header(HeaderId::VARY, "Accept-Encoding");
+    }
+    
+    //hits are answered with these headers as they are, only Date and Connection are added
+    response.set_header(HeaderId::X_CACHE, "HIT");
+    //the file moves into the entry and this response sends it from there, so it is never copied;
+    //an empty file is not cached and needs no body
+    auto entry = cache_->put(cache_key, std::move(*file_content), std::string(mime_type), response.serialize_fixed_headers(),
+                             std::move(etag), file_stat.st_mtime);
+    if (entry) {
+        response.set_shared_body(shared_data(entry));
+    }
+    
+    response.set_header(HeaderId::X_CACHE, "MISS");
+    return response;
+}
+
+HttpResponse FileHandler::create_sendfile_response(const std::string& resolved_path, std::string_view mime_type) const {
+    int fd = open(resolved_path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+        return HttpResponse::create_error_response(HttpStatus::INTERNAL_SERVER_ERROR, "Could not read file");
+    }
+    auto file = std::make_shared<OpenFile>(fd);
+    
+    //size the body from the descriptor being sent, the file may have changed since it was checked
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) == -1 || !S_ISREG(file_stat.st_mode)) {
+        return HttpResponse::create_error_response(HttpStatus::INTERNAL_SERVER_ERROR, "Could not read file");
+    }
+    
+    HttpResponse response(HttpStatus::OK);
+    response.set_file_body(std::move(file), 0, static_cast<size_t>(file_stat.st_size));
+    response.set_content_type(mime_type);
+    response.set_header(HeaderId::ETAG, file_etag(file_stat));
+    response.set_header(HeaderId::LAST_MODIFIED, format_http_date(file_stat.st_mtime));
+    response.set_header(HeaderId::X_CACHE, "MISS");
+    return response;
+}
+
+HttpResponse FileHandler::serve_ranges(const HttpRequest& request, const std::string& file_path, std::string_view mime_type,
+                                       bool vary) {
+    std::string_view range_header = request.get_header(HeaderId::RANGE);
+    std::string_view if_range = request.get_header(HeaderId::IF_RANGE);
+    std::vector<ByteRange> ranges;
+    
+    //files small enough to cache are sliced from the cached copy, read into it first on a miss
+    if (cache_enabled_ && cache_ && std::filesystem::file_size(file_path) < MAX_CACHED_FILE_SIZE) {
+        auto cached_entry = cache_->get(file_path);
+        if (!cached_entry) {
+            if (auto not_modified = check_preconditions(request, file_path, Encoding::IDENTITY, vary)) {
+                return *not_modified;
+            }
+            HttpResponse full = serve_file(file_path, file_path, mime_type, Encoding::IDENTITY, vary);
+            if (full.get_status() != HttpStatus::OK) {
+                return full;
+            }
+            cached_entry = cache_->get(file_path, false);
+        }
+        if (cached_entry) {
+            const std::string& etag = cached_entry->etag;
+            time_t last_modified = cached_entry->last_modified;
+            if (is_not_modified(request, etag, last_modified)) {
+                return create_not_modified_response(etag, last_modified, vary);
+            }
+            
+            std::shared_ptr<const std::vector<char>> data = shared_data(cached_entry);
+            uint64_t size = data->size();
+            RangeResult result = parse_range_header(range_header, size, ranges);
+            if (result == RangeResult::NONE || !if_range_matches(if_range, etag, last_modified)) {
+                return HttpResponse::create_serialized_response(shared_head(cached_entry), std::move(data));
+            }
+            if (result == RangeResult::UNSATISFIABLE) {
+                return create_unsatisfiable_response(size);
+            }
+            
+            HttpResponse response;
+            if (ranges.size() == 1) {
+                const ByteRange& range = ranges.front();
+                response.set_status(HttpStatus::PARTIAL_CONTENT);
+                response.append_body_segment(BodySegment{data, data->data() + range.first, static_cast<size_t>(range.length())});
+                response.set_content_type(mime_type);
+                response.set_header(HeaderId::CONTENT_RANGE, content_range(range, size));
+            } else {
+                std::vector<const char*> parts;
+                for (const ByteRange& range : ranges) {
+                    parts.push_back(data->data() + range.first);
+                }
+                response = create_multipart_response(ranges, size, mime_type, data, parts);
+            }
+            response.set_header(HeaderId::ETAG, etag);
+            response.set_header(HeaderId::LAST_MODIFIED, format_http_date(last_modified));
+            response.set_header(HeaderId::ACCEPT_RANGES, "bytes");
+            if (vary) {
+                response.set_header(HeaderId::VARY, "Accept-Encoding");
+            }
+            response.set_header(HeaderId::X_CACHE, "HIT");
+            return response;
+        }
+    }
+    
+    //everything else is sent from the descriptor, a single range with sendfile() from its offset
+    HttpResponse full = create_sendfile_response(file_path, mime_type);
+    if (full.get_status() != HttpStatus::OK) {
+        return full;
+    }
+    full.set_header(HeaderId::ACCEPT_RANGES, "bytes");
+    if (vary) {
+        full.set_header(HeaderId::VARY, "Accept-Encoding");
+    }
+    
+    std::string etag(full.get_header(HeaderId::ETAG));
+    time_t last_modified = parse_http_date(full.get_header(HeaderId::LAST_MODIFIED)).value_or(0);
+    if (is_not_modified(request, etag, last_modified)) {
+        return create_not_modified_response(etag, last_modified, vary);
+    }
+    
+    std::shared_ptr<OpenFile> file = full.get_file_body()->file;
+    uint64_t size = full.get_file_body()->length;
+    RangeResult result = parse_range_header(range_header, size, ranges);
+    if (result == RangeResult::NONE || !if_range_matches(if_range, etag, last_modified)) {
+        return full;
+    }
+    if (result == RangeResult::UNSATISFIABLE) {
+        return create_unsatisfiable_response(size);
+    }
+    
+    if (ranges.size() == 1) {
+        const ByteRange& range = ranges.front();
+        full.set_status(HttpStatus::PARTIAL_CONTENT);
+        full.set_file_body(std::move(file), static_cast<off_t>(range.first), static_cast<size_t>(range.length()));
+        full.set_header(HeaderId::CONTENT_RANGE, content_range(range, size));
+        return full;
+    }
+    
+    //a connection sends one file body at most, so the parts of a multi-range response are read
+    //into one buffer; past what a cached file may hold the whole file goes instead, which RFC 9110 allows
+    uint64_t total = 0;
+    for (const ByteRange& range : ranges) {
+        total += range.length();
+    }
+    if (total > MAX_CACHED_FILE_SIZE) {
+        return full;
+    }
+    
+    auto buffer = std::make_shared<std::vector<char>>(static_cast<size_t>(total));
+    std::vector<const char*> parts;
+    char* at = buffer->data();
+    for (const ByteRange& range : ranges) {
+        size_t length = static_cast<size_t>(range.length());
+        size_t done = 0;
+        while (done < length) {
+            ssize_t n = pread(file->fd(), at + done, length - done, static_cast<off_t>(range.first + done));
+            if (n == -1 && errno == EINTR) {
+                continue;
+            }
+            if (n <= 0) {
+                return HttpResponse::create_error_response(HttpStatus::INTERNAL_SERVER_ERROR, "Could not read file");
+            }
+            done += static_cast<size_t>(n);
+        }
+        parts.push_back(at);
+        at += length;
+    }
+    
+    HttpResponse response = create_multipart_response(ranges, size, mime_type, std::move(buffer), parts);
+    response.set_header(HeaderId::ETAG, etag);
+    response.set_header(HeaderId::LAST_MODIFIED, format_http_date(last_modified));
+    response.set_header(HeaderId::ACCEPT_RANGES, "bytes");
+    if (vary) {
+        response.set_header(HeaderId::VARY, "Accept-Encoding");
+    }
+    response.set_header(HeaderId::X_CACHE, "MISS");
+    return response;
+}
+
+bool FileHandler::if_range_matches(std::string_view if_range, std::string_view etag, time_t last_modified) {
+    if (if_range.empty()) {
+        return true;
+    }
+    
+    //an entity tag must match strongly, a date exactly
+    if (if_range.front() == '"' || if_range.substr(0, 2) == "W/") {
+        return etag_list_matches(if_range, etag, false);
+    }
+    auto date = parse_http_date(if_range);
+    return date && *date == last_modified;
+}
+
+bool FileHandler::is_not_modified(const HttpRequest& request, std::string_view etag, time_t last_modified) {
+    //If-Modified-Since only counts without If-None-Match, which is the more precise of the two
+    std::string_view if_none_match = request.get_header(HeaderId::IF_NONE_MATCH);
+    if (!if_none_match.empty()) {
+        return etag_list_matches(if_none_match, etag, true);
+    }
+    
+    std::string_view if_modified_since = request.get_header(HeaderId::IF_MODIFIED_SINCE);
+    if (if_modified_since.empty() || last_modified == 0) {
+        return false;
+    }
+    auto date = parse_http_date(if_modified_since);
+    return date && last_modified <= *date;
+}
+
+HttpResponse FileHandler::create_not_modified_response(std::string_view etag, time_t last_modified, bool vary) {
+    HttpResponse response(HttpStatus::NOT_MODIFIED);
+    if (!etag.empty()) {
+        response.set_header(HeaderId::ETAG, etag);
+    }
+    if (last_modified != 0) {
+        response.set_header(HeaderId::LAST_MODIFIED, format_http_date(last_modified));
+    }
+    if (vary) {
+        response.set_header(HeaderId::VARY, "Accept-Encoding");
+    }
+    return response;
+}
+
+std::optional<HttpResponse> FileHandler::check_preconditions(const HttpRequest& request, const std::string& file_path,
+                                                             Encoding encoding, bool vary) const {
+    if (!request.has_header(HeaderId::IF_NONE_MATCH) && !request.has_header(HeaderId::IF_MODIFIED_SINCE)) {
+        return std::nullopt;
+    }
+    struct stat file_stat;
+    if (stat(file_path.c_str(), &file_stat) == -1 || !S_ISREG(file_stat.st_mode)) {
+        return std::nullopt;
+    }
+    std::string etag = representation_etag(file_stat, encoding);
+    if (!is_not_modified(request, etag, file_stat.st_mtime)) {
+        return std::nullopt;
+    }
+    return create_not_modified_response(etag, file_stat.st_mtime, vary);
+}
+
+std::string FileHandler::representation_etag(const struct stat& file_stat, Encoding encoding) const {
+    //a file gzip cannot shrink keeps the compressed variant's tag, it is still that variant's entry
+    bool compressed = encoding == Encoding::GZIP && cache_enabled_ && cache_ &&
+                      static_cast<uintmax_t>(file_stat.st_size) < MAX_CACHED_FILE_SIZE;
+    return file_etag(file_stat, compressed);
+}
+
+std::string FileHandler::resolve_path(std::string_view request_path) const {
+    if (!request_path.empty() && request_path[0] == '/') {
+        request_path.remove_prefix(1);
+    }
+    
+    if (request_path.empty()) {
+        request_path = default_file_;
+    }
+    
+    std::string path = document_root_;
+    path += request_path;
+    return path;
 }
 
 bool FileHandler::is_safe_path(const std::string& resolved_path) const {
@@ -167,27 +651,27 @@ std::optional<std::vector<char>> FileHandler::read_file(const std::string& path)
     return std::nullopt;
 }
 
-HttpResponse FileHandler::create_directory_listing(const std::string& dir_path, const std::string& request_path) {
+HttpResponse FileHandler::create_directory_listing(const std::string& dir_path, std::string_view request_path) {
     try {
-        std::ostringstream body;
-        body << "<!DOCTYPE html>\n";
-        body << "<html><head><title>Directory listing for " << request_path << "</title>";
-        body << "<style>\n";
-        body << "body { font-family: Arial, sans-serif; margin: 40px; }\n";
-        body << "table { border-collapse: collapse; width: 100%; }\n";
-        body << "th, td { border: 1px solid #ddd; padding: 8px; text-align: left; }\n";
-        body << "th { background-color: #f2f2f2; }\n";
-        body << "a { text-decoration: none; color: #0066cc; }\n";
-        body << "a:hover { text-decoration: underline; }\n";
-        body << "</style></head>\n";
-        body << "<body>\n";
-        body << "<h1>Directory listing for " << request_path << "</h1>\n";
-        body << "<table>\n";
-        body << "<tr><th>Name</th><th>Size</th><th>Last Modified</th></tr>\n";
+        std::ostringstream head;
+        head << "<!DOCTYPE html>\n";
+        head << "<html><head><title>Directory listing for " << request_path << "</title>";
+        head << "<style>\n";
+        head << "body { font-family: Arial, sans-serif; margin: 40px; }\n";
+        head << "table { border-collapse: collapse; width: 100%; }\n";
+        head << "th, td { border: 1px solid #ddd; padding: 8px; text-align: left; }\n";
+        head << "th { background-color: #f2f2f2; }\n";
+        head << "a { text-decoration: none; color: #0066cc; }\n";
+        head << "a:hover { text-decoration: underline; }\n";
+        head << "</style></head>\n";
+        head << "<body>\n";
+        head << "<h1>Directory listing for " << request_path << "</h1>\n";
+        head << "<table>\n";
+        head << "<tr><th>Name</th><th>Size</th><th>Last Modified</th></tr>\n";
         
         // Add parent directory link if not at root
         if (request_path != "/" && !request_path.empty()) {
-            std::string parent_path = request_path;
+            std::string parent_path(request_path);
             if (parent_path.back() == '/') {
                 parent_path.pop_back();
             }
@@ -197,7 +681,7 @@ HttpResponse FileHandler::create_directory_listing(const std::string& dir_path,
             } else {
                 parent_path = "/";
             }
-            body << "<tr><td><a href=\"" << parent_path << "\">..</a></td><td>-</td><td>-</td></tr>\n";
+            head << "<tr><td><a href=\"" << parent_path << "\">..</a></td><td>-</td><td>-</td></tr>\n";
         }
         
         std::vector<std::filesystem::directory_entry> entries;
@@ -212,52 +696,42 @@ HttpResponse FileHandler::create_directory_listing(const std::string& dir_path,
             return a.path().filename() < b.path().filename();
         });
         
+        //everything that touches the disk happens here, the rows are formatted while sending
+        std::vector<DirectoryListing::Row> rows;
+        rows.reserve(entries.size());
         for (const auto& entry : entries) {
-            std::string filename = entry.path().filename().string();
-            std::string link_path = request_path;
-            if (link_path.back() != '/') {
-                link_path += '/';
+            DirectoryListing::Row row;
+            row.name = entry.path().filename().string();
+            row.link = std::string(request_path);
+            if (row.link.empty() || row.link.back() != '/') {
+                row.link += '/';
             }
-            link_path += filename;
+            row.link += row.name;
             
             if (entry.is_directory()) {
-                filename += '/';
-                link_path += '/';
-            }
-            
-            body << "<tr>";
-            body << "<td><a href=\"" << link_path << "\">" << filename << "</a></td>";
-            
-            if (entry.is_directory()) {
-                body << "<td>-</td>";
+                row.name += '/';
+                row.link += '/';
+                row.size = "-";
             } else {
                 try {
-                    uintmax_t size = std::filesystem::file_size(entry.path());
-                    body << "<td>" << get_file_size_string(size) << "</td>";
+                    row.size = get_file_size_string(std::filesystem::file_size(entry.path()));
                 } catch (const std::exception&) {
-                    body << "<td>-</td>";
+                    row.size = "-";
                 }
             }
             
             try {
-                auto time = std::filesystem::last_write_time(entry.path());
-                body << "<td>" << get_last_modified_string(time) << "</td>";
+                row.modified = get_last_modified_string(std::filesystem::last_write_time(entry.path()));
             } catch (const std::exception&) {
-                body << "<td>-</td>";
+                row.modified = "-";
             }
-            
-            body << "</tr>\n";
+            rows.push_back(std::move(row));
         }
         
-        body << "</table>\n";
-        body << "<hr>\n";
-        body << "<p><em>MultithreadedWebServer/1.0</em></p>\n";
-        body << "</body></html>\n";
-        
         HttpResponse response(HttpStatus::OK);
-        response.set_body(body.str());
+        response.set_generated_body(DirectoryListing(head.str(), std::move(rows)));
         response.set_content_type("text/html; charset=utf-8");
-        response.set_header("X-Cache", "NONE");
+        response.set_header(HeaderId::X_CACHE, "NONE");
         
         return response;
         
@@ -0,0 +1,134 @@
+#include "http_date.h"
+#include <algorithm>
+
+namespace {
+
+constexpr char DAYS[] = "SunMonTueWedThuFriSat";
+constexpr char MONTHS[] = "JanFebMarAprMayJunJulAugSepOctNovDec";
+
+// Reads count digits at value[at], -1 if any is missing
+int read_number(std::string_view value, size_t at, size_t count) {
+    if (at + count > value.size()) {
+        return -1;
+    }
+    int number = 0;
+    for (size_t i = at; i < at + count; ++i) {
+        if (value[i] < '0' || value[i] > '9') {
+            return -1;
+        }
+        number = number * 10 + (value[i] - '0');
+    }
+    return number;
+}
+
+int read_month(std::string_view value, size_t at) {
+    if (at + 3 > value.size()) {
+        return -1;
+    }
+    std::string_view months(MONTHS);
+    for (int month = 0; month < 12; ++month) {
+        if (value.substr(at, 3) == months.substr(month * 3, 3)) {
+            return month;
+        }
+    }
+    return -1;
+}
+
+// "08:49:37" at value[at]
+bool read_time(std::string_view value, size_t at, struct tm& tm) {
+    if (at + 8 > value.size() || value[at + 2] != ':' || value[at + 5] != ':') {
+        return false;
+    }
+    tm.tm_hour = read_number(value, at, 2);
+    tm.tm_min = read_number(value, at + 3, 2);
+    tm.tm_sec = read_number(value, at + 6, 2);
+    return tm.tm_hour >= 0 && tm.tm_hour < 24 && tm.tm_min >= 0 && tm.tm_min < 60 && tm.tm_sec >= 0 && tm.tm_sec <= 60;
+}
+
+} // namespace
+
+void format_http_date(time_t time, char* out) {
+    struct tm tm;
+    gmtime_r(&time, &tm);
+    
+    auto two_digits = [](char* at, int value) {
+        at[0] = static_cast<char>('0' + value / 10);
+        at[1] = static_cast<char>('0' + value % 10);
+    };
+    
+    std::copy_n(DAYS + tm.tm_wday * 3, 3, out);
+    out[3] = ',';
+    out[4] = ' ';
+    two_digits(out + 5, tm.tm_mday);
+    out[7] = ' ';
+    std::copy_n(MONTHS + tm.tm_mon * 3, 3, out + 8);
+    out[11] = ' ';
+    int year = tm.tm_year + 1900;
+    two_digits(out + 12, year / 100 % 100);
+    two_digits(out + 14, year % 100);
+    out[16] = ' ';
+    two_digits(out + 17, tm.tm_hour);
+    out[19] = ':';
+    two_digits(out + 20, tm.tm_min);
+    out[22] = ':';
+    two_digits(out + 23, tm.tm_sec);
+    std::copy_n(" GMT", 4, out + 25);
+}
+
+std::string format_http_date(time_t time) {
+    std::string date(HTTP_DATE_LENGTH, ' ');
+    format_http_date(time, &date[0]);
+    return date;
+}
+
+std::optional<time_t> parse_http_date(std::string_view value) {
+    struct tm tm{};
+    size_t comma = value.find(',');
+    
+    if (comma == 3) {
+        //IMF-fixdate: "Sun, 06 Nov 1994 08:49:37 GMT"
+        if (value.size() != HTTP_DATE_LENGTH || value[4] != ' ' || value[7] != ' ' || value[11] != ' ' ||
+            value[16] != ' ' || value.substr(25) != " GMT" || !read_time(value, 17, tm)) {
+            return std::nullopt;
+        }
+        tm.tm_mday = read_number(value, 5, 2);
+        tm.tm_mon = read_month(value, 8);
+        tm.tm_year = read_number(value, 12, 4) - 1900;
+    } else if (comma != std::string_view::npos) {
+        //RFC 850: "Sunday, 06-Nov-94 08:49:37 GMT", two-digit years are taken as 19xx or 20xx
+        //whichever is nearer, as RFC 9110 asks for years that would be more than 50 years ahead
+        std::string_view rest = value.substr(comma + 1);
+        if (rest.size() != 23 || rest[0] != ' ' || rest[3] != '-' || rest[7] != '-' || rest[10] != ' ' ||
+            rest.substr(19) != " GMT" || !read_time(rest, 11, tm)) {
+            return std::nullopt;
+        }
+        tm.tm_mday = read_number(rest, 1, 2);
+        tm.tm_mon = read_month(rest, 4);
+        int year = read_number(rest, 8, 2);
+        if (year < 0) {
+            return std::nullopt;
+        }
+        time_t now = time(nullptr);
+        struct tm now_tm;
+        gmtime_r(&now, &now_tm);
+        int century = (now_tm.tm_year + 1900) / 100 * 100;
+        tm.tm_year = century + year - 1900;
+        if (tm.tm_year > now_tm.tm_year + 50) {
+            tm.tm_year -= 100;
+        }
+    } else {
+        //asctime: "Sun Nov  6 08:49:37 1994"
+        if (value.size() != 24 || value[3] != ' ' || value[7] != ' ' || value[10] != ' ' || value[19] != ' ' ||
+            !read_time(value, 11, tm)) {
+            return std::nullopt;
+        }
+        tm.tm_mon = read_month(value, 4);
+        tm.tm_mday = value[8] == ' ' ? read_number(value, 9, 1) : read_number(value, 8, 2);
+        tm.tm_year = read_number(value, 20, 4) - 1900;
+    }
+    
+    if (tm.tm_mon < 0 || tm.tm_mday < 1 || tm.tm_mday > 31 || tm.tm_year < 0) {
+        return std::nullopt;
+    }
+    return timegm(&tm);
+}
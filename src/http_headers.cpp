@@ -0,0 +1,225 @@
+#include "http_headers.h"
+
+namespace {
+
+constexpr std::array<std::string_view, KNOWN_HEADER_COUNT> HEADER_NAMES{
+    "Accept",
+    "Accept-Charset",
+    "Accept-Encoding",
+    "Accept-Language",
+    "Accept-Ranges",
+    "Age",
+    "Allow",
+    "Authorization",
+    "Cache-Control",
+    "Connection",
+    "Content-Disposition",
+    "Content-Encoding",
+    "Content-Language",
+    "Content-Length",
+    "Content-Location",
+    "Content-Range",
+    "Content-Type",
+    "Cookie",
+    "Date",
+    "ETag",
+    "Expect",
+    "Expires",
+    "Forwarded",
+    "Host",
+    "If-Match",
+    "If-Modified-Since",
+    "If-None-Match",
+    "If-Range",
+    "If-Unmodified-Since",
+    "Keep-Alive",
+    "Last-Modified",
+    "Location",
+    "Origin",
+    "Pragma",
+    "Range",
+    "Referer",
+    "Server",
+    "Set-Cookie",
+    "TE",
+    "Trailer",
+    "Transfer-Encoding",
+    "Upgrade",
+    "User-Agent",
+    "Vary",
+    "Via",
+    "X-Cache",
+    "X-Forwarded-For",
+    "X-Requested-With"
+};
+
+constexpr size_t TABLE_SIZE = 256;
+constexpr uint8_t EMPTY_SLOT = 0xFF;
+
+constexpr size_t max_name_length() {
+    size_t longest = 0;
+    for (std::string_view name : HEADER_NAMES) {
+        longest = name.size() > longest ? name.size() : longest;
+    }
+    return longest;
+}
+
+constexpr size_t MAX_NAME_LENGTH = max_name_length();
+
+// Length, first and last byte tell all known names apart, so only those are hashed.
+// Bit 5 is set on both bytes, which folds ASCII letters to lowercase; the comparison
+// after the lookup settles anything else that lands on a slot
+constexpr uint32_t hash_name(std::string_view name, uint32_t seed) {
+    uint32_t key = static_cast<uint32_t>(name.size()) << 16 |
+                   static_cast<uint32_t>(static_cast<uint8_t>(name.front()) | 0x20) << 8 |
+                   static_cast<uint32_t>(static_cast<uint8_t>(name.back()) | 0x20);
+    return ((key * seed) >> 24) & (TABLE_SIZE - 1);
+}
+
+struct PerfectHashTable {
+    uint32_t seed;
+    std::array<uint8_t, TABLE_SIZE> slots;
+};
+
+// Tries seeds until every known name lands in a slot of its own
+constexpr PerfectHashTable build_table() {
+    for (uint32_t seed = 0x9E3779B1u; seed < 0x9E3779B1u + 2 * 100000; seed += 2) {
+        PerfectHashTable table{seed, {}};
+        for (size_t slot = 0; slot < TABLE_SIZE; ++slot) {
+            table.slots[slot] = EMPTY_SLOT;
+        }
+
+        bool collision = false;
+        for (size_t id = 0; id < KNOWN_HEADER_COUNT && !collision; ++id) {
+            uint8_t& slot = table.slots[hash_name(HEADER_NAMES[id], seed)];
+            collision = slot != EMPTY_SLOT;
+            slot = static_cast<uint8_t>(id);
+        }
+        if (!collision) {
+            return table;
+        }
+    }
+    return PerfectHashTable{0, {}};
+}
+
+constexpr PerfectHashTable HEADER_TABLE = build_table();
+static_assert(HEADER_TABLE.seed != 0, "no collision-free seed for the known header names");
+
+} // namespace
+
+HeaderId lookup_header(std::string_view name) {
+    if (name.empty() || name.size() > MAX_NAME_LENGTH) {
+        return HeaderId::UNKNOWN;
+    }
+    uint8_t id = HEADER_TABLE.slots[hash_name(name, HEADER_TABLE.seed)];
+    if (id == EMPTY_SLOT || !iequals(name, HEADER_NAMES[id])) {
+        return HeaderId::UNKNOWN;
+    }
+    return static_cast<HeaderId>(id);
+}
+
+std::string_view header_name(HeaderId id) {
+    return id == HeaderId::UNKNOWN ? std::string_view() : HEADER_NAMES[static_cast<size_t>(id)];
+}
+
+bool iequals(std::string_view a, std::string_view b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); ++i) {
+        char x = a[i];
+        char y = b[i];
+        if (x >= 'A' && x <= 'Z') x = static_cast<char>(x - 'A' + 'a');
+        if (y >= 'A' && y <= 'Z') y = static_cast<char>(y - 'A' + 'a');
+        if (x != y) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::string_view trim_ows(std::string_view value) {
+    size_t start = value.find_first_not_of(" \t");
+    if (start == std::string_view::npos) {
+        return {};
+    }
+    size_t end = value.find_last_not_of(" \t");
+    return value.substr(start, end - start + 1);
+}
+
+std::string_view HeaderMap::get(HeaderId id) const {
+    if (!has(id)) {
+        return {};
+    }
+    return fields_[slots_[static_cast<size_t>(id)] - 1].value;
+}
+
+std::string_view HeaderMap::get(std::string_view name) const {
+    HeaderId id = lookup_header(name);
+    if (id != HeaderId::UNKNOWN) {
+        return get(id);
+    }
+    const Field* field = find_unknown(name);
+    return field ? std::string_view(field->value) : std::string_view();
+}
+
+bool HeaderMap::has(std::string_view name) const {
+    HeaderId id = lookup_header(name);
+    return id != HeaderId::UNKNOWN ? has(id) : find_unknown(name) != nullptr;
+}
+
+void HeaderMap::set(HeaderId id, std::string_view value) {
+    if (id == HeaderId::UNKNOWN) {
+        return;
+    }
+    uint16_t& slot = slots_[static_cast<size_t>(id)];
+    if (slot != 0) {
+        fields_[slot - 1].value = value;
+        return;
+    }
+    fields_.emplace_back(id, std::string_view(), value);
+    slot = static_cast<uint16_t>(fields_.size());
+}
+
+void HeaderMap::set(std::string_view name, std::string_view value) {
+    HeaderId id = lookup_header(name);
+    if (id != HeaderId::UNKNOWN) {
+        set(id, value);
+        return;
+    }
+    if (Field* field = const_cast<Field*>(find_unknown(name))) {
+        field->value = value;
+        return;
+    }
+    fields_.emplace_back(HeaderId::UNKNOWN, name, value);
+}
+
+void HeaderMap::remove(HeaderId id) {
+    if (!has(id)) {
+        return;
+    }
+    uint16_t position = slots_[static_cast<size_t>(id)];
+    fields_.erase(fields_.begin() + (position - 1));
+    slots_[static_cast<size_t>(id)] = 0;
+
+    //fields behind the removed one moved up by one
+    for (uint16_t& slot : slots_) {
+        if (slot > position) {
+            slot--;
+        }
+    }
+}
+
+void HeaderMap::clear() {
+    slots_.fill(0);
+    fields_.clear();
+}
+
+const HeaderMap::Field* HeaderMap::find_unknown(std::string_view name) const {
+    for (const auto& field : fields_) {
+        if (field.id == HeaderId::UNKNOWN && iequals(field.name, name)) {
+            return &field;
+        }
+    }
+    return nullptr;
+}
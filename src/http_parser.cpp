@@ -0,0 +1,434 @@
+#include "http_parser.h"
+#include "simd_scan.h"
+#include <algorithm>
+#include <cstdint>
+
+namespace {
+
+std::string_view strip_cr(std::string_view line) {
+    if (!line.empty() && line.back() == '\r') {
+        line.remove_suffix(1);
+    }
+    return line;
+}
+
+bool parse_content_length(std::string_view value, size_t& length) {
+    if (value.empty()) {
+        return false;
+    }
+
+    size_t result = 0;
+    for (char c : value) {
+        if (c < '0' || c > '9' || result > (SIZE_MAX - 9) / 10) {
+            return false;
+        }
+        result = result * 10 + static_cast<size_t>(c - '0');
+    }
+    length = result;
+    return true;
+}
+
+// "METHOD target VERSION"; fields stay empty when the line does not have all three
+void parse_request_line(std::string_view line, RequestView& request) {
+    std::string_view fields[3];
+    size_t count = 0;
+    size_t pos = 0;
+
+    while (count < 3) {
+        pos = line.find_first_not_of(' ', pos);
+        if (pos == std::string_view::npos) {
+            return;
+        }
+        size_t end = line.find(' ', pos);
+        fields[count++] = line.substr(pos, end == std::string_view::npos ? std::string_view::npos : end - pos);
+        if (end == std::string_view::npos) {
+            break;
+        }
+        pos = end;
+    }
+    if (count < 3) {
+        return;
+    }
+
+    request.method_name = fields[0];
+    request.method = HttpRequest::string_to_method(fields[0]);
+    request.version = fields[2];
+
+    std::string_view target = fields[1];
+    size_t query_pos = target.find('?');
+    if (query_pos != std::string_view::npos) {
+        request.path = target.substr(0, query_pos);
+        request.query = target.substr(query_pos + 1);
+    } else {
+        request.path = target;
+    }
+}
+
+void clear_request(RequestView& request) {
+    //field by field, the header array is only valid up to header_count anyway
+    request.method = HttpMethod::UNKNOWN;
+    request.method_name = request.path = request.query = request.version = request.body = {};
+    request.header_count = 0;
+    request.content_length = 0;
+}
+
+// Request line and headers of a head that ends with its blank line; false when the
+// request cannot be framed
+bool parse_head(std::string_view head, RequestView& request) {
+    clear_request(request);
+    const char* data = head.data();
+
+    size_t line_end = scan_for_either(data, head.size(), '\n', '\n');
+    parse_request_line(strip_cr(head.substr(0, line_end)), request);
+    size_t pos = line_end + 1;
+
+    while (true) {
+        //one pass per line finds the colon and the line end
+        size_t stop = pos + scan_for_either(data + pos, head.size() - pos, ':', '\n');
+        if (data[stop] == '\n') {
+            bool blank = strip_cr(head.substr(pos, stop - pos)).empty();
+            pos = stop + 1;
+            if (blank) {
+                return true;
+            }
+            continue; // no colon, not a header
+        }
+
+        line_end = stop + scan_for_either(data + stop, head.size() - stop, '\n', '\n');
+        if (request.header_count == RequestView::MAX_HEADERS) {
+            return false;
+        }
+
+        HeaderView& header = request.headers[request.header_count++];
+        header.name = trim_ows(head.substr(pos, stop - pos));
+        header.value = trim_ows(strip_cr(head.substr(stop + 1, line_end - stop - 1)));
+        header.id = lookup_header(header.name);
+        pos = line_end + 1;
+
+        if (header.id == HeaderId::CONTENT_LENGTH && !parse_content_length(header.value, request.content_length)) {
+            return false;
+        }
+    }
+}
+
+// Hex chunk size, optionally followed by chunk extensions, which are ignored
+bool parse_chunk_size(std::string_view line, size_t& size) {
+    size_t result = 0;
+    size_t digits = 0;
+    for (; digits < line.size(); ++digits) {
+        char c = line[digits];
+        int value = -1;
+        if (c >= '0' && c <= '9') value = c - '0';
+        else if (c >= 'a' && c <= 'f') value = c - 'a' + 10;
+        else if (c >= 'A' && c <= 'F') value = c - 'A' + 10;
+        if (value < 0) {
+            break;
+        }
+        if (result > (SIZE_MAX >> 4)) {
+            return false;
+        }
+        result = (result << 4) | static_cast<size_t>(value);
+    }
+    if (digits == 0) {
+        return false;
+    }
+
+    std::string_view rest = trim_ows(line.substr(digits));
+    if (!rest.empty() && rest.front() != ';') {
+        return false;
+    }
+    size = result;
+    return true;
+}
+
+} // namespace
+
+ParseStatus RequestView::parse(std::string_view buffer, RequestView& request, size_t& consumed) {
+    //nothing is parsed until the blank line ending the headers is in, so every line
+    //below is known to be complete
+    size_t head_end = find_header_end(buffer.data(), buffer.size());
+    if (head_end == 0) {
+        clear_request(request);
+        return ParseStatus::INCOMPLETE;
+    }
+    if (!parse_head(buffer.substr(0, head_end), request)) {
+        return ParseStatus::INVALID;
+    }
+
+    if (buffer.size() - head_end < request.content_length) {
+        return ParseStatus::INCOMPLETE;
+    }
+
+    request.body = buffer.substr(head_end, request.content_length);
+    consumed = head_end + request.content_length;
+    return ParseStatus::COMPLETE;
+}
+
+std::string_view RequestView::header(HeaderId id) const {
+    for (size_t i = 0; i < header_count; ++i) {
+        if (headers[i].id == id) {
+            return headers[i].value;
+        }
+    }
+    return {};
+}
+
+std::string_view RequestView::header(std::string_view name) const {
+    HeaderId id = lookup_header(name);
+    if (id != HeaderId::UNKNOWN) {
+        return header(id);
+    }
+    for (size_t i = 0; i < header_count; ++i) {
+        if (headers[i].id == HeaderId::UNKNOWN && iequals(headers[i].name, name)) {
+            return headers[i].value;
+        }
+    }
+    return {};
+}
+
+bool RequestView::has_header(std::string_view name) const {
+    HeaderId id = lookup_header(name);
+    for (size_t i = 0; i < header_count; ++i) {
+        if (id != HeaderId::UNKNOWN ? headers[i].id == id : iequals(headers[i].name, name)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void RequestParser::reset() {
+    state_ = State::HEAD;
+    scan_pos_ = 0;
+    body_start_ = 0;
+    body_remaining_ = 0;
+    chunk_remaining_ = 0;
+    body_size_ = 0;
+    consumer_ = nullptr;
+    consumed_ = 0;
+    base_ = nullptr;
+    chunked_ = false;
+
+    //keep the capacity of a small decoded body, give back what a large one grew
+    if (chunked_body_.capacity() > RETAINED_CAPACITY) std::string().swap(chunked_body_); else chunked_body_.clear();
+}
+
+ParseStatus RequestParser::parse(std::string_view buffer) {
+    if (state_ == State::HEAD) {
+        //a terminator may straddle the end of the previous search, so back up three bytes
+        size_t from = scan_pos_ > 3 ? scan_pos_ - 3 : 0;
+        size_t head_end = find_header_end(buffer.data() + from, buffer.size() - from);
+        if (head_end == 0) {
+            scan_pos_ = buffer.size();
+            return ParseStatus::INCOMPLETE;
+        }
+
+        body_start_ = from + head_end;
+        if (!parse_head(buffer.substr(0, body_start_), request_) || !start_body()) {
+            state_ = State::INVALID;
+            return ParseStatus::INVALID;
+        }
+        save_spans(buffer);
+    }
+
+    if (state_ == State::BODY) {
+        ParseStatus status = parse_body(buffer);
+        if (status != ParseStatus::COMPLETE) {
+            return status;
+        }
+    } else if (state_ != State::COMPLETE && state_ != State::INVALID) {
+        ParseStatus status = parse_chunks(buffer);
+        if (status != ParseStatus::COMPLETE) {
+            return status;
+        }
+    }
+
+    if (state_ == State::INVALID) {
+        return ParseStatus::INVALID;
+    }
+
+    //the views follow the buffer when it was reallocated since they were set
+    if (base_ != buffer.data()) {
+        restore_views(buffer);
+    }
+    return ParseStatus::COMPLETE;
+}
+
+bool RequestParser::receiving_body() const {
+    return state_ != State::HEAD && state_ != State::COMPLETE && state_ != State::INVALID;
+}
+
+void RequestParser::stream_body(BodyConsumer* consumer) {
+    consumer_ = consumer;
+
+    //whatever was decoded into the parser so far goes first
+    if (!chunked_body_.empty()) {
+        if (!consumer_->consume(chunked_body_.data(), chunked_body_.size())) {
+            state_ = State::INVALID;
+        }
+        chunked_body_.clear();
+    }
+}
+
+void RequestParser::discard_streamed(std::string& buffer) {
+    if (consumer_ && scan_pos_ > body_start_ && state_ != State::INVALID) {
+        buffer.erase(body_start_, scan_pos_ - body_start_);
+        consumed_ -= state_ == State::COMPLETE ? scan_pos_ - body_start_ : 0;
+        scan_pos_ = body_start_;
+    }
+}
+
+bool RequestParser::start_body() {
+    scan_pos_ = body_start_;
+
+    std::string_view transfer_encoding = request_.header(HeaderId::TRANSFER_ENCODING);
+    if (transfer_encoding.empty()) {
+        body_remaining_ = request_.content_length;
+        state_ = State::BODY;
+        return true;
+    }
+
+    //chunked has to be the final coding, without it the body has no end
+    size_t comma = transfer_encoding.rfind(',');
+    std::string_view last = trim_ows(transfer_encoding.substr(comma == std::string_view::npos ? 0 : comma + 1));
+    if (!iequals(last, "chunked")) {
+        return false;
+    }
+
+    //Transfer-Encoding overrides Content-Length, which becomes the decoded size
+    chunked_ = true;
+    request_.content_length = 0;
+    state_ = State::CHUNK_SIZE;
+    return true;
+}
+
+ParseStatus RequestParser::parse_body(std::string_view buffer) {
+    size_t available = buffer.size() - scan_pos_;
+
+    if (consumer_) {
+        size_t size = std::min(available, body_remaining_);
+        if (size > 0 && !deliver(buffer.data() + scan_pos_, size)) {
+            return ParseStatus::INVALID;
+        }
+        scan_pos_ += size;
+        body_remaining_ -= size;
+    } else if (available >= body_remaining_) {
+        //left in the buffer, the view is set once the request is complete
+        scan_pos_ += body_remaining_;
+        body_remaining_ = 0;
+    }
+
+    return body_remaining_ == 0 ? complete() : ParseStatus::INCOMPLETE;
+}
+
+ParseStatus RequestParser::parse_chunks(std::string_view buffer) {
+    while (true) {
+        if (state_ == State::CHUNK_DATA) {
+            //decoded as it arrives, a chunk may be larger than anything buffered
+            size_t size = std::min(buffer.size() - scan_pos_, chunk_remaining_);
+            if (size > 0 && !deliver(buffer.data() + scan_pos_, size)) {
+                return ParseStatus::INVALID;
+            }
+            scan_pos_ += size;
+            chunk_remaining_ -= size;
+            if (chunk_remaining_ > 0) {
+                return ParseStatus::INCOMPLETE;
+            }
+            state_ = State::CHUNK_DATA_END;
+        }
+
+        if (state_ == State::CHUNK_DATA_END) {
+            if (buffer.size() - scan_pos_ < 2) {
+                return ParseStatus::INCOMPLETE;
+            }
+            if (buffer.compare(scan_pos_, 2, "\r\n") != 0) {
+                state_ = State::INVALID;
+                return ParseStatus::INVALID;
+            }
+            scan_pos_ += 2;
+            state_ = State::CHUNK_SIZE;
+        }
+
+        //size and trailer lines are read once their line feed is in
+        size_t line_end = scan_pos_ + scan_for_either(buffer.data() + scan_pos_, buffer.size() - scan_pos_, '\n', '\n');
+        if (line_end == buffer.size()) {
+            return ParseStatus::INCOMPLETE;
+        }
+        std::string_view line = strip_cr(buffer.substr(scan_pos_, line_end - scan_pos_));
+        scan_pos_ = line_end + 1;
+
+        if (state_ == State::TRAILERS) {
+            if (line.empty()) {
+                request_.content_length = body_size_;
+                return complete();
+            }
+            continue; // trailer fields are dropped
+        }
+
+        if (!parse_chunk_size(line, chunk_remaining_)) {
+            state_ = State::INVALID;
+            return ParseStatus::INVALID;
+        }
+        state_ = chunk_remaining_ == 0 ? State::TRAILERS : State::CHUNK_DATA;
+    }
+}
+
+bool RequestParser::deliver(const char* data, size_t size) {
+    body_size_ += size;
+    if (!consumer_) {
+        chunked_body_.append(data, size);
+        return true;
+    }
+    if (!consumer_->consume(data, size)) {
+        state_ = State::INVALID;
+        return false;
+    }
+    return true;
+}
+
+ParseStatus RequestParser::complete() {
+    if (consumer_ && !consumer_->finish()) {
+        state_ = State::INVALID;
+        return ParseStatus::INVALID;
+    }
+    consumed_ = scan_pos_;
+    state_ = State::COMPLETE;
+    base_ = nullptr;
+    return ParseStatus::COMPLETE;
+}
+
+void RequestParser::save_spans(std::string_view buffer) {
+    auto span = [&](std::string_view view) {
+        return view.empty() ? Span{} : Span{static_cast<size_t>(view.data() - buffer.data()), view.size()};
+    };
+
+    method_name_ = span(request_.method_name);
+    path_ = span(request_.path);
+    query_ = span(request_.query);
+    version_ = span(request_.version);
+    for (size_t i = 0; i < request_.header_count; ++i) {
+        header_spans_[2 * i] = span(request_.headers[i].name);
+        header_spans_[2 * i + 1] = span(request_.headers[i].value);
+    }
+    base_ = nullptr;
+}
+
+void RequestParser::restore_views(std::string_view buffer) {
+    auto view = [&](const Span& span) { return buffer.substr(span.offset, span.length); };
+
+    request_.method_name = view(method_name_);
+    request_.path = view(path_);
+    request_.query = view(query_);
+    request_.version = view(version_);
+    for (size_t i = 0; i < request_.header_count; ++i) {
+        request_.headers[i].name = view(header_spans_[2 * i]);
+        request_.headers[i].value = view(header_spans_[2 * i + 1]);
+    }
+    if (consumer_) {
+        request_.body = {};
+    } else if (chunked_) {
+        request_.body = chunked_body_;
+    } else {
+        request_.body = buffer.substr(body_start_, request_.content_length);
+    }
+    base_ = buffer.data();
+}
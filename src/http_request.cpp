@@ -1,165 +1,92 @@
 #include "http_request.h"
-#include <sstream>
-#include <algorithm>
-#include <cctype>
+#include "http_parser.h"
+#include "simd_scan.h"
+#include <charconv>
 
-HttpRequest HttpRequest::parse(const std::string& raw_request) {
-    HttpRequest request;
-    
-    if (raw_request.empty()) {
-        return request;
+HttpRequest::HttpRequest()
+    : path_(arena_.resource()), query_string_(arena_.resource()), version_(arena_.resource()),
+      body_(arena_.resource()), headers_(arena_.resource()), query_params_(arena_.resource()) {}
+
+HttpRequest HttpRequest::parse(std::string_view raw_request) {
+    RequestView view;
+    size_t consumed = 0;
+    if (RequestView::parse(raw_request, view, consumed) != ParseStatus::COMPLETE) {
+        return HttpRequest();
     }
-    
-    std::istringstream stream(raw_request);
-    std::string line;
-    bool first_line = true;
-    bool headers_done = false;
-    std::string body;
-    
-    while (std::getline(stream, line)) {
-        if (!line.empty() && line.back() == '\r') {
-            line.pop_back();
-        }
-        
-        if (first_line) {
-            request.parse_request_line(line);
-            first_line = false;
-        } else if (!headers_done) {
-            if (line.empty()) {
-                headers_done = true;
-                continue;
-            }
-            request.parse_header_line(line);
+    return from_view(view);
+}
+
+HttpRequest HttpRequest::from_view(const RequestView& view) {
+    HttpRequest request;
+    request.method_ = view.method;
+    request.version_ = view.version;
+    url_decode_into(view.path, request.path_);
+    request.query_string_ = view.query;
+    request.body_ = view.body;
+    
+    //the parser already resolved known header names, only the others keep theirs
+    for (size_t i = 0; i < view.header_count; ++i) {
+        const HeaderView& header = view.headers[i];
+        if (header.id != HeaderId::UNKNOWN) {
+            request.headers_.set(header.id, header.value);
         } else {
-            if (!body.empty()) {
-                body += "\n";
-            }
-            body += line;
+            request.headers_.set(header.name, header.value);
         }
     }
     
-    request.body_ = body;
     request.parse_query_string();
     request.valid_ = request.is_request_valid();
     
     return request;
 }
 
-void HttpRequest::parse_request_line(const std::string& line) {
-    std::istringstream stream(line);
-    std::string method_str, path_with_query, version;
-    
-    if (!(stream >> method_str >> path_with_query >> version)) {
-        return;
-    }
-    
-    method_ = string_to_method(method_str);
-    version_ = version;
-    
-    //Spllit path and query string
-    size_t query_pos = path_with_query.find('?');
-    if (query_pos != std::string::npos) {
-        path_ = path_with_query.substr(0, query_pos);
-        query_string_ = path_with_query.substr(query_pos + 1);
+void HttpRequest::set_streamed_body(SpooledBody& body) {
+    if (body.in_memory()) {
+        body_ = body.data();
     } else {
-        path_ = path_with_query;
+        body_.clear();
+        body_file_ = body.file();
+        body_file_size_ = body.size();
     }
-    
-    // URL decode the path
-    path_ = url_decode(path_);
-}
-
-void HttpRequest::parse_header_line(const std::string& line) {
-    size_t colon_pos = line.find(':');
-    if (colon_pos == std::string::npos) {
-        return;
-    }
-    
-    std::string name = line.substr(0, colon_pos);
-    std::string value = line.substr(colon_pos + 1);
-    
-    //Trim whitespace
-    name.erase(name.find_last_not_of(" \t") + 1);
-    value.erase(0, value.find_first_not_of(" \t"));
-    value.erase(value.find_last_not_of(" \t") + 1);
-    
-    //Convert header name to lowercase for case-insensitive lookup
-    std::transform(name.begin(), name.end(), name.begin(), ::tolower);
-    
-    headers_[name] = value;
+    valid_ = is_request_valid();
 }
 
 void HttpRequest::parse_query_string() {
-    if (query_string_.empty()) {
-        return;
-    }
-    
-    std::istringstream stream(query_string_);
-    std::string pair;
-    
-    while (std::getline(stream, pair, '&')) {
-        size_t eq_pos = pair.find('=');
-        if (eq_pos != std::string::npos) {
-            std::string key = url_decode(pair.substr(0, eq_pos));
-            std::string value = url_decode(pair.substr(eq_pos + 1));
-            query_params_[key] = value;
-        } else {
-            query_params_[url_decode(pair)] = "";
+    std::string_view query = query_string_;
+    std::pmr::string name(arena_.resource());
+    std::pmr::string value(arena_.resource());
+    
+    while (!query.empty()) {
+        size_t amp_pos = query.find('&');
+        std::string_view pair = query.substr(0, amp_pos);
+        query = amp_pos == std::string_view::npos ? std::string_view() : query.substr(amp_pos + 1);
+        if (pair.empty()) {
+            continue;
         }
-    }
-}
-
-std::string HttpRequest::url_decode(const std::string& str) {
-    std::string result;
-    result.reserve(str.length());
-    
-    for (size_t i = 0; i < str.length(); ++i) {
-        if (str[i] == '%' && i + 2 < str.length()) {
-            unsigned int hex_value;
-            if (std::sscanf(str.substr(i + 1, 2).c_str(), "%x", &hex_value) == 1) {
-                result += static_cast<char>(hex_value);
-                i += 2;
-            } else {
-                result += str[i];
-            }
-        } else if (str[i] == '+') {
-            result += ' ';
+        
+        size_t eq_pos = pair.find('=');
+        url_decode_into(pair.substr(0, eq_pos), name);
+        if (eq_pos != std::string_view::npos) {
+            url_decode_into(pair.substr(eq_pos + 1), value);
         } else {
-            result += str[i];
+            value.clear();
         }
+        query_params_[name] = value;
     }
-    
-    return result;
-}
-
-std::string HttpRequest::get_header(const std::string& name) const {
-    std::string lower_name = name;
-    std::transform(lower_name.begin(), lower_name.end(), lower_name.begin(), ::tolower);
-    
-    auto it = headers_.find(lower_name);
-    return (it != headers_.end()) ? it->second : "";
 }
 
-bool HttpRequest::has_header(const std::string& name) const {
-    std::string lower_name = name;
-    std::transform(lower_name.begin(), lower_name.end(), lower_name.begin(), ::tolower);
-    
-    return headers_.find(lower_name) != headers_.end();
-}
-
-std::string HttpRequest::get_query_param(const std::string& name) const {
-    auto it = query_params_.find(name);
-    return (it != query_params_.end()) ? it->second : "";
+std::string HttpRequest::get_query_param(std::string_view name) const {
+    auto it = query_params_.find(std::pmr::string(name, arena_.resource()));
+    return it != query_params_.end() ? std::string(it->second) : std::string();
 }
 
 bool HttpRequest::is_keep_alive() const {
-    std::string connection = get_header("connection");
-    std::transform(connection.begin(), connection.end(), connection.begin(), ::tolower);
+    std::string_view connection = get_header(HeaderId::CONNECTION);
     
     if (version_ == "HTTP/1.1") {
-        return connection != "close";
+        return !iequals(connection, "close");
     } else {
-        return connection == "keep-alive";
+        return iequals(connection, "keep-alive");
     }
 }
 
@@ -175,7 +102,7 @@ std::string HttpRequest::method_to_string(HttpMethod method) {
     }
 }
 
-HttpMethod HttpRequest::string_to_method(const std::string& method_str) {
+HttpMethod HttpRequest::string_to_method(std::string_view method_str) {
     if (method_str == "GET")     return HttpMethod::GET;
     if (method_str == "POST")    return HttpMethod::POST;
     if (method_str == "PUT")     return HttpMethod::PUT;
@@ -199,23 +126,23 @@ bool HttpRequest::is_request_valid() const {
         return false;
     }
     
-    for (char c : path_) {
-        if (c < 0x20 || c == 0x7F) {
-            return false;
-        }
+    if (has_non_printable(path_.data(), path_.size())) {
+        return false;
     }
     
-    if (method_ == HttpMethod::POST || method_ == HttpMethod::PUT) {
-        auto content_length_header = get_header("content-length");
+    //a chunked body carries its own framing, Content-Length is ignored then
+    if ((method_ == HttpMethod::POST || method_ == HttpMethod::PUT) && !has_header(HeaderId::TRANSFER_ENCODING)) {
+        std::string_view content_length_header = get_header(HeaderId::CONTENT_LENGTH);
         if (!content_length_header.empty()) {
-            try {
-                size_t content_length = std::stoull(content_length_header);
-                if (body_.size() != content_length) {
-                    return body_.size() >= content_length;
-                }
-            } catch (const std::exception&) {
+            size_t content_length = 0;
+            const char* end = content_length_header.data() + content_length_header.size();
+            auto result = std::from_chars(content_length_header.data(), end, content_length);
+            if (result.ec != std::errc() || result.ptr != end) {
                 return false;
             }
+            if (get_body_size() != content_length) {
+                return get_body_size() >= content_length;
+            }
         }
     }
     
@@ -1,11 +1,91 @@
 #include "http_response.h"
-#include <sstream>
-#include <chrono>
-#include <iomanip>
+#include "http_date.h"
 #include <algorithm>
+#include <array>
+#include <ctime>
 #include <filesystem>
 
-HttpResponse::HttpResponse(HttpStatus status) : status_(status) {
+namespace {
+
+// Complete status lines, so serializing one is a single append
+constexpr std::array<std::pair<HttpStatus, std::string_view>, 18> STATUS_LINES{{
+    {HttpStatus::OK, "HTTP/1.1 200 OK\r\n"},
+    {HttpStatus::CREATED, "HTTP/1.1 201 Created\r\n"},
+    {HttpStatus::NO_CONTENT, "HTTP/1.1 204 No Content\r\n"},
+    {HttpStatus::PARTIAL_CONTENT, "HTTP/1.1 206 Partial Content\r\n"},
+    {HttpStatus::MOVED_PERMANENTLY, "HTTP/1.1 301 Moved Permanently\r\n"},
+    {HttpStatus::FOUND, "HTTP/1.1 302 Found\r\n"},
+    {HttpStatus::NOT_MODIFIED, "HTTP/1.1 304 Not Modified\r\n"},
+    {HttpStatus::BAD_REQUEST, "HTTP/1.1 400 Bad Request\r\n"},
+    {HttpStatus::UNAUTHORIZED, "HTTP/1.1 401 Unauthorized\r\n"},
+    {HttpStatus::FORBIDDEN, "HTTP/1.1 403 Forbidden\r\n"},
+    {HttpStatus::NOT_FOUND, "HTTP/1.1 404 Not Found\r\n"},
+    {HttpStatus::METHOD_NOT_ALLOWED, "HTTP/1.1 405 Method Not Allowed\r\n"},
+    {HttpStatus::CONTENT_TOO_LARGE, "HTTP/1.1 413 Content Too Large\r\n"},
+    {HttpStatus::RANGE_NOT_SATISFIABLE, "HTTP/1.1 416 Range Not Satisfiable\r\n"},
+    {HttpStatus::INTERNAL_SERVER_ERROR, "HTTP/1.1 500 Internal Server Error\r\n"},
+    {HttpStatus::NOT_IMPLEMENTED, "HTTP/1.1 501 Not Implemented\r\n"},
+    {HttpStatus::BAD_GATEWAY, "HTTP/1.1 502 Bad Gateway\r\n"},
+    {HttpStatus::SERVICE_UNAVAILABLE, "HTTP/1.1 503 Service Unavailable\r\n"}
+}};
+
+// "HTTP/1.1 " and a three-digit code in front of the text, "\r\n" behind it
+constexpr size_t STATUS_TEXT_OFFSET = 13;
+
+constexpr bool status_lines_match_codes() {
+    for (const auto& [status, line] : STATUS_LINES) {
+        int code = static_cast<int>(status);
+        if (line.substr(0, 9) != "HTTP/1.1 " || line[9] != '0' + code / 100 || line[10] != '0' + code / 10 % 10 ||
+            line[11] != '0' + code % 10 || line[12] != ' ' || line.substr(line.size() - 2) != "\r\n") {
+            return false;
+        }
+    }
+    return true;
+}
+static_assert(status_lines_match_codes(), "a status line does not match its code");
+
+constexpr std::string_view status_line(HttpStatus status) {
+    for (const auto& [entry_status, line] : STATUS_LINES) {
+        if (entry_status == status) {
+            return line;
+        }
+    }
+    return {};
+}
+
+constexpr std::array<std::pair<std::string_view, std::string_view>, 26> MIME_TYPES{{
+    {".html", "text/html; charset=utf-8"},
+    {".htm", "text/html; charset=utf-8"},
+    {".css", "text/css"},
+    {".js", "application/javascript"},
+    {".json", "application/json"},
+    {".xml", "application/xml"},
+    {".txt", "text/plain; charset=utf-8"},
+    {".jpg", "image/jpeg"},
+    {".jpeg", "image/jpeg"},
+    {".png", "image/png"},
+    {".gif", "image/gif"},
+    {".svg", "image/svg+xml"},
+    {".ico", "image/x-icon"},
+    {".pdf", "application/pdf"},
+    {".zip", "application/zip"},
+    {".tar", "application/x-tar"},
+    {".gz", "application/gzip"},
+    {".mp3", "audio/mpeg"},
+    {".mp4", "video/mp4"},
+    {".avi", "video/x-msvideo"},
+    {".mov", "video/quicktime"},
+    {".wav", "audio/wav"},
+    {".woff", "font/woff"},
+    {".woff2", "font/woff2"},
+    {".ttf", "font/ttf"},
+    {".otf", "font/otf"}
+}};
+
+} // namespace
+
+HttpResponse::HttpResponse(HttpStatus status)
+    : status_(status), headers_(arena_.resource()), body_(arena_.resource()), segments_(arena_.resource()) {
     set_default_headers();
 }
 
@@ -13,74 +93,181 @@ void HttpResponse::set_status(HttpStatus status) {
     status_ = status;
 }
 
-void HttpResponse::set_header(const std::string& name, const std::string& value) {
-    headers_[name] = value;
+void HttpResponse::set_header(HeaderId id, std::string_view value) {
+    headers_.set(id, value);
+}
+
+void HttpResponse::set_header(std::string_view name, std::string_view value) {
+    headers_.set(name, value);
 }
 
-void HttpResponse::set_body(const std::string& body) {
+void HttpResponse::set_body(std::string_view body) {
+    clear_body();
     body_ = body;
     set_content_length(body_.size());
 }
 
 void HttpResponse::set_body(const std::vector<char>& body) {
+    clear_body();
     body_.assign(body.begin(), body.end());
     set_content_length(body_.size());
 }
 
-void HttpResponse::append_body(const std::string& data) {
+void HttpResponse::set_file_body(std::shared_ptr<OpenFile> file, off_t offset, size_t length) {
+    clear_body();
+    file_body_ = FileRange{std::move(file), offset, length};
+    set_content_length(length);
+}
+
+void HttpResponse::set_shared_body(std::shared_ptr<const std::vector<char>> data) {
+    clear_body();
+    
+    const char* bytes = data->data();
+    size_t size = data->size();
+    append_body_segment(BodySegment{std::move(data), bytes, size});
+}
+
+void HttpResponse::append_body_segment(BodySegment segment) {
+    segments_size_ += segment.size;
+    segments_.push_back(std::move(segment));
+    set_content_length(get_body_size());
+}
+
+void HttpResponse::set_generated_body(BodyGenerator generator) {
+    clear_body();
+    generator_ = std::move(generator);
+    headers_.remove(HeaderId::CONTENT_LENGTH);
+    set_header(HeaderId::TRANSFER_ENCODING, "chunked");
+}
+
+void HttpResponse::omit_body() {
+    //the headers stay, they still describe the body
+    body_.clear();
+    segments_.clear();
+    segments_size_ = 0;
+    file_body_.reset();
+    generator_ = nullptr;
+}
+
+void HttpResponse::clear_body() {
+    //the framing of a generated body, even one already omitted
+    headers_.remove(HeaderId::TRANSFER_ENCODING);
+    omit_body();
+}
+
+void HttpResponse::append_body(std::string_view data) {
     body_ += data;
-    set_content_length(body_.size());
+    set_content_length(get_body_size());
 }
 
-void HttpResponse::set_content_type(const std::string& content_type) {
-    set_header("Content-Type", content_type);
+void HttpResponse::set_content_type(std::string_view content_type) {
+    set_header(HeaderId::CONTENT_TYPE, content_type);
 }
 
 void HttpResponse::set_content_length(size_t length) {
-    set_header("Content-Length", std::to_string(length));
+    set_header(HeaderId::CONTENT_LENGTH, std::to_string(length));
 }
 
 void HttpResponse::set_keep_alive(bool keep_alive) {
     if (keep_alive) {
-        set_header("Connection", "keep-alive");
-        set_header("Keep-Alive", "timeout=30, max=100");
+        set_header(HeaderId::CONNECTION, "keep-alive");
+        set_header(HeaderId::KEEP_ALIVE, "timeout=30, max=100");
     } else {
-        set_header("Connection", "close");
+        set_header(HeaderId::CONNECTION, "close");
     }
 }
 
-void HttpResponse::set_server_header(const std::string& server_name) {
-    set_header("Server", server_name);
+void HttpResponse::set_server_header(std::string_view server_name) {
+    set_header(HeaderId::SERVER, server_name);
 }
 
 void HttpResponse::set_default_headers() {
-    set_header("Date", format_date());
-    set_header("Server", "MultithreadedWebServer/1.0");
-    set_header("Connection", "close");
+    set_header(HeaderId::DATE, current_date());
+    set_header(HeaderId::SERVER, "MultithreadedWebServer/1.0");
+    set_header(HeaderId::CONNECTION, "close");
 }
 
-std::string HttpResponse::format_date() const {
-    auto now = std::chrono::system_clock::now();
-    auto time_t = std::chrono::system_clock::to_time_t(now);
+std::string_view HttpResponse::current_date() {
+    thread_local time_t formatted_second = -1;
+    thread_local char date[HTTP_DATE_LENGTH];
     
-    std::stringstream ss;
-    ss << std::put_time(std::gmtime(&time_t), "%a, %d %b %Y %H:%M:%S GMT");
-    return ss.str();
+    //time() is a vDSO call, so the cost per response is a compare
+    time_t now = time(nullptr);
+    if (now != formatted_second) {
+        format_http_date(now, date);
+        formatted_second = now;
+    }
+    return std::string_view(date, HTTP_DATE_LENGTH);
+}
+
+std::string HttpResponse::serialize_headers() const {
+    std::string headers;
+    serialize_headers(headers);
+    return headers;
+}
+
+void HttpResponse::serialize_headers(std::string& out) const {
+    //a stored head already holds the status line, headers_ then only what changes per request
+    if (serialized_head_) {
+        out += *serialized_head_;
+    } else {
+        append_status_line(out);
+    }
+    append_headers(out, false);
+    out += "\r\n";
+}
+
+std::string HttpResponse::serialize_fixed_headers() const {
+    if (serialized_head_) {
+        return *serialized_head_;
+    }
+    std::string head;
+    append_status_line(head);
+    append_headers(head, true);
+    return head;
+}
+
+void HttpResponse::append_status_line(std::string& out) const {
+    std::string_view line = status_line(status_);
+    if (!line.empty()) {
+        out += line;
+    } else {
+        out += "HTTP/1.1 ";
+        out += std::to_string(static_cast<int>(status_));
+        out += " Unknown\r\n";
+    }
+}
+
+void HttpResponse::append_headers(std::string& out, bool fixed_only) const {
+    headers_.for_each([&out, fixed_only](std::string_view name, std::string_view value) {
+        if (fixed_only && (iequals(name, "Date") || iequals(name, "Connection") || iequals(name, "Keep-Alive"))) {
+            return;
+        }
+        out += name;
+        out += ": ";
+        out += value;
+        out += "\r\n";
+    });
+}
+
+void HttpResponse::append_body_iovecs(std::vector<iovec>& iov) const {
+    if (!body_.empty()) {
+        iov.push_back({const_cast<char*>(body_.data()), body_.size()});
+    }
+    for (const auto& segment : segments_) {
+        if (segment.size > 0) {
+            iov.push_back({const_cast<char*>(segment.data), segment.size});
+        }
+    }
 }
 
 std::string HttpResponse::to_string() const {
-    std::ostringstream response;
-    
-    response << version_ << " " << static_cast<int>(status_) << " " << get_status_text(status_) << "\r\n";
-    
-    for (const auto& [name, value] : headers_) {
-        response << name << ": " << value << "\r\n";
+    std::string response = serialize_headers();
+    response += body_;
+    for (const auto& segment : segments_) {
+        response.append(segment.data, segment.size);
     }
-    
-    response << "\r\n";
-    response << body_;
-    
-    return response.str();
+    return response;
 }
 
 std::vector<char> HttpResponse::to_bytes() const {
@@ -88,94 +275,65 @@ std::vector<char> HttpResponse::to_bytes() const {
     return std::vector<char>(response_str.begin(), response_str.end());
 }
 
-std::string HttpResponse::get_mime_type(const std::string& file_extension) {
-    static std::unordered_map<std::string, std::string> mime_types = {
-        {".html", "text/html; charset=utf-8"},
-        {".htm", "text/html; charset=utf-8"},
-        {".css", "text/css"},
-        {".js", "application/javascript"},
-        {".json", "application/json"},
-        {".xml", "application/xml"},
-        {".txt", "text/plain; charset=utf-8"},
-        {".jpg", "image/jpeg"},
-        {".jpeg", "image/jpeg"},
-        {".png", "image/png"},
-        {".gif", "image/gif"},
-        {".svg", "image/svg+xml"},
-        {".ico", "image/x-icon"},
-        {".pdf", "application/pdf"},
-        {".zip", "application/zip"},
-        {".tar", "application/x-tar"},
-        {".gz", "application/gzip"},
-        {".mp3", "audio/mpeg"},
-        {".mp4", "video/mp4"},
-        {".avi", "video/x-msvideo"},
-        {".mov", "video/quicktime"},
-        {".wav", "audio/wav"},
-        {".woff", "font/woff"},
-        {".woff2", "font/woff2"},
-        {".ttf", "font/ttf"},
-        {".otf", "font/otf"}
-    };
-    
-    std::string ext = file_extension;
-    std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
-    
-    auto it = mime_types.find(ext);
-    return (it != mime_types.end()) ? it->second : "application/octet-stream";
-}
-
-std::string HttpResponse::get_status_text(HttpStatus status) {
-    switch (status) {
-        case HttpStatus::OK: return "OK";
-        case HttpStatus::CREATED: return "Created";
-        case HttpStatus::NO_CONTENT: return "No Content";
-        case HttpStatus::MOVED_PERMANENTLY: return "Moved Permanently";
-        case HttpStatus::FOUND: return "Found";
-        case HttpStatus::NOT_MODIFIED: return "Not Modified";
-        case HttpStatus::BAD_REQUEST: return "Bad Request";
-        case HttpStatus::UNAUTHORIZED: return "Unauthorized";
-        case HttpStatus::FORBIDDEN: return "Forbidden";
-        case HttpStatus::NOT_FOUND: return "Not Found";
-        case HttpStatus::METHOD_NOT_ALLOWED: return "Method Not Allowed";
-        case HttpStatus::INTERNAL_SERVER_ERROR: return "Internal Server Error";
-        case HttpStatus::NOT_IMPLEMENTED: return "Not Implemented";
-        case HttpStatus::BAD_GATEWAY: return "Bad Gateway";
-        case HttpStatus::SERVICE_UNAVAILABLE: return "Service Unavailable";
-        default: return "Unknown";
+std::string_view HttpResponse::get_mime_type(std::string_view file_extension) {
+    for (const auto& [extension, mime_type] : MIME_TYPES) {
+        if (iequals(extension, file_extension)) {
+            return mime_type;
+        }
     }
+    return "application/octet-stream";
+}
+
+std::string_view HttpResponse::get_status_text(HttpStatus status) {
+    std::string_view line = status_line(status);
+    if (line.empty()) {
+        return "Unknown";
+    }
+    return line.substr(STATUS_TEXT_OFFSET, line.size() - STATUS_TEXT_OFFSET - 2);
 }
 
 HttpResponse HttpResponse::create_error_response(HttpStatus status, const std::string& message) {
     HttpResponse response(status);
     
-    std::string status_text = get_status_text(status);
-    std::string error_message = message.empty() ? status_text : message;
+    std::string code = std::to_string(static_cast<int>(status));
+    std::string_view status_text = get_status_text(status);
+    std::string_view error_message = message.empty() ? std::string_view(status_text) : std::string_view(message);
     
-    std::ostringstream body;
-    body << "<!DOCTYPE html>\n";
-    body << "<html><head><title>" << static_cast<int>(status) << " " << status_text << "</title></head>\n";
-    body << "<body>\n";
-    body << "<h1>" << static_cast<int>(status) << " " << status_text << "</h1>\n";
-    body << "<p>" << error_message << "</p>\n";
-    body << "<hr>\n";
-    body << "<p><em>MultithreadedWebServer/1.0</em></p>\n";
-    body << "</body></html>\n";
+    //written straight into the body, which lives wherever the response does
+    std::pmr::string& body = response.body_;
+    body += "<!DOCTYPE html>\n";
+    body.append("<html><head><title>").append(code).append(" ").append(status_text).append("</title></head>\n");
+    body += "<body>\n";
+    body.append("<h1>").append(code).append(" ").append(status_text).append("</h1>\n");
+    body.append("<p>").append(error_message).append("</p>\n");
+    body += "<hr>\n";
+    body += "<p><em>MultithreadedWebServer/1.0</em></p>\n";
+    body += "</body></html>\n";
     
-    response.set_body(body.str());
+    response.set_content_length(body.size());
     response.set_content_type("text/html; charset=utf-8");
     
     return response;
 }
 
+HttpResponse HttpResponse::create_serialized_response(std::shared_ptr<const std::string> head,
+                                                     std::shared_ptr<const std::vector<char>> body) {
+    HttpResponse response(HttpStatus::OK);
+    response.set_shared_body(std::move(body));
+    
+    //everything else, Content-Length included, is already in head
+    response.headers_.clear();
+    response.set_header(HeaderId::DATE, current_date());
+    response.serialized_head_ = std::move(head);
+    return response;
+}
+
 HttpResponse HttpResponse::create_file_response(const std::string& file_path, const std::vector<char>& file_content) {
     HttpResponse response(HttpStatus::OK);
     
     std::string extension = std::filesystem::path(file_path).extension().string();
-    std::string mime_type = get_mime_type(extension);
-    
     response.set_body(file_content);
-    response.set_content_type(mime_type);
+    response.set_content_type(get_mime_type(extension));
     
     return response;
 }
\ No newline at end of file
@@ -0,0 +1,20 @@
+#include "io_backend.h"
+#include "epoll_wrapper.h"
+#include "io_uring_backend.h"
+#include <iostream>
+
+std::unique_ptr<IoBackend> IoBackend::create(IoBackendType type) {
+    if (type == IoBackendType::IO_URING) {
+        auto backend = std::make_unique<IoUringBackend>();
+        if (backend->init()) {
+            return backend;
+        }
+        std::cerr << "Warning: io_uring backend unavailable, falling back to epoll" << std::endl;
+    }
+    
+    auto backend = std::make_unique<EpollWrapper>();
+    if (!backend->init()) {
+        return nullptr;
+    }
+    return backend;
+}
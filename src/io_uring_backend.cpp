@@ -0,0 +1,687 @@
+#include "io_uring_backend.h"
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <sys/utsname.h>
+#include <sys/eventfd.h>
+#include <poll.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <cstddef>
+#include <cstdio>
+#include <algorithm>
+#include <iostream>
+
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#endif
+
+// multishot accept/recv (6.0) are the newest features we rely on
+#if defined(IORING_ACCEPT_MULTISHOT) && defined(IORING_RECV_MULTISHOT) && defined(__NR_io_uring_setup)
+#define WEBSERVER_HAVE_IO_URING 1
+#endif
+
+IoUringBackend::IoUringBackend()
+    : ring_fd_(-1), wakeup_fd_(-1),
+      sq_ring_(nullptr), cq_ring_(nullptr), ring_size_(0),
+      sqes_(nullptr), sqes_size_(0),
+      sq_head_(nullptr), sq_tail_(nullptr), sq_mask_(0), sq_entries_(0), sq_local_tail_(0),
+      cq_head_(nullptr), cq_tail_(nullptr), cq_mask_(0), cqes_(nullptr),
+      buffer_ring_(nullptr), buffer_ring_size_(0), buffer_ring_tail_(nullptr) {
+}
+
+IoUringBackend::~IoUringBackend() {
+    release_rings();
+}
+
+#ifdef WEBSERVER_HAVE_IO_URING
+
+namespace {
+
+int io_uring_setup(unsigned entries, io_uring_params* params) {
+    return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+int io_uring_enter(int ring_fd, unsigned to_submit, unsigned min_complete, unsigned flags,
+                   const void* arg, size_t arg_size) {
+    return static_cast<int>(syscall(__NR_io_uring_enter, ring_fd, to_submit, min_complete, flags, arg, arg_size));
+}
+
+int io_uring_register(int ring_fd, unsigned opcode, void* arg, unsigned nr_args) {
+    return static_cast<int>(syscall(__NR_io_uring_register, ring_fd, opcode, arg, nr_args));
+}
+
+bool kernel_at_least(int major, int minor) {
+    utsname info{};
+    if (uname(&info) != 0) {
+        return false;
+    }
+
+    int kernel_major = 0, kernel_minor = 0;
+    if (std::sscanf(info.release, "%d.%d", &kernel_major, &kernel_minor) != 2) {
+        return false;
+    }
+    return kernel_major > major || (kernel_major == major && kernel_minor >= minor);
+}
+
+} // namespace
+
+bool IoUringBackend::init() {
+    if (!kernel_at_least(6, 0)) {
+        std::cerr << "io_uring: kernel older than 6.0, multishot accept/recv unavailable" << std::endl;
+        return false;
+    }
+
+    if (!setup_rings() || !probe_opcodes() || !setup_buffer_ring()) {
+        release_rings();
+        return false;
+    }
+
+    wakeup_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wakeup_fd_ == -1) {
+        std::cerr << "io_uring: failed to create wakeup eventfd: " << strerror(errno) << std::endl;
+        release_rings();
+        return false;
+    }
+    arm_wakeup();
+
+    return true;
+}
+
+bool IoUringBackend::setup_rings() {
+    io_uring_params params{};
+    ring_fd_ = io_uring_setup(RING_ENTRIES, &params);
+    if (ring_fd_ < 0) {
+        std::cerr << "io_uring: setup failed: " << strerror(errno) << std::endl;
+        ring_fd_ = -1;
+        return false;
+    }
+
+    if (!(params.features & IORING_FEAT_SINGLE_MMAP) || !(params.features & IORING_FEAT_EXT_ARG)) {
+        std::cerr << "io_uring: kernel lacks single mmap or extended enter arguments" << std::endl;
+        return false;
+    }
+
+    //with IORING_FEAT_SINGLE_MMAP both rings live in one mapping
+    ring_size_ = std::max(params.sq_off.array + params.sq_entries * sizeof(unsigned),
+                          params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe));
+
+    sq_ring_ = mmap(nullptr, ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                    ring_fd_, IORING_OFF_SQ_RING);
+    if (sq_ring_ == MAP_FAILED) {
+        sq_ring_ = nullptr;
+        std::cerr << "io_uring: failed to map rings: " << strerror(errno) << std::endl;
+        return false;
+    }
+    cq_ring_ = sq_ring_;
+
+    sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+    void* sqes = mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                      ring_fd_, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED) {
+        std::cerr << "io_uring: failed to map submission entries: " << strerror(errno) << std::endl;
+        return false;
+    }
+    sqes_ = static_cast<io_uring_sqe*>(sqes);
+
+    char* sq = static_cast<char*>(sq_ring_);
+    sq_head_ = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+    sq_tail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+    sq_mask_ = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+    sq_entries_ = params.sq_entries;
+    sq_local_tail_ = *sq_tail_;
+
+    //identity mapping, submission slot i always uses sqe i
+    unsigned* sq_array = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+    for (unsigned i = 0; i < sq_entries_; ++i) {
+        sq_array[i] = i;
+    }
+
+    char* cq = static_cast<char*>(cq_ring_);
+    cq_head_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+    cq_tail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+    cq_mask_ = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+    cqes_ = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+    return true;
+}
+
+bool IoUringBackend::probe_opcodes() {
+    constexpr unsigned probe_ops = 256;
+    std::vector<char> storage(sizeof(io_uring_probe) + probe_ops * sizeof(io_uring_probe_op), 0);
+    auto* probe = reinterpret_cast<io_uring_probe*>(storage.data());
+
+    if (io_uring_register(ring_fd_, IORING_REGISTER_PROBE, probe, probe_ops) < 0) {
+        std::cerr << "io_uring: opcode probe failed: " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    for (unsigned op : {IORING_OP_ACCEPT, IORING_OP_RECV, IORING_OP_SENDMSG, IORING_OP_POLL_ADD, IORING_OP_ASYNC_CANCEL}) {
+        if (op > probe->last_op || !(probe->ops[op].flags & IO_URING_OP_SUPPORTED)) {
+            std::cerr << "io_uring: required opcode " << op << " not supported" << std::endl;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool IoUringBackend::setup_buffer_ring() {
+    buffer_ring_size_ = BUFFER_COUNT * sizeof(io_uring_buf);
+    buffer_ring_ = mmap(nullptr, buffer_ring_size_, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (buffer_ring_ == MAP_FAILED) {
+        buffer_ring_ = nullptr;
+        std::cerr << "io_uring: failed to allocate buffer ring: " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    io_uring_buf_reg reg{};
+    reg.ring_addr = reinterpret_cast<uint64_t>(buffer_ring_);
+    reg.ring_entries = BUFFER_COUNT;
+    reg.bgid = BUFFER_GROUP;
+    if (io_uring_register(ring_fd_, IORING_REGISTER_PBUF_RING, &reg, 1) < 0) {
+        std::cerr << "io_uring: provided buffer ring not supported: " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    buffers_ = std::make_unique<char[]>(BUFFER_COUNT * BUFFER_SIZE);
+    //the ring tail overlays the resv field of the first entry
+    buffer_ring_tail_ = reinterpret_cast<unsigned short*>(
+        static_cast<char*>(buffer_ring_) + offsetof(io_uring_buf, resv));
+
+    for (unsigned i = 0; i < BUFFER_COUNT; ++i) {
+        buffers_to_recycle_.push_back(static_cast<uint16_t>(i));
+    }
+    recycle_buffers();
+
+    return true;
+}
+
+void IoUringBackend::release_rings() {
+    if (wakeup_fd_ != -1) {
+        close(wakeup_fd_);
+        wakeup_fd_ = -1;
+    }
+    if (ring_fd_ != -1) {
+        close(ring_fd_);
+        ring_fd_ = -1;
+    }
+    if (sqes_) {
+        munmap(sqes_, sqes_size_);
+        sqes_ = nullptr;
+    }
+    if (sq_ring_) {
+        munmap(sq_ring_, ring_size_);
+        sq_ring_ = nullptr;
+        cq_ring_ = nullptr;
+    }
+    if (buffer_ring_) {
+        munmap(buffer_ring_, buffer_ring_size_);
+        buffer_ring_ = nullptr;
+    }
+    buffers_.reset();
+}
+
+//io_uring already waits exclusively on a listener, each connection goes to one ring
+bool IoUringBackend::add_listener(int fd, bool /*exclusive*/) {
+    return queue_request({Request::ADD_LISTENER, fd, EPOLLIN, 0});
+}
+
+bool IoUringBackend::add_fd(int fd, uint32_t events, uint32_t generation) {
+    return queue_request({Request::ADD, fd, events, generation});
+}
+
+bool IoUringBackend::modify_fd(int fd, uint32_t events, uint32_t generation) {
+    return queue_request({Request::MODIFY, fd, events, generation});
+}
+
+bool IoUringBackend::remove_fd(int fd) {
+    return queue_request({Request::REMOVE, fd, 0, 0});
+}
+
+bool IoUringBackend::submit_send(int fd, const msghdr* message, int flags, uint32_t generation,
+                                 std::shared_ptr<void> owner) {
+    if (fd < 0) {
+        return false;
+    }
+
+    bool needs_wakeup = false;
+    {
+        std::lock_guard<std::mutex> lock(pending_mutex_);
+        pending_sends_.push_back({fd, generation, message, flags, std::move(owner)});
+        needs_wakeup = std::this_thread::get_id() != owner_thread_;
+    }
+
+    //a worker's response goes out with the reactor's next batch, not after its timeout
+    if (needs_wakeup) {
+        wakeup();
+    }
+
+    return true;
+}
+
+bool IoUringBackend::queue_request(const PendingRequest& request) {
+    if (request.fd < 0) {
+        return false;
+    }
+
+    bool needs_wakeup = false;
+    {
+        std::lock_guard<std::mutex> lock(pending_mutex_);
+        pending_.push_back(request);
+        needs_wakeup = std::this_thread::get_id() != owner_thread_;
+    }
+
+    //requests from workers must not wait for the reactor's next timeout
+    if (needs_wakeup) {
+        wakeup();
+    }
+
+    return true;
+}
+
+void IoUringBackend::wakeup() {
+    if (wakeup_fd_ != -1) {
+        uint64_t one = 1;
+        ssize_t ignored = write(wakeup_fd_, &one, sizeof(one));
+        (void)ignored;
+    }
+}
+
+IoUringBackend::FdState& IoUringBackend::state_for(int fd) {
+    if (static_cast<size_t>(fd) >= fd_states_.size()) {
+        fd_states_.resize(static_cast<size_t>(fd) + 1024);
+    }
+    return fd_states_[fd];
+}
+
+uint64_t IoUringBackend::encode(OpType type, uint32_t generation, int fd) {
+    return (static_cast<uint64_t>(type) << 56) |
+           (static_cast<uint64_t>(generation & 0xFFFFFF) << 32) |
+           static_cast<uint32_t>(fd);
+}
+
+void IoUringBackend::apply_pending_requests() {
+    {
+        std::lock_guard<std::mutex> lock(pending_mutex_);
+        applying_.swap(pending_);
+        applying_sends_.swap(pending_sends_);
+    }
+
+    for (const auto& request : applying_) {
+        FdState& state = state_for(request.fd);
+
+        switch (request.type) {
+            case Request::ADD_LISTENER:
+                state.generation++;
+                state.registered = true;
+                state.listener = true;
+                arm_accept(request.fd);
+                break;
+
+            case Request::ADD:
+                //a new generation so completions still in flight for a previous socket
+                //with the same fd number are recognized as stale
+                state = FdState{state.generation + 1, request.tag, true, false, false, false};
+                arm_recv(request.fd);
+                if (request.events & EPOLLOUT) {
+                    arm_pollout(request.fd);
+                }
+                break;
+
+            case Request::MODIFY:
+                if (!state.registered) {
+                    break;
+                }
+                //recv is multishot and always armed, only write interest changes
+                if ((request.events & EPOLLOUT) && !state.pollout_armed) {
+                    arm_pollout(request.fd);
+                }
+                break;
+
+            case Request::REMOVE:
+                if (!state.registered) {
+                    break;
+                }
+                if (state.listener) {
+                    cancel(encode(OpType::ACCEPT, state.generation, request.fd));
+                }
+                if (state.recv_armed) {
+                    cancel(encode(OpType::RECV, state.generation, request.fd));
+                }
+                if (state.pollout_armed) {
+                    cancel(encode(OpType::POLL_OUT, state.generation, request.fd));
+                }
+                if (state.send_armed) {
+                    //a peer that stopped reading would otherwise hold the send forever
+                    cancel(encode(OpType::SEND, state.generation, request.fd));
+                }
+                state.registered = false;
+                state.listener = false;
+                state.recv_armed = false;
+                state.pollout_armed = false;
+                state.send_armed = false;
+                break;
+        }
+    }
+    applying_.clear();
+
+    //after the registrations, so a send for a socket removed or reused meanwhile is dropped
+    //together with its owner instead of being submitted
+    for (const auto& send : applying_sends_) {
+        FdState& state = state_for(send.fd);
+        if (state.registered && state.tag == send.tag) {
+            arm_send(send);
+        }
+    }
+    applying_sends_.clear();
+
+    for (int fd : accept_rearm_) {
+        if (state_for(fd).registered) {
+            arm_accept(fd);
+        }
+    }
+    accept_rearm_.clear();
+
+    for (int fd : recv_rearm_) {
+        FdState& state = state_for(fd);
+        if (state.registered && !state.recv_armed) {
+            arm_recv(fd);
+        }
+    }
+    recv_rearm_.clear();
+}
+
+void IoUringBackend::recycle_buffers() {
+    if (buffers_to_recycle_.empty()) {
+        return;
+    }
+
+    //io_uring_buf_ring::bufs is declared with __DECLARE_FLEX_ARRAY, which a C++
+    //compiler lays out at offset 8 instead of 0, so index the entries directly
+    auto* bufs = static_cast<io_uring_buf*>(buffer_ring_);
+    unsigned short tail = *buffer_ring_tail_;
+
+    for (uint16_t id : buffers_to_recycle_) {
+        io_uring_buf& buf = bufs[tail & (BUFFER_COUNT - 1)];
+        buf.addr = reinterpret_cast<uint64_t>(buffers_.get() + static_cast<size_t>(id) * BUFFER_SIZE);
+        buf.len = BUFFER_SIZE;
+        buf.bid = id;
+        tail++;
+    }
+    buffers_to_recycle_.clear();
+
+    //publish all returned buffers to the kernel with a single tail update
+    __atomic_store_n(buffer_ring_tail_, tail, __ATOMIC_RELEASE);
+}
+
+io_uring_sqe* IoUringBackend::next_sqe() {
+    unsigned head = __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE);
+    if (sq_local_tail_ - head >= sq_entries_) {
+        //submission queue full, flush what we have without waiting
+        submit_and_wait(0, 0);
+        head = __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE);
+        if (sq_local_tail_ - head >= sq_entries_) {
+            std::cerr << "io_uring: submission queue overflow" << std::endl;
+            return nullptr;
+        }
+    }
+
+    io_uring_sqe* sqe = &sqes_[sq_local_tail_ & sq_mask_];
+    std::memset(sqe, 0, sizeof(*sqe));
+    sq_local_tail_++;
+    return sqe;
+}
+
+void IoUringBackend::arm_accept(int fd) {
+    io_uring_sqe* sqe = next_sqe();
+    if (!sqe) return;
+
+    sqe->opcode = IORING_OP_ACCEPT;
+    sqe->fd = fd;
+    sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+    sqe->accept_flags = SOCK_NONBLOCK | SOCK_CLOEXEC;
+    sqe->user_data = encode(OpType::ACCEPT, state_for(fd).generation, fd);
+}
+
+void IoUringBackend::arm_recv(int fd) {
+    io_uring_sqe* sqe = next_sqe();
+    if (!sqe) return;
+
+    FdState& state = state_for(fd);
+    sqe->opcode = IORING_OP_RECV;
+    sqe->fd = fd;
+    sqe->ioprio = IORING_RECV_MULTISHOT;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = BUFFER_GROUP;
+    sqe->user_data = encode(OpType::RECV, state.generation, fd);
+    state.recv_armed = true;
+}
+
+void IoUringBackend::arm_pollout(int fd) {
+    io_uring_sqe* sqe = next_sqe();
+    if (!sqe) return;
+
+    FdState& state = state_for(fd);
+    sqe->opcode = IORING_OP_POLL_ADD;
+    sqe->fd = fd;
+    sqe->poll32_events = POLLOUT;
+    sqe->user_data = encode(OpType::POLL_OUT, state.generation, fd);
+    state.pollout_armed = true;
+}
+
+void IoUringBackend::arm_send(const PendingSend& send) {
+    io_uring_sqe* sqe = next_sqe();
+    if (!sqe) return;
+
+    FdState& state = state_for(send.fd);
+    sqe->opcode = IORING_OP_SENDMSG;
+    sqe->fd = send.fd;
+    sqe->addr = reinterpret_cast<uint64_t>(send.message);
+    sqe->len = 1;
+    sqe->msg_flags = static_cast<uint32_t>(send.flags);
+    sqe->user_data = encode(OpType::SEND, state.generation, send.fd);
+    sends_in_flight_[sqe->user_data] = send.owner;
+    state.send_armed = true;
+}
+
+void IoUringBackend::arm_wakeup() {
+    io_uring_sqe* sqe = next_sqe();
+    if (!sqe) return;
+
+    sqe->opcode = IORING_OP_POLL_ADD;
+    sqe->fd = wakeup_fd_;
+    sqe->poll32_events = POLLIN;
+    sqe->len = IORING_POLL_ADD_MULTI;
+    sqe->user_data = encode(OpType::WAKEUP, 0, wakeup_fd_);
+}
+
+void IoUringBackend::cancel(uint64_t user_data) {
+    io_uring_sqe* sqe = next_sqe();
+    if (!sqe) return;
+
+    sqe->opcode = IORING_OP_ASYNC_CANCEL;
+    sqe->fd = -1;
+    sqe->addr = user_data;
+    sqe->user_data = encode(OpType::CANCEL, 0, 0);
+}
+
+int IoUringBackend::submit_and_wait(unsigned wait_nr, int timeout_ms) {
+    __atomic_store_n(sq_tail_, sq_local_tail_, __ATOMIC_RELEASE);
+    unsigned to_submit = sq_local_tail_ - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE);
+
+    unsigned flags = 0;
+    const void* arg = nullptr;
+    size_t arg_size = 0;
+    io_uring_getevents_arg wait_arg{};
+    __kernel_timespec timeout{};
+
+    if (wait_nr > 0) {
+        flags |= IORING_ENTER_GETEVENTS;
+        if (timeout_ms >= 0) {
+            timeout.tv_sec = timeout_ms / 1000;
+            timeout.tv_nsec = static_cast<long long>(timeout_ms % 1000) * 1000000;
+            wait_arg.ts = reinterpret_cast<uint64_t>(&timeout);
+            flags |= IORING_ENTER_EXT_ARG;
+            arg = &wait_arg;
+            arg_size = sizeof(wait_arg);
+        }
+    }
+
+    if (to_submit == 0 && wait_nr == 0) {
+        return 0;
+    }
+
+    int ret = io_uring_enter(ring_fd_, to_submit, wait_nr, flags, arg, arg_size);
+    if (ret < 0 && (errno == ETIME || errno == EBUSY)) {
+        return 0;
+    }
+    return ret;
+}
+
+int IoUringBackend::wait_for_events(std::vector<Event>& events, int timeout_ms) {
+    {
+        std::lock_guard<std::mutex> lock(pending_mutex_);
+        owner_thread_ = std::this_thread::get_id();
+    }
+
+    //payloads handed out by the previous call are consumed by now
+    recycle_buffers();
+    apply_pending_requests();
+
+    events.clear();
+
+    //submit everything queued since the last iteration and wait in one syscall
+    unsigned head = *cq_head_;
+    unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+    unsigned wait_nr = (head == tail && timeout_ms != 0) ? 1 : 0;
+
+    if (submit_and_wait(wait_nr, timeout_ms) < 0) {
+        if (errno != EINTR) {
+            std::cerr << "io_uring_enter failed: " << strerror(errno) << std::endl;
+        }
+        return -1;
+    }
+
+    head = *cq_head_;
+    tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+    while (head != tail) {
+        process_completion(cqes_[head & cq_mask_], events);
+        head++;
+    }
+    __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+
+    return static_cast<int>(events.size());
+}
+
+void IoUringBackend::process_completion(const io_uring_cqe& cqe, std::vector<Event>& events) {
+    OpType type = static_cast<OpType>(cqe.user_data >> 56);
+    uint32_t generation = static_cast<uint32_t>(cqe.user_data >> 32) & 0xFFFFFF;
+    int fd = static_cast<int>(cqe.user_data & 0xFFFFFFFF);
+    bool more = cqe.flags & IORING_CQE_F_MORE;
+
+    if (cqe.flags & IORING_CQE_F_BUFFER) {
+        //returned to the ring at the start of the next wait, after the caller copied the data
+        buffers_to_recycle_.push_back(static_cast<uint16_t>(cqe.flags >> IORING_CQE_BUFFER_SHIFT));
+    }
+
+    if (type == OpType::CANCEL) {
+        return;
+    }
+
+    if (type == OpType::WAKEUP) {
+        uint64_t value;
+        while (read(wakeup_fd_, &value, sizeof(value)) > 0) {}
+        if (!more) {
+            arm_wakeup();
+        }
+        return;
+    }
+
+    FdState& state = state_for(fd);
+    bool current = state.registered && (state.generation & 0xFFFFFF) == generation;
+
+    switch (type) {
+        case OpType::ACCEPT:
+            if (cqe.res >= 0) {
+                if (current) {
+                    events.push_back(Event{fd, EPOLLIN, state.tag, cqe.res});
+                } else {
+                    close(cqe.res);
+                }
+            } else if (cqe.res != -ECANCELED && cqe.res != -EAGAIN) {
+                std::cerr << "Failed to accept connection: " << strerror(-cqe.res) << std::endl;
+            }
+            if (!more && current) {
+                accept_rearm_.push_back(fd);
+            }
+            break;
+
+        case OpType::RECV:
+            if (!current) {
+                break;
+            }
+            if (!more) {
+                state.recv_armed = false;
+            }
+            if (cqe.res > 0) {
+                const char* data = buffers_.get() + static_cast<size_t>(cqe.flags >> IORING_CQE_BUFFER_SHIFT) * BUFFER_SIZE;
+                events.push_back(Event{fd, EPOLLIN, state.tag, -1, data, static_cast<size_t>(cqe.res)});
+                if (!more) {
+                    recv_rearm_.push_back(fd);
+                }
+            } else if (cqe.res == -ENOBUFS) {
+                //all provided buffers are in use, re-arm once they are recycled
+                recv_rearm_.push_back(fd);
+            } else if (cqe.res == 0) {
+                //peer closed, the reader sees EOF on its own recv()
+                events.push_back(Event{fd, EPOLLIN | EPOLLRDHUP, state.tag});
+            } else if (cqe.res != -ECANCELED) {
+                events.push_back(Event{fd, EPOLLERR, state.tag});
+            }
+            break;
+
+        case OpType::POLL_OUT:
+            if (!current) {
+                break;
+            }
+            state.pollout_armed = false;
+            if (cqe.res >= 0) {
+                events.push_back(Event{fd, EPOLLOUT, state.tag});
+            }
+            break;
+
+        case OpType::SEND:
+            //the kernel is done with the buffers, whether or not anyone still wants the result
+            sends_in_flight_.erase(cqe.user_data);
+            if (!current) {
+                break;
+            }
+            state.send_armed = false;
+            events.push_back(Event{fd, EPOLLOUT, state.tag, -1, nullptr, 0, true, cqe.res});
+            break;
+
+        default:
+            break;
+    }
+}
+
+#else // !WEBSERVER_HAVE_IO_URING
+
+bool IoUringBackend::init() {
+    std::cerr << "io_uring: not available in this build (kernel headers too old)" << std::endl;
+    return false;
+}
+
+bool IoUringBackend::add_listener(int, bool) { return false; }
+bool IoUringBackend::add_fd(int, uint32_t, uint32_t) { return false; }
+bool IoUringBackend::modify_fd(int, uint32_t, uint32_t) { return false; }
+bool IoUringBackend::remove_fd(int) { return false; }
+int IoUringBackend::wait_for_events(std::vector<Event>&, int) { return -1; }
+bool IoUringBackend::submit_send(int, const msghdr*, int, uint32_t, std::shared_ptr<void>) { return false; }
+void IoUringBackend::wakeup() {}
+void IoUringBackend::release_rings() {}
+
+#endif
@@ -19,6 +19,7 @@ void signal_handler(int signal) {
 int main(int argc, char* argv[]) {
     int port = 8080;
     size_t thread_count = 0; // VERY IMPOOORTANNT!! 0 means auto-detect
+    size_t reactor_count = 0; // 0 means use reactor_count from config.json
     
     if (argc > 1) {
         try {
@@ -45,15 +46,31 @@ int main(int argc, char* argv[]) {
         }
     }
     
+    if (argc > 3) {
+        try {
+            reactor_count = std::stoul(argv[3]);
+            if (reactor_count > 256) {
+                std::cerr << "Reactor count too high. Using config.json value." << std::endl;
+                reactor_count = 0;
+            }
+        } catch (const std::exception&) {
+            std::cerr << "Invalid reactor count argument. Using config.json value." << std::endl;
+            reactor_count = 0;
+        }
+    }
+    
     std::signal(SIGINT, signal_handler);
     std::signal(SIGTERM, signal_handler);
     
-    server_instance = std::make_unique<Server>(port, "0.0.0.0", thread_count);
+    server_instance = std::make_unique<Server>(port, "0.0.0.0", thread_count, reactor_count);
     
     std::cout << "Starting high-performance HTTP server on port " << port;
     if (thread_count > 0) {
         std::cout << " with " << thread_count << " threads";
     }
+    if (reactor_count > 0) {
+        std::cout << " and " << reactor_count << " reactors";
+    }
     std::cout << "..." << std::endl;
     
     if (!server_instance->start()) {
@@ -0,0 +1,66 @@
+#include "request_body.h"
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <cstdlib>
+
+SpooledBody::SpooledBody(size_t memory_limit, size_t max_size, std::string temp_dir)
+    : memory_limit_(memory_limit), max_size_(max_size), temp_dir_(std::move(temp_dir)) {}
+
+bool SpooledBody::consume(const char* data, size_t size) {
+    if (size > max_size_ - size_) {
+        too_large_ = true;
+        return fail("body exceeds " + std::to_string(max_size_) + " bytes");
+    }
+    
+    if (!file_ && memory_.size() + size > memory_limit_ && !spill()) {
+        return false;
+    }
+    memory_.append(data, size);
+    size_ += size;
+    
+    return !file_ || memory_.size() < WRITE_CHUNK || flush();
+}
+
+bool SpooledBody::finish() {
+    return !file_ || flush();
+}
+
+bool SpooledBody::spill() {
+    //O_TMPFILE never gives the file a name; filesystems without it get mkstemp + unlink
+    int fd = open(temp_dir_.c_str(), O_TMPFILE | O_RDWR | O_CLOEXEC, 0600);
+    if (fd == -1 && (errno == EOPNOTSUPP || errno == EISDIR || errno == EINVAL)) {
+        std::string path = temp_dir_ + "/upload-XXXXXX";
+        fd = mkostemp(&path[0], O_CLOEXEC);
+        if (fd != -1) {
+            unlink(path.c_str());
+        }
+    }
+    if (fd == -1) {
+        return fail("cannot create a temporary file in " + temp_dir_ + ": " + strerror(errno));
+    }
+    
+    file_ = std::make_shared<OpenFile>(fd);
+    return flush();
+}
+
+bool SpooledBody::flush() {
+    size_t written = 0;
+    while (written < memory_.size()) {
+        ssize_t result = write(file_->fd(), memory_.data() + written, memory_.size() - written);
+        if (result == -1 && errno == EINTR) {
+            continue;
+        }
+        if (result <= 0) {
+            return fail(std::string("write to temporary file failed: ") + strerror(errno));
+        }
+        written += result;
+    }
+    memory_.clear();
+    return true;
+}
+
+bool SpooledBody::fail(const std::string& message) {
+    error_ = message;
+    return false;
+}
@@ -1,8 +1,12 @@
 #include "server.h"
 #include "http_request.h"
+#include "http_parser.h"
 #include "http_response.h"
 #include "file_handler.h"
 #include <sys/socket.h>
+#include <sys/sendfile.h>
+#include <sys/uio.h>
+#include <climits>
 #include <netinet/in.h>
 #include <netinet/tcp.h>
 #include <arpa/inet.h>
@@ -10,6 +14,7 @@
 #include <fcntl.h>
 #include <iostream>
 #include <sstream>
+#include <cstdio>
 #include <cstring>
 #include <chrono>
 #include <thread>
@@ -18,87 +23,396 @@
 #include <vector>
 #include <fstream>
 #include <regex>
+#include <optional>
 
-size_t load_max_connections_from_config() {
+//returns the raw value for a key in config.json; keys are unique across sections
+std::optional<std::string> find_config_value(const std::string& key) {
     std::ifstream config_file("config.json");
     if (!config_file.is_open()) {
-        std::cerr << "Warning: Could not open config.json, using default max_connections of 2000" << std::endl;
-        return 2000;
+        return std::nullopt;
     }
     
     std::string line;
-    std::regex max_conn_regex(R"("max_connections"\s*:\s*(\d+))");
+    std::regex value_regex("\"" + key + R"("\s*:\s*("[^"]*"|[^,\s}]+))");
     std::smatch match;
     
     while (std::getline(config_file, line)) {
-        if (std::regex_search(line, match, max_conn_regex)) {
-            try {
-                size_t max_connections = std::stoul(match[1].str());
-                if (max_connections > 0 && max_connections <= 100000) {
-                    std::cout << "Loaded max_connections from config.json: " << max_connections << std::endl;
-                    return max_connections;
-                } else {
-                    std::cerr << "Warning: Invalid max_connections value in config.json, using default of 2000" << std::endl;
-                    return 2000;
-                }
-            } catch (const std::exception&) {
-                std::cerr << "Warning: Could not parse max_connections from config.json, using default of 2000" << std::endl;
-                return 2000;
+        if (std::regex_search(line, match, value_regex)) {
+            std::string value = match[1].str();
+            if (value.size() >= 2 && value.front() == '"' && value.back() == '"') {
+                value = value.substr(1, value.size() - 2);
             }
+            return value;
+        }
+    }
+    
+    return std::nullopt;
+}
+
+size_t load_max_connections_from_config() {
+    auto value = find_config_value("max_connections");
+    if (!value) {
+        std::cerr << "Warning: max_connections not found in config.json, using default of 2000" << std::endl;
+        return 2000;
+    }
+    
+    try {
+        size_t max_connections = std::stoul(*value);
+        if (max_connections > 0 && max_connections <= 100000) {
+            std::cout << "Loaded max_connections from config.json: " << max_connections << std::endl;
+            return max_connections;
+        } else {
+            std::cerr << "Warning: Invalid max_connections value in config.json, using default of 2000" << std::endl;
+            return 2000;
         }
+    } catch (const std::exception&) {
+        std::cerr << "Warning: Could not parse max_connections from config.json, using default of 2000" << std::endl;
+        return 2000;
+    }
+}
+
+size_t load_reactor_count_from_config() {
+    auto value = find_config_value("reactor_count");
+    if (!value) {
+        return 1;
+    }
+    
+    try {
+        size_t reactor_count = std::stoul(*value);
+        if (reactor_count <= 256) {
+            return reactor_count;
+        }
+        std::cerr << "Warning: Invalid reactor_count value in config.json, using a single reactor" << std::endl;
+    } catch (const std::exception&) {
+        std::cerr << "Warning: Could not parse reactor_count from config.json, using a single reactor" << std::endl;
+    }
+    return 1;
+}
+
+DispatchMode load_dispatch_mode_from_config() {
+    auto value = find_config_value("run_to_completion");
+    if (!value || *value == "off") {
+        return DispatchMode::OFFLOAD;
+    }
+    if (*value == "cheap") {
+        return DispatchMode::INLINE_CHEAP;
+    }
+    if (*value == "all") {
+        return DispatchMode::INLINE_ALL;
+    }
+    
+    std::cerr << "Warning: Unknown run_to_completion mode '" << *value << "' in config.json, offloading all requests" << std::endl;
+    return DispatchMode::OFFLOAD;
+}
+
+bool load_edge_triggered_from_config() {
+    auto value = find_config_value("edge_triggered");
+    return value && *value == "true";
+}
+
+AcceptMode load_accept_mode_from_config() {
+    auto value = find_config_value("accept_mode");
+    if (!value || *value == "reuseport") {
+        return AcceptMode::REUSEPORT;
+    }
+    if (*value == "exclusive") {
+        return AcceptMode::EXCLUSIVE;
+    }
+    
+    std::cerr << "Warning: Unknown accept_mode '" << *value << "' in config.json, using reuseport" << std::endl;
+    return AcceptMode::REUSEPORT;
+}
+
+IoBackendType load_io_backend_from_config() {
+    auto value = find_config_value("io_backend");
+    if (!value || *value == "epoll") {
+        return IoBackendType::EPOLL;
+    }
+    if (*value == "io_uring") {
+        return IoBackendType::IO_URING;
+    }
+    
+    std::cerr << "Warning: Unknown io_backend '" << *value << "' in config.json, using epoll" << std::endl;
+    return IoBackendType::EPOLL;
+}
+
+size_t load_max_upload_size_from_config() {
+    auto value = find_config_value("max_upload_size");
+    if (!value) {
+        return 1024ull * 1024 * 1024;
+    }
+    
+    try {
+        return std::stoull(*value);
+    } catch (const std::exception&) {
+        std::cerr << "Warning: Could not parse max_upload_size from config.json, using 1GB" << std::endl;
+        return 1024ull * 1024 * 1024;
+    }
+}
+
+size_t load_max_file_size_from_config() {
+    auto value = find_config_value("max_file_size");
+    if (!value) {
+        return 0;
+    }
+    
+    try {
+        return std::stoull(*value);
+    } catch (const std::exception&) {
+        std::cerr << "Warning: Could not parse max_file_size from config.json, serving files of any size" << std::endl;
+        return 0;
+    }
+}
+
+bool load_gzip_from_config() {
+    auto value = find_config_value("gzip");
+    return !value || *value != "false";
+}
+
+EvictionPolicyType load_eviction_policy_from_config() {
+    auto value = find_config_value("eviction_policy");
+    if (!value) {
+        return EvictionPolicyType::LRU;
+    }
+    
+    auto policy = parse_eviction_policy(*value);
+    if (!policy) {
+        std::cerr << "Warning: Unknown eviction_policy '" << *value << "' in config.json, using lru" << std::endl;
+        return EvictionPolicyType::LRU;
+    }
+    return *policy;
+}
+
+std::string load_upload_temp_dir_from_config() {
+    auto value = find_config_value("upload_temp_dir");
+    return value && !value->empty() ? *value : "/tmp";
+}
+
+std::shared_ptr<Arena> Connection::request_arena() {
+    if (!arena) {
+        arena = std::make_shared<Arena>();
+    } else if (arena.use_count() == 1) {
+        //the last object using it is gone, whichever thread dropped it; the fence orders its
+        //accesses to the arena before ours
+        std::atomic_thread_fence(std::memory_order_acquire);
+        arena->reset();
+    } else if (arena->bytes_allocated() > MAX_ARENA_SIZE) {
+        return nullptr;
+    }
+    return arena;
+}
+
+void Connection::queue_response(HttpResponse response) {
+    response.serialize_headers(pending_response);
+    if (response.get_file_body()) {
+        pending_file = *response.get_file_body();
+    }
+    if (response.has_generated_body()) {
+        pending_generator = response.take_generated_body();
+    }
+    pending_messages.push_back({std::move(response), pending_response.size()});
+}
+
+void Connection::reject_upload(HttpStatus status) {
+    rejected_upload = status;
+    //the parser lets go of the upload before it is freed
+    parser.reset();
+    upload.reset();
+    buffer.clear();
+}
+
+std::optional<HttpResponse> Connection::take_rejection() {
+    if (!rejected_upload || rejection_answered || !waiting_requests.empty()) {
+        return std::nullopt;
+    }
+    rejection_answered = true;
+    keep_alive = false;
+    if (*rejected_upload == HttpStatus::CONTENT_TOO_LARGE) {
+        return HttpResponse::create_error_response(HttpStatus::CONTENT_TOO_LARGE, "Request body too large");
+    }
+    return HttpResponse::create_error_response(*rejected_upload, "Could not store request body");
+}
+
+void Connection::prepare_send() {
+    //pending_response and pending_messages may have moved while growing, so the
+    //iovecs are only built once everything is queued
+    pending_iov.clear();
+    iov_index = 0;
+    
+    size_t header_start = 0;
+    for (const auto& queued : pending_messages) {
+        pending_iov.push_back({&pending_response[header_start], queued.header_end - header_start});
+        queued.message.append_body_iovecs(pending_iov);
+        header_start = queued.header_end;
+    }
+}
+
+void Connection::advance_iov(size_t written) {
+    while (written > 0) {
+        iovec& entry = pending_iov[iov_index];
+        if (written < entry.iov_len) {
+            entry.iov_base = static_cast<char*>(entry.iov_base) + written;
+            entry.iov_len -= written;
+            break;
+        }
+        written -= entry.iov_len;
+        iov_index++;
+    }
+}
+
+void Connection::clear_pending_response() {
+    pending_response.clear();
+    pending_messages.clear();
+    pending_iov.clear();
+    iov_index = 0;
+    pending_file = FileRange{};
+    pending_generator = nullptr;
+    chunk_offset = chunk_end = 0;
+}
+
+void Connection::next_chunk() {
+    //room for the size line in front of the data and the CRLF behind it
+    constexpr size_t SIZE_LINE = 2 * sizeof(size_t) + 2;
+    generated_chunk.resize(SIZE_LINE + GENERATED_CHUNK_SIZE + 2);
+    
+    size_t length = pending_generator(&generated_chunk[SIZE_LINE], GENERATED_CHUNK_SIZE);
+    if (length == 0) {
+        pending_generator = nullptr;
+        generated_chunk.replace(0, 5, "0\r\n\r\n");
+        chunk_offset = 0;
+        chunk_end = 5;
+        return;
+    }
+    
+    char size_line[SIZE_LINE + 1];
+    int size_line_length = snprintf(size_line, sizeof(size_line), "%zx\r\n", length);
+    chunk_offset = SIZE_LINE - size_line_length;
+    memcpy(&generated_chunk[chunk_offset], size_line, size_line_length);
+    chunk_end = SIZE_LINE + length;
+    generated_chunk[chunk_end++] = '\r';
+    generated_chunk[chunk_end++] = '\n';
+}
+
+const std::shared_ptr<Connection> ConnectionTable::empty_;
+
+void ConnectionTable::preallocate(size_t count) {
+    free_.reserve(free_.size() + count);
+    while (free_.size() < count) {
+        free_.push_back(std::make_shared<Connection>(-1, nullptr, 0));
+    }
+}
+
+const std::shared_ptr<Connection>& ConnectionTable::insert(int fd, Reactor* owner) {
+    if (static_cast<size_t>(fd) >= slots_.size()) {
+        slots_.resize(std::max(slots_.size() * 2, static_cast<size_t>(fd) + 1));
+    }
+    
+    //any previous occupant was closed before the kernel handed out this fd again
+    Slot& slot = slots_[fd];
+    recycle(slot.conn);
+    slot.generation++;
+    
+    if (free_.empty()) {
+        slot.conn = std::make_shared<Connection>(fd, owner, slot.generation);
+    } else {
+        slot.conn = std::move(free_.back());
+        free_.pop_back();
+        slot.conn->reuse(fd, owner, slot.generation);
+    }
+    return slot.conn;
+}
+
+void ConnectionTable::release(int fd) {
+    recycle(slots_[fd].conn);
+}
+
+void ConnectionTable::recycle(std::shared_ptr<Connection>& conn) {
+    //only the table can hand out new references, so a sole owner stays the sole owner;
+    //connections a worker still holds are simply dropped and freed by the last user
+    if (conn && conn.use_count() == 1) {
+        free_.push_back(std::move(conn));
+    }
+    conn.reset();
+}
+
+const std::shared_ptr<Connection>& ConnectionTable::get(int fd, uint32_t generation) const {
+    if (fd < 0 || static_cast<size_t>(fd) >= slots_.size()) {
+        return empty_;
     }
     
-    std::cerr << "Warning: max_connections not found in config.json, using default of 2000" << std::endl;
-    return 2000;
+    const Slot& slot = slots_[fd];
+    return slot.generation == generation ? slot.conn : empty_;
 }
 
-Server::Server(int port, const std::string& host, size_t thread_count)
-    : server_fd_(-1), port_(port), host_(host), running_(false), 
-      max_connections_(load_max_connections_from_config()) {
+Server::Server(int port, const std::string& host, size_t thread_count, size_t reactor_count)
+    : port_(port), host_(host), running_(false), total_connections_(0),
+      max_connections_(load_max_connections_from_config()),
+      reactor_count_(reactor_count > 0 ? reactor_count : load_reactor_count_from_config()),
+      dispatch_mode_(load_dispatch_mode_from_config()),
+      edge_triggered_(load_edge_triggered_from_config()),
+      accept_mode_(load_accept_mode_from_config()),
+      io_backend_type_(load_io_backend_from_config()),
+      max_upload_size_(load_max_upload_size_from_config()),
+      upload_temp_dir_(load_upload_temp_dir_from_config()) {
     
-    epoll_ = std::make_unique<EpollWrapper>();
+    // 0 means one reactor per hardware thread
+    if (reactor_count_ == 0) {
+        reactor_count_ = std::max(1u, std::thread::hardware_concurrency());
+    }
+    
+    for (size_t i = 0; i < reactor_count_; ++i) {
+        reactors_.push_back(std::make_unique<Reactor>(i));
+    }
     thread_pool_ = std::make_unique<ThreadPool>(thread_count);
-    file_handler_ = std::make_unique<FileHandler>("./public", "index.html", true, 100);
+    file_handler_ = std::make_unique<FileHandler>("./public", "index.html", true, 100, load_eviction_policy_from_config());
+    file_handler_->enable_gzip(load_gzip_from_config());
+    file_handler_->set_max_file_size(load_max_file_size_from_config());
 }
 
 Server::~Server() {
     stop();
 }
 
-bool Server::start() {
-    server_fd_ = socket(AF_INET, SOCK_STREAM, 0);
-    if (server_fd_ == -1) {
+int Server::create_listen_socket() {
+    int listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (listen_fd == -1) {
         std::cerr << "Failed to create socket: " << strerror(errno) << std::endl;
-        return false;
+        return -1;
     }
     
-    if (!EpollWrapper::set_non_blocking(server_fd_)) {
-        close(server_fd_);
-        return false;
+    if (!EpollWrapper::set_non_blocking(listen_fd)) {
+        close(listen_fd);
+        return -1;
     }
     
     int opt = 1;
-    if (setsockopt(server_fd_, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) == -1) {
+    if (setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) == -1) {
         std::cerr << "Failed to set socket options: " << strerror(errno) << std::endl;
-        close(server_fd_);
-        return false;
+        close(listen_fd);
+        return -1;
     }
     
-    if (setsockopt(server_fd_, SOL_SOCKET, SO_REUSEPORT, &opt, sizeof(opt)) == -1) {
+    //every reactor binds its own socket to the same port, so this is required for more than one
+    if (setsockopt(listen_fd, SOL_SOCKET, SO_REUSEPORT, &opt, sizeof(opt)) == -1) {
+        if (reactor_count_ > 1 && accept_mode_ == AcceptMode::REUSEPORT) {
+            std::cerr << "Failed to set SO_REUSEPORT required by " << reactor_count_ << " reactors: " << strerror(errno) << std::endl;
+            close(listen_fd);
+            return -1;
+        }
         std::cerr << "Warning: Could not set SO_REUSEPORT: " << strerror(errno) << std::endl;
     }
     
-    // Set TCP_NODELAY to reduce latency
-    if (setsockopt(server_fd_, IPPROTO_TCP, TCP_NODELAY, &opt, sizeof(opt)) == -1) {
+    // Set TCP_NODELAY to reduce latency (accepted sockets inherit it, like the buffer sizes below)
+    if (setsockopt(listen_fd, IPPROTO_TCP, TCP_NODELAY, &opt, sizeof(opt)) == -1) {
         std::cerr << "Warning: Could not set TCP_NODELAY: " << strerror(errno) << std::endl;
     }
     
     //increase socket send/receive buffers for high throughput
     int buffer_size = 256 * 1024;
-    if (setsockopt(server_fd_, SOL_SOCKET, SO_SNDBUF, &buffer_size, sizeof(buffer_size)) == -1) {
+    if (setsockopt(listen_fd, SOL_SOCKET, SO_SNDBUF, &buffer_size, sizeof(buffer_size)) == -1) {
         std::cerr << "Warning: Could not set SO_SNDBUF: " << strerror(errno) << std::endl;
     }
-    if (setsockopt(server_fd_, SOL_SOCKET, SO_RCVBUF, &buffer_size, sizeof(buffer_size)) == -1) {
+    if (setsockopt(listen_fd, SOL_SOCKET, SO_RCVBUF, &buffer_size, sizeof(buffer_size)) == -1) {
         std::cerr << "Warning: Could not set SO_RCVBUF: " << strerror(errno) << std::endl;
     }
     
@@ -110,30 +424,60 @@ bool Server::start() {
     }
     address.sin_port = htons(port_);
     
-    if (bind(server_fd_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == -1) {
+    if (bind(listen_fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == -1) {
         std::cerr << "Failed to bind socket: " << strerror(errno) << std::endl;
-        close(server_fd_);
-        return false;
+        close(listen_fd);
+        return -1;
     }
     
-    if (listen(server_fd_, BACKLOG) == -1) {
+    if (listen(listen_fd, BACKLOG) == -1) {
         std::cerr << "Failed to listen on socket: " << strerror(errno) << std::endl;
-        close(server_fd_);
-        return false;
+        close(listen_fd);
+        return -1;
     }
     
-    if (!epoll_->init()) {
-        close(server_fd_);
-        return false;
+    return listen_fd;
+}
+
+bool Server::start() {
+    bool exclusive = accept_mode_ == AcceptMode::EXCLUSIVE && reactor_count_ > 1;
+    int shared_listen_fd = exclusive ? create_listen_socket() : -1;
+    
+    for (auto& reactor : reactors_) {
+        reactor->listen_fd = exclusive ? shared_listen_fd : create_listen_socket();
+        if (reactor->listen_fd != -1) {
+            reactor->io = IoBackend::create(io_backend_type_);
+        }
+        
+        bool ready = reactor->listen_fd != -1 && reactor->io && 
+                     reactor->io->add_listener(reactor->listen_fd, exclusive);
+        
+        if (!ready) {
+            close_listen_sockets();
+            return false;
+        }
+        
+        //accepting during a connection storm should not have to allocate
+        reactor->connections.preallocate(max_connections_ / reactor_count_);
     }
     
-    if (!epoll_->add_fd(server_fd_, EPOLLIN)) {
-        close(server_fd_);
-        return false;
+    //completions already deliver each read exactly once, epoll flags do not apply
+    if (edge_triggered_ && reactors_.front()->io->is_completion_based()) {
+        std::cout << "edge_triggered has no effect with the " << reactors_.front()->io->name() << " backend" << std::endl;
+        edge_triggered_ = false;
     }
     
     running_.store(true);
-    event_thread_ = std::make_unique<std::thread>(&Server::event_loop, this);
+    for (auto& reactor : reactors_) {
+        reactor->thread = std::make_unique<std::thread>(&Server::event_loop, this, reactor.get());
+    }
+    
+    if (exclusive) {
+        std::cout << "Started " << reactor_count_ << " reactors sharing one EPOLLEXCLUSIVE listener" << std::endl;
+    } else if (reactor_count_ > 1) {
+        std::cout << "Started " << reactor_count_ << " reactors with SO_REUSEPORT listeners" << std::endl;
+    }
+    std::cout << "I/O backend: " << reactors_.front()->io->name() << std::endl;
     
     return true;
 }
@@ -142,43 +486,72 @@ void Server::stop() {
     if (running_.load()) {
         running_.store(false);
         
+        //reactors may be blocked without a timeout when no idle deadline is pending
+        for (auto& reactor : reactors_) {
+            if (reactor->io) {
+                reactor->io->wakeup();
+            }
+        }
+        
         //first shutdown thread pool to prevent new tasks,
         if (thread_pool_) {
             thread_pool_->shutdown();
         }
         
-        //then join event thread
-        if (event_thread_ && event_thread_->joinable()) {
-            event_thread_->join();
+        //then join event threads
+        for (auto& reactor : reactors_) {
+            if (reactor->thread && reactor->thread->joinable()) {
+                reactor->thread->join();
+            }
         }
         
         //finally clean up connections (all threads are stopped)
-        {
-            std::lock_guard<std::mutex> lock(connections_mutex_);
-            for (auto& [fd, conn] : connections_) {
-                epoll_->remove_fd(fd);
-                close(fd);
+        for (auto& reactor : reactors_) {
+            if (!reactor->io) {
+                continue;
+            }
+            
+            reactor->connections.for_each([this](const std::shared_ptr<Connection>& conn) {
+                close_connection(*conn);
+            });
+            
+            if (reactor->listen_fd != -1) {
+                reactor->io->remove_fd(reactor->listen_fd);
             }
-            connections_.clear();
         }
         
-        if (server_fd_ != -1) {
-            epoll_->remove_fd(server_fd_);
-            close(server_fd_);
-            server_fd_ = -1;
+        close_listen_sockets();
+    }
+}
+
+void Server::close_listen_sockets() {
+    for (auto& reactor : reactors_) {
+        int listen_fd = reactor->listen_fd;
+        if (listen_fd == -1) {
+            continue;
+        }
+        
+        //in exclusive mode every reactor holds the same listener, close it once
+        for (auto& r : reactors_) {
+            if (r->listen_fd == listen_fd) {
+                r->listen_fd = -1;
+            }
         }
+        close(listen_fd);
     }
 }
 
-void Server::event_loop() {
-    std::vector<EpollWrapper::Event> events;
+void Server::event_loop(Reactor* reactor) {
+    std::vector<IoBackend::Event> events;
     
     while (running_.load()) {
-        int num_events = epoll_->wait_for_events(events, 1000);
+        //sleep until the earliest idle deadline, or until I/O arrives
+        int timeout_ms = reactor->idle_timers.next_timeout_ms(std::chrono::steady_clock::now());
+        int num_events = reactor->io->wait_for_events(events, timeout_ms);
         
         if (num_events == -1) {
             if (errno != EINTR) {
-                std::cerr << "epoll_wait error: " << strerror(errno) << std::endl;
+                std::cerr << reactor->io->name() << " wait error: " << strerror(errno) << std::endl;
             }
             continue;
         }
@@ -186,368 +559,657 @@ void Server::event_loop() {
         for (int i = 0; i < num_events; ++i) {
             const auto& event = events[i];
             
-            if (event.fd == server_fd_) {
-                if (event.events & EPOLLIN) {
-                    handle_accept();
+            if (event.fd == reactor->listen_fd) {
+                if (event.accepted_fd >= 0) {
+                    register_connection(*reactor, event.accepted_fd);
+                } else if (event.events & EPOLLIN) {
+                    handle_accept(*reactor);
                 }
             } else {
-                if (event.events & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
-                    handle_client_data(event.fd);
+                //empty when the socket was closed or its fd reused since the event was queued
+                const auto& conn = reactor->connections.get(event.fd, event.generation);
+                if (!conn) {
+                    continue;
                 }
-                if (event.events & EPOLLOUT) {
-                    handle_client_write(event.fd);
+                
+                if (event.payload) {
+                    handle_client_data(conn, event.payload, event.payload_size);
+                } else if (reactor->io->is_completion_based() && (event.events & (EPOLLERR | EPOLLRDHUP))) {
+                    //the backend already consumed the EOF or error on its own recv
+                    close_connection(*conn);
+                } else if (event.events & (EPOLLIN | EPOLLHUP | EPOLLERR | EPOLLRDHUP)) {
+                    handle_client_data(conn);
+                }
+                if (event.send_completed) {
+                    complete_send(conn, event.send_result);
+                } else if (event.events & EPOLLOUT) {
+                    send_response_async(conn);
                 }
             }
         }
         
-        cleanup_inactive_connections();
+        cleanup_inactive_connections(*reactor);
     }
 }
 
-void Server::handle_accept() {
-    while (true) {
-        sockaddr_in client_addr{};
-        socklen_t client_len = sizeof(client_addr);
-        
-        int client_fd = accept(server_fd_, reinterpret_cast<sockaddr*>(&client_addr), &client_len);
+void Server::handle_accept(Reactor& reactor) {
+    //bounded so one reactor cannot starve its clients, or the others sharing an exclusive
+    //listener, during a storm; the listener is level-triggered and reports the rest again
+    for (int accepted = 0; accepted < ACCEPT_BATCH; ++accepted) {
+        int client_fd = accept4(reactor.listen_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
         if (client_fd == -1) {
-            if (errno == EAGAIN || errno == EWOULDBLOCK) {
-                break;
-            }
-            std::cerr << "Failed to accept connection: " << strerror(errno) << std::endl;
-            continue;
-        }
-        
-        //check connection limit to prevent resource exhaustion
-        {
-            std::lock_guard<std::mutex> lock(connections_mutex_);
-            if (connections_.size() >= max_connections_) {
-                std::cerr << "[Accept] ERROR: Connection limit reached (" << connections_.size() << "/" << max_connections_ << "), rejecting fd=" << client_fd << std::endl;
-                close(client_fd);
+            if (errno == EINTR || errno == ECONNABORTED) {
                 continue;
             }
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                std::cerr << "Failed to accept connection: " << strerror(errno) << std::endl;
+            }
+            break;
         }
         
-        if (!EpollWrapper::set_non_blocking(client_fd)) {
-            close(client_fd);
-            continue;
-        }
-        
-        //set client socket options for better performance
-        int opt = 1;
-        if (setsockopt(client_fd, IPPROTO_TCP, TCP_NODELAY, &opt, sizeof(opt)) == -1) {
-            std::cerr << "Warning: Could not set TCP_NODELAY on client socket: " << strerror(errno) << std::endl;
-        }
-        
-        //set socket receive timeout to prevent hanging connections
-        struct timeval timeout = {30, 0}; // 30 seconds
-        if (setsockopt(client_fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout)) == -1) {
-            std::cerr << "Warning: Could not set SO_RCVTIMEO: " << strerror(errno) << std::endl;
-        }
-        
-        if (!epoll_->add_fd(client_fd, EPOLLIN | EPOLLHUP | EPOLLERR)) {
-            std::cerr << "Failed to add client_fd " << client_fd << " to epoll, closing connection" << std::endl;
-            close(client_fd);
-            continue;
-        }
-        
-        auto connection = std::make_shared<Connection>(client_fd);
-        {
-            std::lock_guard<std::mutex> lock(connections_mutex_);
-            connections_[client_fd] = connection;
-            // std::cerr << "[Accept] SUCCESS: fd=" << client_fd << " (total connections: " << connections_.size() << "/" << max_connections_ << ")" << std::endl;
-        }
+        register_connection(reactor, client_fd);
     }
 }
 
-void Server::handle_client_data(int client_fd) {
-    std::shared_ptr<Connection> conn;
-    bool connection_exists = false;
-    
-    {
-        std::lock_guard<std::mutex> lock(connections_mutex_);
-        auto it = connections_.find(client_fd);
-        if (it != connections_.end()) {
-            conn = it->second;
-            connection_exists = true;
-        }
-    }
-    
-    if (!connection_exists || !conn) {
+void Server::register_connection(Reactor& reactor, int client_fd) {
+    //check connection limit to prevent resource exhaustion (shared by all reactors)
+    size_t active_connections = total_connections_.load();
+    if (active_connections >= max_connections_) {
+        std::cerr << "[Accept] ERROR: Connection limit reached (" << active_connections << "/" << max_connections_ << "), rejecting fd=" << client_fd << std::endl;
+        close(client_fd);
         return;
     }
     
-    char buffer[BUFFER_SIZE];
-    ssize_t bytes_received = recv(client_fd, buffer, BUFFER_SIZE - 1, 0);
+    //accept4()/io_uring already made the socket non-blocking, TCP_NODELAY and the buffer
+    //sizes are inherited from the listener and idle sockets are closed by the timing wheel,
+    //so no per-socket syscalls are needed here
     
-    if (bytes_received <= 0) {
-        close_connection(client_fd);
-        return;
+    //the connection is in the table before the backend can report data for it
+    const auto& connection = reactor.connections.insert(client_fd, &reactor);
+    total_connections_.fetch_add(1);
+    reactor.idle_timers.schedule({client_fd, connection->generation},
+                                 connection->last_activity + std::chrono::seconds(CONNECTION_TIMEOUT_SECONDS));
+    // std::cerr << "[Accept] SUCCESS: fd=" << client_fd << " (reactor " << reactor.id << ", total connections: " << total_connections_.load() << "/" << max_connections_ << ")" << std::endl;
+    
+    if (!reactor.io->add_fd(client_fd, client_events(false), connection->generation)) {
+        std::cerr << "Failed to add client_fd " << client_fd << " to " << reactor.io->name() << ", closing connection" << std::endl;
+        close_connection(*connection);
     }
+}
+
+void Server::handle_client_data(const std::shared_ptr<Connection>& conn, const char* payload, size_t payload_size) {
+    Reactor& reactor = *conn->reactor;
+    int client_fd = conn->fd;
     
-    if (bytes_received > 0 && bytes_received <= BUFFER_SIZE - 1) {
-        bool should_process = false;
-        {
-            std::lock_guard<std::mutex> conn_lock(conn->mutex_);
-            {
-                std::lock_guard<std::mutex> map_lock(connections_mutex_);
-                if (connections_.find(client_fd) == connections_.end()) {
-                    return;
+    bool should_process = false;
+    bool should_close = false;
+    {
+        std::lock_guard<std::mutex> conn_lock(conn->mutex_);
+        if (conn->closed) {
+            return;
+        }
+        
+        if (payload) {
+            //completion backends have already received the bytes for us
+            conn->buffer.append(payload, payload_size);
+            should_close = !stream_upload(*conn);
+        }
+        
+        //level-triggered reads once per wakeup, edge-triggered drains the socket until EAGAIN
+        while (!payload) {
+            size_t old_size = conn->buffer.size();
+            conn->buffer.resize(old_size + BUFFER_SIZE);
+            ssize_t bytes_received = recv(client_fd, &conn->buffer[old_size], BUFFER_SIZE, 0);
+            conn->buffer.resize(old_size + (bytes_received > 0 ? bytes_received : 0));
+            
+            if (bytes_received > 0) {
+                if (!stream_upload(*conn)) {
+                    should_close = true;
+                    break;
                 }
+                if (!edge_triggered_) {
+                    //anything left in the socket raises the next level-triggered event
+                    break;
+                }
+                continue;
             }
             
-            if (conn->buffer.size() + bytes_received > MAX_REQUEST_SIZE) {
-                std::cerr << "Request too large, closing connection fd=" << client_fd << std::endl;
-                {
-                    std::lock_guard<std::mutex> map_lock2(connections_mutex_);
-                    if (connections_.find(client_fd) != connections_.end()) {
-                        connections_.erase(client_fd);
-                    }
-                }
-                epoll_->remove_fd(client_fd);
-                close(client_fd);
-                return;
+            if (bytes_received == -1 && errno == EINTR) {
+                continue;
+            }
+            if (bytes_received == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                break;
             }
             
-            conn->buffer.append(buffer, bytes_received);
+            //orderly shutdown by the peer or a socket error
+            should_close = true;
+            break;
+        }
+        
+        if (!should_close) {
             conn->last_activity = std::chrono::steady_clock::now();
             
-            should_process = !conn->processing_request && is_http_request_complete(conn->buffer);
+            should_process = !conn->processing_request && !conn->has_pending_write && 
+                             conn->request_ready();
             if (should_process) {
                 conn->processing_request = true;
+            } else if (edge_triggered_) {
+                //oneshot: the fd stays disarmed until we ask for the next event; re-armed
+                //under the lock so a concurrent close cannot slip in between
+                reactor.io->modify_fd(client_fd, client_events(conn->has_pending_write), conn->generation);
             }
         }
-        
-        if (should_process) {
-            thread_pool_->enqueue(&Server::handle_client_request, this, conn);
-        }
-    } else {
-        std::cerr << "Invalid bytes_received: " << bytes_received << std::endl;
-        close_connection(client_fd);
+    }
+    
+    if (should_close) {
+        close_connection(*conn);
         return;
     }
+    
+    if (should_process) {
+        dispatch_request(conn);
+    }
 }
 
-void Server::handle_client_request(std::shared_ptr<Connection> conn) {
+uint32_t Server::client_events(bool want_write) const {
+    if (edge_triggered_) {
+        //one event per arming so a connection is never handled by two threads at once
+        return (want_write ? EPOLLOUT : EPOLLIN) | EPOLLRDHUP | EPOLLET | EPOLLONESHOT;
+    }
+    return want_write ? (EPOLLIN | EPOLLOUT | EPOLLHUP | EPOLLERR) : (EPOLLIN | EPOLLHUP | EPOLLERR);
+}
+
+void Server::offload_request(std::shared_ptr<Connection> conn, HttpRequest request) {
+    //moved into the task; std::bind would hand the handler a copy, which leaves the arena
+    thread_pool_->enqueue([this, conn = std::move(conn), request = std::move(request)]() mutable {
+        handle_parsed_request(conn, request);
+    });
+}
+
+void Server::handle_parsed_request(std::shared_ptr<Connection> conn, HttpRequest& request) {
     if (!conn) return;
     
-    HttpRequest request;
-    {
-        std::lock_guard<std::mutex> conn_lock(conn->mutex_);
-        request = HttpRequest::parse(conn->buffer);
+    //this worker handles the connection's request now, so the arena is its to allocate from
+    ArenaScope arena_scope(conn->arena);
+    HttpResponse response = build_response(request);
+    finish_request(conn, std::move(request), std::move(response), true);
+}
+
+HttpRequest Server::take_request(Connection& conn) {
+    if (!conn.waiting_requests.empty()) {
+        HttpRequest request = std::move(conn.waiting_requests.front());
+        conn.waiting_requests.pop_front();
+        return request;
+    }
+    return take_parsed_request(conn);
+}
+
+HttpRequest Server::take_parsed_request(Connection& conn) {
+    //the parser already holds the request, this only picks up views moved by a reallocation.
+    //exactly one request is consumed, pipelined bytes behind it stay in the buffer
+    if (conn.parser.parse(conn.buffer) != ParseStatus::COMPLETE) {
+        //the stream cannot be framed past this point, answer it and close
+        conn.buffer.clear();
+        conn.parser.reset();
+        conn.upload.reset();
+        conn.keep_alive = false;
+        return HttpRequest();
+    }
+    
+    //copied out before the bytes the views point into are dropped
+    HttpRequest request = HttpRequest::from_view(conn.parser.request());
+    conn.buffer.erase(0, conn.parser.consumed());
+    conn.parser.reset();
+    if (conn.upload) {
+        request.set_streamed_body(*conn.upload);
+        conn.upload.reset();
+    }
+    return request;
+}
+
+bool Server::stream_upload(Connection& conn) {
+    //the rest of a refused request is dropped until its answer is out and the connection closes
+    if (conn.rejected_upload) {
+        conn.buffer.clear();
+        return true;
+    }
+    
+    //complete requests still waiting for their turn make room for what follows them
+    while (conn.buffer.size() > MAX_REQUEST_SIZE && conn.waiting_requests.size() < Connection::MAX_PIPELINED_RESPONSES &&
+           conn.parser.parse(conn.buffer) == ParseStatus::COMPLETE) {
+        conn.waiting_requests.push_back(take_parsed_request(conn));
     }
     
+    //a body declared larger than allowed is refused before any of it is read
+    if (!conn.upload && conn.parser.parse(conn.buffer) == ParseStatus::INCOMPLETE && conn.parser.receiving_body() &&
+        conn.parser.request().content_length > max_upload_size_) {
+        std::cerr << "Upload of " << conn.parser.request().content_length << " bytes refused on fd=" << conn.fd << std::endl;
+        conn.reject_upload(HttpStatus::CONTENT_TOO_LARGE);
+        return true;
+    }
+    
+    //a body that would outgrow the receive buffer is streamed into a SpooledBody from
+    //here on; only the head in front of it stays buffered
+    if (!conn.upload && conn.buffer.size() > MAX_REQUEST_SIZE) {
+        conn.parser.parse(conn.buffer);
+        if (conn.parser.receiving_body()) {
+            conn.upload = std::make_unique<SpooledBody>(UPLOAD_MEMORY_LIMIT, max_upload_size_, upload_temp_dir_);
+            conn.parser.stream_body(conn.upload.get());
+        }
+    }
+    
+    if (conn.upload && conn.parser.receiving_body()) {
+        conn.parser.parse(conn.buffer);
+        conn.parser.discard_streamed(conn.buffer);
+    }
+    
+    if (conn.upload && !conn.upload->error().empty()) {
+        std::cerr << "Upload failed on fd=" << conn.fd << ": " << conn.upload->error() << std::endl;
+        conn.reject_upload(conn.upload->too_large() ? HttpStatus::CONTENT_TOO_LARGE : HttpStatus::INTERNAL_SERVER_ERROR);
+        return true;
+    }
+    if (conn.buffer.size() > MAX_REQUEST_SIZE) {
+        std::cerr << "Request too large, closing connection fd=" << conn.fd << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void Server::dispatch_request(std::shared_ptr<Connection> conn) {
+    //taken right away, so the parser can move on to whatever follows, e.g. stream an upload.
+    //the request and, when built here, its response allocate from the connection's arena
+    std::unique_lock<std::mutex> conn_lock(conn->mutex_);
+    ArenaScope arena_scope(conn->request_arena());
+    if (auto rejection = conn->take_rejection()) {
+        conn_lock.unlock();
+        finish_request(conn, HttpRequest(), std::move(*rejection), false);
+        return;
+    }
+    HttpRequest request = take_request(*conn);
+    conn_lock.unlock();
+    
+    if (dispatch_mode_ == DispatchMode::OFFLOAD) {
+        offload_request(conn, std::move(request));
+        return;
+    }
+    
+    std::optional<HttpResponse> response;
+    if (dispatch_mode_ == DispatchMode::INLINE_ALL) {
+        response = build_response(request);
+    } else {
+        response = try_build_response_inline(request);
+    }
+    
+    if (response) {
+        //run to completion on the reactor thread, no hand-off to the pool
+        finish_request(conn, std::move(request), std::move(*response), false);
+    } else {
+        offload_request(conn, std::move(request));
+    }
+}
+
+HttpResponse Server::build_response(const HttpRequest& request) {
     HttpResponse response;
     
     if (!request.is_valid()) {
         #ifdef DEBUG_INVALID_REQUESTS
-        std::cerr << "[Request] fd=" << conn->fd << " ERROR: Invalid HTTP request" << std::endl;
+        std::cerr << "[Request] ERROR: Invalid HTTP request" << std::endl;
         #endif
         response = HttpResponse::create_error_response(HttpStatus::BAD_REQUEST, "Invalid HTTP request");
+    } else if (request.get_method() == HttpMethod::GET || request.get_method() == HttpMethod::HEAD) {
+        // std::cerr << "[Request] " << HttpRequest::method_to_string(request.get_method()) << " " << request.get_path() << std::endl;
+        std::string_view path = request.get_path();
+        
+        if (path.find("/api/") == 0) {
+            response = handle_api_request(request);
+        } else {
+            response = file_handler_->handle_file_request(request);
+        }
+        
+        if (request.get_method() == HttpMethod::HEAD) {
+            response.omit_body();
+        }
+    } else if ((request.get_method() == HttpMethod::POST || request.get_method() == HttpMethod::PUT) &&
+               request.get_path().find("/api/") == 0) {
+        response = handle_api_request(request);
     } else {
-        // std::cerr << "[Request] fd=" << conn->fd << " " << HttpRequest::method_to_string(request.get_method()) << " " << request.get_path() << std::endl;
+        response = HttpResponse::create_error_response(HttpStatus::METHOD_NOT_ALLOWED, "Method not supported");
+    }
+    
+    return response;
+}
+
+std::optional<HttpResponse> Server::try_build_response_inline(const HttpRequest& request) {
+    //error responses and API routes are built from memory and never block
+    if (!request.is_valid() || 
+        (request.get_method() != HttpMethod::GET && request.get_method() != HttpMethod::HEAD) ||
+        request.get_path().find("/api/") == 0) {
+        return build_response(request);
+    }
+    
+    //static files only when already cached, anything else may touch the disk
+    auto response = file_handler_->get_cached_response(request);
+    if (response && request.get_method() == HttpMethod::HEAD) {
+        response->omit_body();
+    }
+    return response;
+}
+
+void Server::finish_request(std::shared_ptr<Connection> conn, HttpRequest request, HttpResponse response, bool on_worker) {
+    //pipelined requests already buffered are answered right here while that needs no blocking
+    //I/O, so their responses are queued behind this one and leave in a single write
+    while (true) {
         {
             std::lock_guard<std::mutex> conn_lock(conn->mutex_);
-            conn->keep_alive = request.is_keep_alive();
-        }
-        
-        if (request.get_method() == HttpMethod::GET || request.get_method() == HttpMethod::HEAD) {
-            std::string path = request.get_path();
+            if (conn->closed) {
+                conn->processing_request = false;
+                return;
+            }
             
-            if (path.find("/api/") == 0) {
-                response = handle_api_request(request);
-            } else {
-                response = file_handler_->handle_file_request(path);
+            if (request.is_valid()) {
+                conn->keep_alive = request.is_keep_alive();
             }
+            response.set_keep_alive(conn->keep_alive);
+            // std::cerr << "[Response] fd=" << conn->fd << " Status=" << static_cast<int>(response.get_status()) << " Size=" << response.get_body_size() << "B" << std::endl;
             
-            if (request.get_method() == HttpMethod::HEAD) {
-                response.set_body("");
+            conn->queue_response(std::move(response));
+            conn->last_activity = std::chrono::steady_clock::now();
+            
+            if (!conn->keep_alive || !conn->can_queue_response() || !conn->request_ready()) {
+                break;
             }
+            if (auto rejection = conn->take_rejection()) {
+                request = HttpRequest();
+                response = std::move(*rejection);
+                continue;
+            }
+            request = take_request(*conn);
+        }
+        
+        //built without the lock, the reactor keeps reading into the buffer meanwhile
+        std::optional<HttpResponse> next_response;
+        if (on_worker || dispatch_mode_ == DispatchMode::INLINE_ALL) {
+            next_response = build_response(request);
         } else {
-            response = HttpResponse::create_error_response(HttpStatus::METHOD_NOT_ALLOWED, "Method not supported");
+            next_response = try_build_response_inline(request);
         }
-    }
-    
-    response.set_keep_alive(conn->keep_alive);
-    // std::cerr << "[Response] fd=" << conn->fd << " Status=" << static_cast<int>(response.get_status()) << " Size=" << response.get_body().size() << "B" << std::endl;
-    
-    {
-        std::lock_guard<std::mutex> lock(connections_mutex_);
-        if (connections_.find(conn->fd) == connections_.end()) {
-            {
-                std::lock_guard<std::mutex> conn_lock(conn->mutex_);
-                conn->processing_request = false;
-            }
-            return;
+        
+        if (!next_response) {
+            //needs a worker; it is handed over once everything queued has been sent
+            std::lock_guard<std::mutex> conn_lock(conn->mutex_);
+            conn->deferred_request = std::move(request);
+            break;
         }
+        response = std::move(*next_response);
     }
     
     {
         std::lock_guard<std::mutex> conn_lock(conn->mutex_);
-        conn->pending_response = response.to_string();
-        conn->response_offset = 0;
+        if (conn->closed) {
+            conn->processing_request = false;
+            return;
+        }
+        conn->prepare_send();
         conn->has_pending_write = true;
+        conn->processing_request = false;
     }
     
     send_response_async(conn);
-    
-    {
-        std::lock_guard<std::mutex> conn_lock(conn->mutex_);
-        conn->buffer.clear();
-        conn->processing_request = false;
-        conn->last_activity = std::chrono::steady_clock::now();
-    }
 }
 
 void Server::send_response_async(std::shared_ptr<Connection> conn) {
     if (!conn) return;
     
+    Reactor& reactor = *conn->reactor;
     std::unique_lock<std::mutex> conn_lock(conn->mutex_);
     
     if (!conn->has_pending_write) {
         return; //Oops nothing to send
     }
+    if (conn->send_in_flight) {
+        return; //complete_send() picks up once the backend reports it
+    }
     
-    const std::string& response = conn->pending_response;
-    size_t remaining = response.length() - conn->response_offset;
+    std::vector<iovec>& iov = conn->pending_iov;
+    FileRange& file = conn->pending_file;
     
-    if (remaining == 0) {
-        conn->has_pending_write = false;
-        conn->pending_response.clear();
-        conn->response_offset = 0;
-        
-        epoll_->modify_fd(conn->fd, EPOLLIN | EPOLLHUP | EPOLLERR);
+    // lets send as much as possible, until the socket buffer is full
+    while (conn->iov_index < iov.size() || file.length > 0 || conn->generating()) {
+        ssize_t sent;
+        if (conn->iov_index < iov.size()) {
+            size_t count = std::min<size_t>(iov.size() - conn->iov_index, IOV_MAX);
+            bool more = conn->iov_index + count < iov.size() || file.length > 0 || conn->pending_generator;
+            
+            msghdr& message = conn->send_message;
+            message = msghdr{};
+            message.msg_iov = &iov[conn->iov_index];
+            message.msg_iovlen = count;
+            //headers ahead of a file body go out together with its first bytes
+            int flags = MSG_NOSIGNAL | (more ? MSG_MORE : 0);
+            //completion backends take the write into the reactor's next submission batch
+            if (reactor.io->submit_send(conn->fd, &message, flags, conn->generation, conn)) {
+                conn->send_in_flight = true;
+                return;
+            }
+            sent = sendmsg(conn->fd, &message, flags);
+            if (sent > 0) {
+                conn->advance_iov(static_cast<size_t>(sent));
+                continue;
+            }
+        } else if (file.length == 0) {
+            //a generated body is produced one chunk at a time, each once the last is out
+            if (conn->chunk_offset == conn->chunk_end) {
+                conn->next_chunk();
+            }
+            conn->chunk_iov = {&conn->generated_chunk[conn->chunk_offset], conn->chunk_end - conn->chunk_offset};
+            msghdr& message = conn->send_message;
+            message = msghdr{};
+            message.msg_iov = &conn->chunk_iov;
+            message.msg_iovlen = 1;
+            int flags = MSG_NOSIGNAL | (conn->pending_generator ? MSG_MORE : 0);
+            if (reactor.io->submit_send(conn->fd, &message, flags, conn->generation, conn)) {
+                conn->send_in_flight = true;
+                return;
+            }
+            sent = sendmsg(conn->fd, &message, flags);
+            if (sent > 0) {
+                conn->chunk_offset += sent;
+                continue;
+            }
+        } else {
+            //sendfile() advances file.offset itself
+            size_t chunk = std::min(file.length, MAX_SENDFILE_CHUNK);
+            sent = sendfile(conn->fd, file.file->fd(), &file.offset, chunk);
+            if (sent > 0) {
+                file.length -= sent;
+                continue;
+            }
+            if (sent == 0) {
+                //the file shrank under us, the promised Content-Length can no longer be met
+                std::cerr << "[Send] fd=" << conn->fd << " ERROR: File truncated while sending" << std::endl;
+                errno = EIO;
+                sent = -1;
+            }
+        }
         
-        if (!conn->keep_alive) {
-            conn_lock.unlock();
-            close_connection(conn->fd);
+        if (sent == -1 && errno == EINTR) {
+            continue;
         }
-        return;
-    }
-    
-    // lets try to send as much as possible
-    ssize_t sent = send(conn->fd, response.c_str() + conn->response_offset, remaining, MSG_NOSIGNAL);
-    
-    if (sent == -1) {
-        if (errno == EAGAIN || errno == EWOULDBLOCK) {
-            epoll_->modify_fd(conn->fd, EPOLLIN | EPOLLOUT | EPOLLHUP | EPOLLERR);
+        
+        if (sent == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            // Still have data to send, wait for EPOLLOUT
+            reactor.io->modify_fd(conn->fd, client_events(true), conn->generation);
             return;
-        } else if (errno == EPIPE || errno == ECONNRESET) {
+        }
+        
+        if (sent == -1 && (errno == EPIPE || errno == ECONNRESET)) {
             std::cerr << "[Send] fd=" << conn->fd << " ERROR: Connection closed by peer (" << strerror(errno) << ")" << std::endl;
-            conn->keep_alive = false;
-            conn->has_pending_write = false;
-            conn_lock.unlock();
-            close_connection(conn->fd);
-            return;
-        } else {
-            conn->keep_alive = false;
-            conn->has_pending_write = false;
-            conn_lock.unlock();
-            close_connection(conn->fd);
-            return;
         }
-    } else if (sent == 0) {
         conn->keep_alive = false;
         conn->has_pending_write = false;
         conn_lock.unlock();
-        close_connection(conn->fd);
+        close_connection(*conn);
         return;
-    } else {
-        conn->response_offset += sent;
-        
-        if (conn->response_offset >= response.length()) {
-            conn->has_pending_write = false;
-            conn->pending_response.clear();
-            conn->response_offset = 0;
-            
-            // Remove EPOLLOUT from events
-            epoll_->modify_fd(conn->fd, EPOLLIN | EPOLLHUP | EPOLLERR);
-            
-            if (!conn->keep_alive) {
-                conn_lock.unlock();
-                close_connection(conn->fd);
-            }
-        } else {
-            // Still have data to send, ensure EPOLLOUT is monitored
-            epoll_->modify_fd(conn->fd, EPOLLIN | EPOLLOUT | EPOLLHUP | EPOLLERR);
-        }
+    }
+    
+    conn->has_pending_write = false;
+    conn->clear_pending_response();
+    
+    if (!conn->keep_alive) {
+        conn_lock.unlock();
+        close_connection(*conn);
+        return;
+    }
+    
+    //a request that arrived while this response was in flight is handled right away
+    std::optional<HttpRequest> deferred = std::move(conn->deferred_request);
+    conn->deferred_request.reset();
+    bool next_ready = !conn->processing_request && 
+                      (deferred || conn->request_ready());
+    if (next_ready) {
+        conn->processing_request = true;
+    }
+    
+    // Remove EPOLLOUT from events (edge-triggered re-arms once the next request is answered)
+    if (!next_ready || !edge_triggered_) {
+        reactor.io->modify_fd(conn->fd, client_events(false), conn->generation);
+    }
+    conn_lock.unlock();
+    
+    if (next_ready && deferred) {
+        offload_request(conn, std::move(*deferred));
+    } else if (next_ready) {
+        dispatch_request(conn);
     }
 }
 
-void Server::handle_client_write(int client_fd) {
-    std::shared_ptr<Connection> conn;
-    
+void Server::complete_send(const std::shared_ptr<Connection>& conn, int result) {
     {
-        std::lock_guard<std::mutex> lock(connections_mutex_);
-        auto it = connections_.find(client_fd);
-        if (it == connections_.end()) {
+        std::unique_lock<std::mutex> conn_lock(conn->mutex_);
+        conn->send_in_flight = false;
+        if (conn->closed || !conn->has_pending_write) {
+            return;
+        }
+        
+        if (result > 0) {
+            if (conn->iov_index < conn->pending_iov.size()) {
+                conn->advance_iov(static_cast<size_t>(result));
+            } else {
+                conn->chunk_offset += result;
+            }
+        } else if (result == -EAGAIN) {
+            //the socket buffer is full, the rest is submitted once it drains
+            conn->reactor->io->modify_fd(conn->fd, client_events(true), conn->generation);
+            return;
+        } else if (result != -EINTR) {
+            if (result == -EPIPE || result == -ECONNRESET) {
+                std::cerr << "[Send] fd=" << conn->fd << " ERROR: Connection closed by peer (" << strerror(-result) << ")" << std::endl;
+            }
+            conn->keep_alive = false;
+            conn->has_pending_write = false;
+            conn_lock.unlock();
+            close_connection(*conn);
             return;
         }
-        conn = it->second;
     }
     
     send_response_async(conn);
 }
 
-void Server::close_connection(int client_fd) {
-    std::unique_lock<std::mutex> lock(connections_mutex_);
-    
-    auto it = connections_.find(client_fd);
-    if (it == connections_.end()) {
+void Server::close_connection(Connection& conn) {
+    std::lock_guard<std::mutex> conn_lock(conn.mutex_);
+    if (conn.closed) {
         return; // Already closed
     }
     
-    auto conn = it->second;
-    
-    bool has_pending_write = false;
-    {
-        std::lock_guard<std::mutex> conn_lock(conn->mutex_);
-        has_pending_write = conn->has_pending_write;
-    }
-    
-    if (has_pending_write) {
-        // Connection closed with pending write - silent handling
+    //the fd number may be reused as soon as it is closed, so nothing may touch it afterwards;
+    //the reactor releases the table slot on its next sweep
+    conn.closed = true;
+    conn.has_pending_write = false;
+    if (!conn.send_in_flight) {
+        //otherwise the kernel still reads them; they go when the backend lets go of the connection
+        conn.clear_pending_response();
     }
+    conn.deferred_request.reset();
+    conn.parser.reset();
+    conn.upload.reset();
+    conn.waiting_requests.clear();
+    total_connections_.fetch_sub(1);
     
-    connections_.erase(it);
-    lock.unlock();
-    
-    epoll_->remove_fd(client_fd);
+    conn.reactor->io->remove_fd(conn.fd);
     
     // Close the socket
-    if (close(client_fd) == -1 && errno != EBADF) {
-        std::cerr << "Warning: Error closing fd " << client_fd << ": " << strerror(errno) << std::endl;
+    if (close(conn.fd) == -1 && errno != EBADF) {
+        std::cerr << "Warning: Error closing fd " << conn.fd << ": " << strerror(errno) << std::endl;
     }
 }
 
-void Server::cleanup_inactive_connections() {
+void Server::cleanup_inactive_connections(Reactor& reactor) {
     auto now = std::chrono::steady_clock::now();
-    std::vector<int> inactive_fds;
+    std::vector<TimerWheel::Timer> expired;
+    reactor.idle_timers.advance(now, expired);
     
-    {
-        std::lock_guard<std::mutex> lock(connections_mutex_);
-        for (const auto& [fd, conn] : connections_) {
-            auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(now - conn->last_activity);
-            
-            bool has_pending_write = false;
-            {
-                std::lock_guard<std::mutex> conn_lock(conn->mutex_);
-                has_pending_write = conn->has_pending_write;
-            }
-            
-            if (elapsed.count() > CONNECTION_TIMEOUT_SECONDS && !has_pending_write) {
-                inactive_fds.push_back(fd);
+    for (const auto& timer : expired) {
+        //the timer may belong to a connection that is gone or whose fd has been reused
+        const auto& conn = reactor.connections.get(timer.fd, timer.generation);
+        if (!conn) {
+            continue;
+        }
+        
+        bool expired_now = false;
+        {
+            std::lock_guard<std::mutex> conn_lock(conn->mutex_);
+            if (!conn->closed) {
+                //activity only moves last_activity, so push the timer to the real deadline
+                auto deadline = conn->last_activity + std::chrono::seconds(CONNECTION_TIMEOUT_SECONDS);
+                if (conn->has_pending_write) {
+                    deadline = now + std::chrono::seconds(CONNECTION_TIMEOUT_SECONDS);
+                }
+                if (deadline > now) {
+                    reactor.idle_timers.schedule(timer, deadline);
+                    continue;
+                }
+                expired_now = true;
             }
         }
+        
+        if (expired_now) {
+            close_connection(*conn);
+        }
+        
+        //closed by us or by a worker, either way the slot can go now
+        reactor.connections.release(timer.fd);
     }
-    
-    for (int fd : inactive_fds) {
-        close_connection(fd);
-    }
+}
+
+size_t Server::get_connection_count() const {
+    return total_connections_.load();
 }
 
 HttpResponse Server::handle_api_request(const HttpRequest& request) {
-    std::string path = request.get_path();
+    std::string_view path = request.get_path();
+    
+    if (path == "/api/upload") {
+        if (request.get_method() != HttpMethod::POST && request.get_method() != HttpMethod::PUT) {
+            return HttpResponse::create_error_response(HttpStatus::METHOD_NOT_ALLOWED, "Upload with POST or PUT");
+        }
+        
+        //the body is already complete here, in memory or in a temporary file
+        std::ostringstream body;
+        body << "{\n";
+        body << "  \"received_bytes\": " << request.get_body_size() << ",\n";
+        body << "  \"spooled_to_disk\": " << (request.get_body_file() ? "true" : "false") << "\n";
+        body << "}\n";
+        
+        HttpResponse response(HttpStatus::OK);
+        response.set_body(body.str());
+        response.set_content_type("application/json");
+        return response;
+    }
+    
+    if (request.get_method() != HttpMethod::GET && request.get_method() != HttpMethod::HEAD) {
+        return HttpResponse::create_error_response(HttpStatus::METHOD_NOT_ALLOWED, "Method not supported");
+    }
     
     if (path == "/api/info" || path == "/api/status") {
         auto now = std::chrono::system_clock::now();
@@ -562,7 +1224,8 @@ HttpResponse Server::handle_api_request(const HttpRequest& request) {
         body << "  \"timestamp\": \"" << std::ctime(&time_t) << "\",\n";
         body << "  \"thread_pool_size\": " << thread_pool_->get_thread_count() << ",\n";
         body << "  \"queue_size\": " << thread_pool_->get_queue_size() << ",\n";
-        body << "  \"active_connections\": " << connections_.size() << ",\n";
+        body << "  \"reactors\": " << reactor_count_ << ",\n";
+        body << "  \"active_connections\": " << get_connection_count() << ",\n";
         body << "  \"document_root\": \"" << file_handler_->get_document_root() << "\",\n";
         body << "  \"architecture\": \"epoll + thread_pool + lru_cache\",\n";
         body << "  \"http_version\": \"HTTP/1.1\",\n";
@@ -587,58 +1250,6 @@ HttpResponse Server::handle_api_request(const HttpRequest& request) {
     return HttpResponse::create_error_response(HttpStatus::NOT_FOUND, "API endpoint not found");
 }
 
-bool Server::is_http_request_complete(const std::string& buffer) {
-    size_t header_end = buffer.find("\r\n\r\n");
-    if (header_end == std::string::npos) {
-        return false;
-    }
-    
-    std::string headers = buffer.substr(0, header_end);
-    std::istringstream header_stream(headers);
-    std::string line;
-    size_t content_length = 0;
-    bool has_content_length = false;
-    
-    std::getline(header_stream, line);
-    
-    while (std::getline(header_stream, line) && !line.empty()) {
-        if (!line.empty() && line.back() == '\r') {
-            line.pop_back();
-        }
-        
-        size_t colon_pos = line.find(':');
-        if (colon_pos != std::string::npos) {
-            std::string name = line.substr(0, colon_pos);
-            std::string value = line.substr(colon_pos + 1);
-            
-            name.erase(name.find_last_not_of(" \t") + 1);
-            value.erase(0, value.find_first_not_of(" \t"));
-            value.erase(value.find_last_not_of(" \t") + 1);
-            
-            std::transform(name.begin(), name.end(), name.begin(), ::tolower);
-            
-            if (name == "content-length") {
-                try {
-                    content_length = std::stoull(value);
-                    has_content_length = true;
-                } catch (const std::exception&) {
-                    content_length = 0;
-                }
-                break;
-            }
-        }
-    }
-    
-    //calculate expected total size
-    size_t expected_size = header_end + 4; // +4 for "\r\n\r\n"
-    if (has_content_length) {
-        expected_size += content_length;
-    }
-    
-    //finally check if we have all data
-    return buffer.size() >= expected_size;
-}
-
 bool Server::is_likely_http_request(const std::string& buffer) {
     if (buffer.empty()) return false;
     
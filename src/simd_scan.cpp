@@ -0,0 +1,267 @@
+#include "simd_scan.h"
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define SIMD_SCAN_X86 1
+#endif
+
+namespace {
+
+struct ScanKernels {
+    size_t (*scan_for_either)(const char*, size_t, char, char);
+    size_t (*find_header_end)(const char*, size_t);
+    bool (*has_non_printable)(const char*, size_t);
+};
+
+bool header_end_at(const char* data, size_t size, size_t pos) {
+    return pos + 4 <= size && std::memcmp(data + pos, "\r\n\r\n", 4) == 0;
+}
+
+size_t scan_for_either_scalar(const char* data, size_t size, char a, char b) {
+    for (size_t i = 0; i < size; ++i) {
+        if (data[i] == a || data[i] == b) {
+            return i;
+        }
+    }
+    return size;
+}
+
+size_t find_header_end_scalar(const char* data, size_t size) {
+    for (size_t i = 0; i + 4 <= size; ++i) {
+        if (header_end_at(data, size, i)) {
+            return i + 4;
+        }
+    }
+    return 0;
+}
+
+bool has_non_printable_scalar(const char* data, size_t size) {
+    for (size_t i = 0; i < size; ++i) {
+        unsigned char c = static_cast<unsigned char>(data[i]);
+        if (c < 0x20 || c >= 0x7F) {
+            return true;
+        }
+    }
+    return false;
+}
+
+#ifdef SIMD_SCAN_X86
+
+__attribute__((target("sse2")))
+size_t scan_for_either_sse2(const char* data, size_t size, char a, char b) {
+    const __m128i va = _mm_set1_epi8(a);
+    const __m128i vb = _mm_set1_epi8(b);
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        int mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(chunk, va), _mm_cmpeq_epi8(chunk, vb)));
+        if (mask != 0) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+    return i + scan_for_either_scalar(data + i, size - i, a, b);
+}
+
+__attribute__((target("sse2")))
+size_t find_header_end_sse2(const char* data, size_t size) {
+    //every '\r' is a candidate, confirmed with the three bytes after it
+    const __m128i cr = _mm_set1_epi8('\r');
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, cr));
+        while (mask != 0) {
+            size_t pos = i + __builtin_ctz(mask);
+            if (header_end_at(data, size, pos)) {
+                return pos + 4;
+            }
+            mask &= mask - 1;
+        }
+    }
+    size_t tail = find_header_end_scalar(data + i, size - i);
+    return tail ? i + tail : 0;
+}
+
+__attribute__((target("sse2")))
+bool has_non_printable_sse2(const char* data, size_t size) {
+    //signed compare: bytes >= 0x80 are negative and fall below 0x20 as well
+    const __m128i space = _mm_set1_epi8(0x20);
+    const __m128i del = _mm_set1_epi8(0x7F);
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        __m128i bad = _mm_or_si128(_mm_cmplt_epi8(chunk, space), _mm_cmpeq_epi8(chunk, del));
+        if (_mm_movemask_epi8(bad) != 0) {
+            return true;
+        }
+    }
+    return has_non_printable_scalar(data + i, size - i);
+}
+
+__attribute__((target("avx2")))
+size_t scan_for_either_avx2(const char* data, size_t size, char a, char b) {
+    const __m256i va = _mm256_set1_epi8(a);
+    const __m256i vb = _mm256_set1_epi8(b);
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(
+            _mm256_or_si256(_mm256_cmpeq_epi8(chunk, va), _mm256_cmpeq_epi8(chunk, vb))));
+        if (mask != 0) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+    return i + scan_for_either_sse2(data + i, size - i, a, b);
+}
+
+__attribute__((target("avx2")))
+size_t find_header_end_avx2(const char* data, size_t size) {
+    const __m256i cr = _mm256_set1_epi8('\r');
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, cr)));
+        while (mask != 0) {
+            size_t pos = i + __builtin_ctz(mask);
+            if (header_end_at(data, size, pos)) {
+                return pos + 4;
+            }
+            mask &= mask - 1;
+        }
+    }
+    size_t tail = find_header_end_sse2(data + i, size - i);
+    return tail ? i + tail : 0;
+}
+
+__attribute__((target("avx2")))
+bool has_non_printable_avx2(const char* data, size_t size) {
+    const __m256i space = _mm256_set1_epi8(0x20);
+    const __m256i del = _mm256_set1_epi8(0x7F);
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        __m256i bad = _mm256_or_si256(_mm256_cmpgt_epi8(space, chunk), _mm256_cmpeq_epi8(chunk, del));
+        if (_mm256_movemask_epi8(bad) != 0) {
+            return true;
+        }
+    }
+    return has_non_printable_sse2(data + i, size - i);
+}
+
+#endif
+
+const ScanKernels SCALAR_KERNELS{scan_for_either_scalar, find_header_end_scalar, has_non_printable_scalar};
+#ifdef SIMD_SCAN_X86
+const ScanKernels SSE2_KERNELS{scan_for_either_sse2, find_header_end_sse2, has_non_printable_sse2};
+const ScanKernels AVX2_KERNELS{scan_for_either_avx2, find_header_end_avx2, has_non_printable_avx2};
+#endif
+
+SimdLevel detect_simd_level() {
+#ifdef SIMD_SCAN_X86
+    //runs during static initialization, before the CPU model is set up on its own
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return SimdLevel::AVX2;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return SimdLevel::SSE2;
+    }
+#endif
+    return SimdLevel::SCALAR;
+}
+
+const ScanKernels& kernels_for(SimdLevel level) {
+#ifdef SIMD_SCAN_X86
+    if (level == SimdLevel::AVX2) return AVX2_KERNELS;
+    if (level == SimdLevel::SSE2) return SSE2_KERNELS;
+#endif
+    (void)level;
+    return SCALAR_KERNELS;
+}
+
+const SimdLevel detected_level = detect_simd_level();
+SimdLevel active_level = detected_level;
+const ScanKernels* active_kernels = &kernels_for(detected_level);
+
+int hex_value(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+} // namespace
+
+SimdLevel detected_simd_level() {
+    return detected_level;
+}
+
+SimdLevel active_simd_level() {
+    return active_level;
+}
+
+bool select_simd_level(SimdLevel level) {
+    if (static_cast<int>(level) > static_cast<int>(detected_level)) {
+        return false;
+    }
+    active_level = level;
+    active_kernels = &kernels_for(level);
+    return true;
+}
+
+const char* simd_level_name(SimdLevel level) {
+    switch (level) {
+        case SimdLevel::AVX2: return "avx2";
+        case SimdLevel::SSE2: return "sse2";
+        default:              return "scalar";
+    }
+}
+
+size_t scan_for_either(const char* data, size_t size, char a, char b) {
+    return active_kernels->scan_for_either(data, size, a, b);
+}
+
+size_t find_header_end(const char* data, size_t size) {
+    return active_kernels->find_header_end(data, size);
+}
+
+bool has_non_printable(const char* data, size_t size) {
+    return active_kernels->has_non_printable(data, size);
+}
+
+template <typename String>
+void url_decode_into(std::string_view src, String& out) {
+    out.clear();
+    out.reserve(src.size());
+
+    //plain runs between escapes are found with the vector scan and copied in one go
+    size_t pos = 0;
+    while (pos < src.size()) {
+        size_t special = pos + scan_for_either(src.data() + pos, src.size() - pos, '%', '+');
+        out.append(src.data() + pos, special - pos);
+        if (special == src.size()) {
+            break;
+        }
+
+        if (src[special] == '+') {
+            out += ' ';
+            pos = special + 1;
+            continue;
+        }
+
+        int high = special + 2 < src.size() ? hex_value(src[special + 1]) : -1;
+        int low = high >= 0 ? hex_value(src[special + 2]) : -1;
+        if (low >= 0) {
+            out += static_cast<char>(high * 16 + low);
+            pos = special + 3;
+        } else {
+            out += '%';
+            pos = special + 1;
+        }
+    }
+}
+
+template void url_decode_into(std::string_view src, std::string& out);
+template void url_decode_into(std::string_view src, std::pmr::string& out);
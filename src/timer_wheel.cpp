@@ -0,0 +1,132 @@
+#include "timer_wheel.h"
+#include <algorithm>
+#include <limits>
+
+TimerWheel::TimerWheel(std::chrono::milliseconds tick, Clock::time_point start)
+    : start_(start), tick_(tick), current_tick_(0), pending_(0), inner_pending_(0) {
+}
+
+uint64_t TimerWheel::to_tick(Clock::time_point time) const {
+    if (time <= start_) {
+        return 0;
+    }
+    return static_cast<uint64_t>((time - start_) / tick_);
+}
+
+void TimerWheel::schedule(const Timer& timer, Clock::time_point deadline) {
+    //round up so a timer never fires before its deadline
+    uint64_t deadline_tick = 0;
+    if (deadline > start_) {
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - start_);
+        deadline_tick = static_cast<uint64_t>((elapsed + tick_ - std::chrono::milliseconds(1)) / tick_);
+    }
+
+    place(Entry{timer, deadline_tick});
+    pending_++;
+}
+
+void TimerWheel::place(const Entry& entry) {
+    Entry placed = entry;
+
+    //ticks up to current_tick_ have been processed, the next one is the earliest left
+    if (placed.deadline_tick <= current_tick_) {
+        placed.deadline_tick = current_tick_ + 1;
+    }
+
+    if (placed.deadline_tick - current_tick_ < INNER_SLOTS) {
+        inner_[placed.deadline_tick & (INNER_SLOTS - 1)].push_back(placed);
+        inner_pending_++;
+        return;
+    }
+
+    uint64_t block = placed.deadline_tick >> INNER_BITS;
+    uint64_t current_block = current_tick_ >> INNER_BITS;
+    if (block - current_block >= OUTER_SLOTS) {
+        block = current_block + OUTER_SLOTS - 1;
+        placed.deadline_tick = block << INNER_BITS;
+    }
+    outer_[block % OUTER_SLOTS].push_back(placed);
+}
+
+void TimerWheel::cascade() {
+    //current_tick_ just reached a block boundary, every entry of that block is due within
+    //the next turn of the inner wheel
+    auto& slot = outer_[(current_tick_ >> INNER_BITS) % OUTER_SLOTS];
+    for (const auto& entry : slot) {
+        inner_[entry.deadline_tick & (INNER_SLOTS - 1)].push_back(entry);
+    }
+    inner_pending_ += slot.size();
+    slot.clear();
+}
+
+void TimerWheel::advance(Clock::time_point now, std::vector<Timer>& expired) {
+    uint64_t target = to_tick(now);
+
+    while (current_tick_ < target) {
+        if (pending_ == 0) {
+            current_tick_ = target;
+            break;
+        }
+
+        //nothing in the inner wheel, jump straight to the next cascade
+        if (inner_pending_ == 0) {
+            uint64_t next_block = ((current_tick_ >> INNER_BITS) + 1) << INNER_BITS;
+            current_tick_ = std::min(target, next_block - 1);
+            if (current_tick_ == target) {
+                break;
+            }
+        }
+
+        current_tick_++;
+        if ((current_tick_ & (INNER_SLOTS - 1)) == 0) {
+            cascade();
+        }
+
+        auto& slot = inner_[current_tick_ & (INNER_SLOTS - 1)];
+        for (const auto& entry : slot) {
+            expired.push_back(entry.timer);
+        }
+        inner_pending_ -= slot.size();
+        pending_ -= slot.size();
+        slot.clear();
+    }
+}
+
+int TimerWheel::next_timeout_ms(Clock::time_point now) const {
+    if (pending_ == 0) {
+        return -1;
+    }
+
+    //an entry rescheduled into the inner wheel can be due after an older one still waiting
+    //in the outer wheel, so the earlier of the two candidates wins
+    uint64_t next_tick = std::numeric_limits<uint64_t>::max();
+    if (inner_pending_ > 0) {
+        for (uint64_t offset = 1; offset <= INNER_SLOTS; ++offset) {
+            if (!inner_[(current_tick_ + offset) & (INNER_SLOTS - 1)].empty()) {
+                next_tick = current_tick_ + offset;
+                break;
+            }
+        }
+    }
+    if (pending_ > inner_pending_) {
+        //outer entries fire no earlier than the cascade of their block
+        uint64_t current_block = current_tick_ >> INNER_BITS;
+        for (uint64_t offset = 1; offset <= OUTER_SLOTS; ++offset) {
+            if (!outer_[(current_block + offset) % OUTER_SLOTS].empty()) {
+                next_tick = std::min(next_tick, (current_block + offset) << INNER_BITS);
+                break;
+            }
+        }
+    }
+
+    auto due = start_ + next_tick * tick_;
+    if (due <= now) {
+        return 0;
+    }
+
+    auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(due - now);
+    if (due - now > remaining) {
+        remaining += std::chrono::milliseconds(1);
+    }
+    return static_cast<int>(std::min<int64_t>(remaining.count(), std::numeric_limits<int>::max()));
+}
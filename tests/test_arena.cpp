@@ -0,0 +1,196 @@
+#include <gtest/gtest.h>
+#include "arena.h"
+#include "http_parser.h"
+#include "http_request.h"
+#include "http_response.h"
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <optional>
+
+// Counting allocator: every operator new in the test binary goes through here, and calls
+// made on this thread while counting is on are tallied
+namespace {
+thread_local bool counting = false;
+thread_local size_t allocation_count = 0;
+} // namespace
+
+void* operator new(size_t size) {
+    if (counting) {
+        allocation_count++;
+    }
+    if (void* ptr = std::malloc(size ? size : 1)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    std::free(ptr);
+}
+
+// std::pmr::new_delete_resource() allocates through the aligned forms
+void* operator new(size_t size, std::align_val_t alignment) {
+    if (counting) {
+        allocation_count++;
+    }
+    size_t align = static_cast<size_t>(alignment);
+    if (void* ptr = std::aligned_alloc(align, (size + align - 1) / align * align)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t, std::align_val_t) noexcept {
+    std::free(ptr);
+}
+
+namespace {
+
+const std::string REQUEST =
+    "GET /static/js/app.3f9c2b.js?v=42&lang=en HTTP/1.1\r\n"
+    "Host: www.example.com\r\n"
+    "Connection: keep-alive\r\n"
+    "User-Agent: Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36 (KHTML, like Gecko) Chrome/124.0.0.0 Safari/537.36\r\n"
+    "Accept: */*\r\n"
+    "Referer: https://www.example.com/\r\n"
+    "Accept-Encoding: gzip, deflate, br, zstd\r\n"
+    "Accept-Language: en-US,en;q=0.9\r\n"
+    "Cookie: session=8f14e45fceea167a5a36dedd4bea2543; theme=dark\r\n"
+    "\r\n";
+
+// What a connection does for one request: an owned copy of the parsed request, a
+// response for it and its headers serialized into a reused output buffer
+void serve_one(const RequestView& view, std::string& out) {
+    HttpRequest request = HttpRequest::from_view(view);
+    HttpResponse response(HttpStatus::OK);
+    response.set_content_type("application/javascript; charset=utf-8");
+    response.set_body("console.log('hello');\n");
+    response.set_header(HeaderId::CACHE_CONTROL, "public, max-age=31536000, immutable");
+    response.set_keep_alive(request.is_keep_alive());
+    out.clear();
+    response.serialize_headers(out);
+}
+
+// Heap allocations per request, after a warm-up that lets the arena and out grow
+double allocations_per_request(const std::shared_ptr<Arena>& arena) {
+    RequestView view;
+    size_t consumed = 0;
+    EXPECT_EQ(RequestView::parse(REQUEST, view, consumed), ParseStatus::COMPLETE);
+
+    std::string out;
+    constexpr int WARM_UP = 10;
+    constexpr int REQUESTS = 1000;
+    for (int i = 0; i < WARM_UP + REQUESTS; ++i) {
+        if (i == WARM_UP) {
+            allocation_count = 0;
+            counting = true;
+        }
+        if (arena) {
+            arena->reset();
+        }
+        ArenaScope scope(arena);
+        serve_one(view, out);
+    }
+    counting = false;
+    return static_cast<double>(allocation_count) / REQUESTS;
+}
+
+} // namespace
+
+TEST(ArenaTest, AlignsAndReusesTheFirstBlock) {
+    Arena arena(1024);
+    char* first = static_cast<char*>(arena.allocate(3, 1));
+    for (size_t alignment : {2, 4, 8, 16, 64}) {
+        void* ptr = arena.allocate(5, alignment);
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(ptr) % alignment, 0u) << alignment;
+    }
+    EXPECT_EQ(arena.bytes_allocated(), 3u + 5 * 5);
+
+    arena.reset();
+    EXPECT_EQ(arena.bytes_allocated(), 0u);
+    EXPECT_EQ(arena.allocate(3, 1), first);
+}
+
+TEST(ArenaTest, GrowsPastTheFirstBlock) {
+    Arena arena(1024);
+    std::pmr::string big(4000, 'x', &arena);
+    std::pmr::vector<int> numbers(&arena);
+    for (int i = 0; i < 2000; ++i) {
+        numbers.push_back(i);
+    }
+    EXPECT_EQ(std::string_view(big), std::string(4000, 'x'));
+    EXPECT_EQ(numbers[1999], 1999);
+    EXPECT_GE(arena.bytes_allocated(), 4000u + 2000 * sizeof(int));
+}
+
+TEST(ArenaTest, ObjectsFollowTheScopeTheyWereCreatedIn) {
+    auto arena = std::make_shared<Arena>();
+    RequestView view;
+    size_t consumed = 0;
+    ASSERT_EQ(RequestView::parse(REQUEST, view, consumed), ParseStatus::COMPLETE);
+
+    std::optional<HttpRequest> moved;
+    HttpRequest copied;
+    {
+        ArenaScope scope(arena);
+        HttpRequest request = HttpRequest::from_view(view);
+        EXPECT_GT(arena->bytes_allocated(), 0u);
+
+        // a copy lives on the heap and does not keep the arena, a move stays in it
+        copied = request;
+        EXPECT_EQ(arena.use_count(), 3);
+        moved.emplace(std::move(request));
+    }
+    EXPECT_EQ(arena.use_count(), 2);
+    EXPECT_EQ(moved->get_header(HeaderId::HOST), "www.example.com");
+    EXPECT_EQ(moved->get_query_param("lang"), "en");
+
+    moved.reset();
+    EXPECT_EQ(arena.use_count(), 1);
+    arena->reset();
+    EXPECT_EQ(copied.get_path(), "/static/js/app.3f9c2b.js");
+    EXPECT_EQ(copied.get_header("user-agent").substr(0, 11), "Mozilla/5.0");
+}
+
+TEST(ArenaTest, FewerMallocsPerRequest) {
+    double heap = allocations_per_request(nullptr);
+    double arena = allocations_per_request(std::make_shared<Arena>());
+
+    std::cout << "[ mallocs  ] per request: " << heap << " on the heap, " << arena << " with an arena" << std::endl;
+    RecordProperty("mallocs_per_request_heap", std::to_string(heap));
+    RecordProperty("mallocs_per_request_arena", std::to_string(arena));
+
+    EXPECT_GT(heap, 10);
+    EXPECT_LT(arena, heap / 2);
+    // status line, Date and MIME type come from constant tables and a per-thread cache
+    EXPECT_EQ(arena, 0);
+}
+
+TEST(ArenaTest, ParsedRequestsDoNotTouchTheHeap) {
+    RequestView view;
+    size_t consumed = 0;
+    ASSERT_EQ(RequestView::parse(REQUEST, view, consumed), ParseStatus::COMPLETE);
+
+    // the first round allocates the arena's block
+    auto arena = std::make_shared<Arena>();
+    for (int round = 0; round < 3; ++round) {
+        arena->reset();
+        ArenaScope scope(arena);
+        allocation_count = 0;
+        counting = round > 0;
+        HttpRequest request = HttpRequest::from_view(view);
+        counting = false;
+        EXPECT_EQ(allocation_count, 0u) << "round " << round;
+        EXPECT_TRUE(request.is_valid());
+    }
+}
@@ -0,0 +1,82 @@
+#include <gtest/gtest.h>
+#include "byte_range.h"
+#include "http_date.h"
+
+TEST(ByteRangeTest, SingleRanges) {
+    std::vector<ByteRange> ranges;
+
+    ASSERT_EQ(parse_range_header("bytes=0-499", 1000, ranges), RangeResult::SATISFIABLE);
+    ASSERT_EQ(ranges.size(), 1u);
+    EXPECT_EQ(ranges[0].first, 0u);
+    EXPECT_EQ(ranges[0].last, 499u);
+    EXPECT_EQ(ranges[0].length(), 500u);
+
+    // open and suffix ranges are resolved against the size
+    ASSERT_EQ(parse_range_header("bytes=900-", 1000, ranges), RangeResult::SATISFIABLE);
+    EXPECT_EQ(ranges[0].first, 900u);
+    EXPECT_EQ(ranges[0].last, 999u);
+    ASSERT_EQ(parse_range_header("bytes=-100", 1000, ranges), RangeResult::SATISFIABLE);
+    EXPECT_EQ(ranges[0].first, 900u);
+    ASSERT_EQ(parse_range_header("bytes=-5000", 1000, ranges), RangeResult::SATISFIABLE);
+    EXPECT_EQ(ranges[0].first, 0u);
+
+    // the last byte is clamped to the end
+    ASSERT_EQ(parse_range_header("Bytes = 500-5000", 1000, ranges), RangeResult::NONE);
+    ASSERT_EQ(parse_range_header("BYTES=500-5000", 1000, ranges), RangeResult::SATISFIABLE);
+    EXPECT_EQ(ranges[0].last, 999u);
+}
+
+TEST(ByteRangeTest, MultipleRangesAreMerged) {
+    std::vector<ByteRange> ranges;
+
+    ASSERT_EQ(parse_range_header("bytes=500-599, 0-99", 1000, ranges), RangeResult::SATISFIABLE);
+    ASSERT_EQ(ranges.size(), 2u);
+    // disjoint ranges keep the order they were asked for in
+    EXPECT_EQ(ranges[0].first, 500u);
+    EXPECT_EQ(ranges[1].first, 0u);
+
+    ASSERT_EQ(parse_range_header("bytes=0-99,50-199,-1", 1000, ranges), RangeResult::SATISFIABLE);
+    ASSERT_EQ(ranges.size(), 2u);
+    EXPECT_EQ(ranges[0].first, 0u);
+    EXPECT_EQ(ranges[0].last, 199u);
+    EXPECT_EQ(ranges[1].first, 999u);
+}
+
+TEST(ByteRangeTest, UnsatisfiableAndMalformed) {
+    std::vector<ByteRange> ranges;
+
+    EXPECT_EQ(parse_range_header("bytes=1000-", 1000, ranges), RangeResult::UNSATISFIABLE);
+    EXPECT_EQ(parse_range_header("bytes=2000-3000,-0", 1000, ranges), RangeResult::UNSATISFIABLE);
+    EXPECT_TRUE(ranges.empty());
+
+    EXPECT_EQ(parse_range_header("", 1000, ranges), RangeResult::NONE);
+    EXPECT_EQ(parse_range_header("items=0-1", 1000, ranges), RangeResult::NONE);
+    EXPECT_EQ(parse_range_header("bytes=", 1000, ranges), RangeResult::NONE);
+    EXPECT_EQ(parse_range_header("bytes=5-1", 1000, ranges), RangeResult::NONE);
+    EXPECT_EQ(parse_range_header("bytes=a-b", 1000, ranges), RangeResult::NONE);
+    EXPECT_EQ(parse_range_header("bytes=0-1,x", 1000, ranges), RangeResult::NONE);
+    EXPECT_EQ(parse_range_header("bytes=+1-2", 1000, ranges), RangeResult::NONE);
+
+    std::string many = "bytes=0-0";
+    for (size_t i = 1; i <= MAX_RANGES; ++i) {
+        many += "," + std::to_string(i * 2) + "-" + std::to_string(i * 2);
+    }
+    EXPECT_EQ(parse_range_header(many, 1000, ranges), RangeResult::NONE);
+}
+
+TEST(ByteRangeTest, ContentRange) {
+    EXPECT_EQ(content_range({0, 499}, 1234), "bytes 0-499/1234");
+}
+
+TEST(HttpDateTest, FormatsAndParsesAllThreeFormats) {
+    EXPECT_EQ(format_http_date(784111777), "Sun, 06 Nov 1994 08:49:37 GMT");
+
+    EXPECT_EQ(parse_http_date("Sun, 06 Nov 1994 08:49:37 GMT"), std::optional<time_t>(784111777));
+    EXPECT_EQ(parse_http_date("Sunday, 06-Nov-94 08:49:37 GMT"), std::optional<time_t>(784111777));
+    EXPECT_EQ(parse_http_date("Sun Nov  6 08:49:37 1994"), std::optional<time_t>(784111777));
+
+    EXPECT_FALSE(parse_http_date(""));
+    EXPECT_FALSE(parse_http_date("\"etag\""));
+    EXPECT_FALSE(parse_http_date("Sun, 06 Foo 1994 08:49:37 GMT"));
+    EXPECT_FALSE(parse_http_date("Sun, 06 Nov 1994 25:49:37 GMT"));
+}
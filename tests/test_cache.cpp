@@ -2,6 +2,7 @@
 #include "cache.h"
 #include <thread>
 #include <chrono>
+#include <atomic>
 
 class CacheTest : public ::testing::Test {
 protected:
@@ -21,15 +22,48 @@ TEST_F(CacheTest, BasicPutAndGet) {
     cache->put("test_key", data, "text/plain");
     
     auto result = cache->get("test_key");
-    EXPECT_TRUE(result.has_value());
+    EXPECT_NE(result, nullptr);
     EXPECT_EQ(result->data, data);
     EXPECT_EQ(result->content_type, "text/plain");
-    EXPECT_EQ(result->access_count, 2); // 1 for put, 1 for get
+    EXPECT_EQ(result->access_count.load(), 2u); // 1 for put, 1 for get
+}
+
+TEST_F(CacheTest, StoresTheResponseHead) {
+    std::vector<char> data = {'t', 'e', 's', 't'};
+    cache->put("plain", data, "text/plain");
+    cache->put("served", data, "text/plain", "HTTP/1.1 200 OK\r\nContent-Length: 4\r\n");
+    
+    EXPECT_TRUE(cache->get("plain")->head.empty());
+    auto result = cache->get("served");
+    ASSERT_TRUE(result && !result->head.empty());
+    EXPECT_EQ(result->head, "HTTP/1.1 200 OK\r\nContent-Length: 4\r\n");
+    EXPECT_EQ(cache->get_size(), 2 * data.size() + result->head.size());
+}
+
+TEST_F(CacheTest, EntriesAreSharedNotCopied) {
+    std::vector<char> data(4096, 'x');
+    const char* bytes = data.data();
+    
+    // moved in, the entry owns the very buffer that was read
+    auto stored = cache->put("key", std::move(data), "text/plain");
+    ASSERT_NE(stored, nullptr);
+    EXPECT_EQ(stored->data.data(), bytes);
+    
+    auto hit = cache->get("key");
+    EXPECT_EQ(hit, stored);
+    EXPECT_EQ(shared_data(hit)->data(), bytes);
+    EXPECT_EQ(shared_head(hit), nullptr);
+    
+    // replacing the entry leaves the one handed out intact
+    cache->put("key", std::vector<char>(10, 'y'), "text/plain");
+    EXPECT_EQ(hit->data.size(), 4096u);
+    EXPECT_EQ(hit->data[0], 'x');
+    EXPECT_EQ(cache->get("key")->data.size(), 10u);
 }
 
 TEST_F(CacheTest, MissCase) {
     auto result = cache->get("nonexistent_key");
-    EXPECT_FALSE(result.has_value());
+    EXPECT_EQ(result, nullptr);
 }
 
 TEST_F(CacheTest, OverwriteExisting) {
@@ -40,7 +74,7 @@ TEST_F(CacheTest, OverwriteExisting) {
     cache->put("key", data2, "text/html");
     
     auto result = cache->get("key");
-    EXPECT_TRUE(result.has_value());
+    EXPECT_NE(result, nullptr);
     EXPECT_EQ(result->data, data2);
     EXPECT_EQ(result->content_type, "text/html");
 }
@@ -51,23 +85,23 @@ TEST_F(CacheTest, TTLExpiration) {
     
     // Should exist immediately
     auto result1 = cache->get("ttl_key");
-    EXPECT_TRUE(result1.has_value());
+    EXPECT_NE(result1, nullptr);
     
     // Wait for TTL to expire
     std::this_thread::sleep_for(std::chrono::seconds(3));
     
     // Should be expired now
     auto result2 = cache->get("ttl_key");
-    EXPECT_FALSE(result2.has_value());
+    EXPECT_EQ(result2, nullptr);
 }
 
 TEST_F(CacheTest, LRUEviction) {
-    // Use small cache for eviction testing
-    LRUCache small_cache(0.001, 0); // Very small cache, no TTL
+    // One 1MB shard holds two of these entries but not three, no TTL
+    LRUCache small_cache(1, 0, EvictionPolicyType::LRU, 1);
     
-    std::vector<char> data1(100, 'a');
-    std::vector<char> data2(100, 'b');
-    std::vector<char> data3(100, 'c');
+    std::vector<char> data1(400 * 1024, 'a');
+    std::vector<char> data2(400 * 1024, 'b');
+    std::vector<char> data3(400 * 1024, 'c');
     
     small_cache.put("key1", data1, "text/plain");
     small_cache.put("key2", data2, "text/plain");
@@ -78,9 +112,9 @@ TEST_F(CacheTest, LRUEviction) {
     // Add key3, should evict key2 (least recently used)
     small_cache.put("key3", data3, "text/plain");
     
-    EXPECT_TRUE(small_cache.get("key1").has_value());
-    EXPECT_FALSE(small_cache.get("key2").has_value());
-    EXPECT_TRUE(small_cache.get("key3").has_value());
+    EXPECT_NE(small_cache.get("key1"), nullptr);
+    EXPECT_EQ(small_cache.get("key2"), nullptr);
+    EXPECT_NE(small_cache.get("key3"), nullptr);
 }
 
 TEST_F(CacheTest, Statistics) {
@@ -116,6 +150,66 @@ TEST_F(CacheTest, ClearCache) {
     
     EXPECT_EQ(cache->get_count(), 0);
     EXPECT_EQ(cache->get_size(), 0);
-    EXPECT_FALSE(cache->get("key1").has_value());
-    EXPECT_FALSE(cache->get("key2").has_value());
-}
\ No newline at end of file
+    EXPECT_EQ(cache->get("key1"), nullptr);
+    EXPECT_EQ(cache->get("key2"), nullptr);
+}
+
+TEST_F(CacheTest, ShardCountFollowsCapacity) {
+    // a 1MB cache is too small to split
+    EXPECT_EQ(cache->get_shard_count(), 1u);
+    
+    LRUCache sharded(256, 0);
+    EXPECT_EQ(sharded.get_shard_count(), LRUCache::DEFAULT_SHARD_COUNT);
+    LRUCache partly(16, 0);
+    EXPECT_EQ(partly.get_shard_count(), 16 * 1024 * 1024 / LRUCache::MIN_SHARD_SIZE);
+}
+
+TEST_F(CacheTest, ReferencedEntriesSurviveEviction) {
+    LRUCache small_cache(1, 0);
+    std::vector<char> data(300 * 1024, 'x');
+    
+    small_cache.put("key1", data, "text/plain");
+    small_cache.put("key2", data, "text/plain");
+    small_cache.put("key3", data, "text/plain");
+    ASSERT_NE(small_cache.get("key1"), nullptr);
+    
+    // key1 was hit since it went in, so key2 goes instead
+    small_cache.put("key4", data, "text/plain");
+    EXPECT_NE(small_cache.get("key1"), nullptr);
+    EXPECT_EQ(small_cache.get("key2"), nullptr);
+    EXPECT_NE(small_cache.get("key3"), nullptr);
+    EXPECT_NE(small_cache.get("key4"), nullptr);
+}
+
+TEST_F(CacheTest, ConcurrentHitsAndPuts) {
+    LRUCache shared_cache(64, 0);
+    std::vector<char> data(1024, 'x');
+    for (int i = 0; i < 100; ++i) {
+        shared_cache.put("key" + std::to_string(i), data, "text/plain");
+    }
+    
+    std::atomic<size_t> hits{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 8; ++t) {
+        threads.emplace_back([&shared_cache, &hits, &data, t] {
+            for (int i = 0; i < 2000; ++i) {
+                std::string key = "key" + std::to_string((i * 7 + t) % 100);
+                if (i % 50 == 0) {
+                    shared_cache.put(key, data, "text/plain");
+                } else if (shared_cache.get(key)) {
+                    hits++;
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    
+    size_t cache_hits, misses, entries, memory_usage;
+    shared_cache.get_stats(cache_hits, misses, entries, memory_usage);
+    EXPECT_EQ(cache_hits, hits.load());
+    EXPECT_EQ(misses, 0u);
+    EXPECT_EQ(entries, 100u);
+    EXPECT_EQ(memory_usage, 100 * data.size());
+}
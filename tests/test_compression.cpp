@@ -0,0 +1,72 @@
+#include <gtest/gtest.h>
+#include "compression.h"
+#include <string>
+#include <zlib.h>
+
+namespace {
+
+std::string gunzip(const std::vector<char>& compressed) {
+    z_stream stream{};
+    EXPECT_EQ(inflateInit2(&stream, 15 + 16), Z_OK);
+    std::string out(1 << 20, '\0');
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(compressed.data()));
+    stream.avail_in = static_cast<uInt>(compressed.size());
+    stream.next_out = reinterpret_cast<Bytef*>(&out[0]);
+    stream.avail_out = static_cast<uInt>(out.size());
+    EXPECT_EQ(inflate(&stream, Z_FINISH), Z_STREAM_END);
+    out.resize(stream.total_out);
+    inflateEnd(&stream);
+    return out;
+}
+
+} // namespace
+
+TEST(CompressionTest, AcceptEncodingNegotiation) {
+    EXPECT_TRUE(accepts_gzip("gzip"));
+    EXPECT_TRUE(accepts_gzip("gzip, deflate, br, zstd"));
+    EXPECT_TRUE(accepts_gzip("br;q=1.0, GZIP;q=0.5"));
+    EXPECT_TRUE(accepts_gzip("x-gzip"));
+    EXPECT_TRUE(accepts_gzip("*"));
+    EXPECT_TRUE(accepts_gzip("gzip;q=0.001"));
+
+    EXPECT_FALSE(accepts_gzip(""));
+    EXPECT_FALSE(accepts_gzip("identity"));
+    EXPECT_FALSE(accepts_gzip("deflate, br"));
+    EXPECT_FALSE(accepts_gzip("gzip;q=0"));
+    EXPECT_FALSE(accepts_gzip("gzip; q=0.000"));
+    // a refusal is not overridden by the wildcard
+    EXPECT_FALSE(accepts_gzip("*, gzip;q=0"));
+    EXPECT_FALSE(accepts_gzip("*;q=0"));
+}
+
+TEST(CompressionTest, SkipsCompressedFormats) {
+    EXPECT_TRUE(is_compressible("text/html; charset=utf-8"));
+    EXPECT_TRUE(is_compressible("application/javascript"));
+    EXPECT_TRUE(is_compressible("application/json"));
+    EXPECT_TRUE(is_compressible("image/svg+xml"));
+
+    EXPECT_FALSE(is_compressible("image/png"));
+    EXPECT_FALSE(is_compressible("video/mp4"));
+    EXPECT_FALSE(is_compressible("application/zip"));
+    EXPECT_FALSE(is_compressible("application/gzip"));
+    EXPECT_FALSE(is_compressible("font/woff2"));
+    EXPECT_FALSE(is_compressible("application/octet-stream"));
+}
+
+TEST(CompressionTest, GzipRoundTrip) {
+    std::string text;
+    for (int i = 0; i < 2000; ++i) {
+        text += "body { margin: 0; padding: " + std::to_string(i % 10) + "px; }\n";
+    }
+
+    std::vector<char> compressed;
+    ASSERT_TRUE(gzip_compress(text.data(), text.size(), compressed));
+    ASSERT_GE(compressed.size(), 2u);
+    EXPECT_EQ(static_cast<unsigned char>(compressed[0]), 0x1f);
+    EXPECT_EQ(static_cast<unsigned char>(compressed[1]), 0x8b);
+    EXPECT_LT(compressed.size(), text.size() / 10);
+    EXPECT_EQ(gunzip(compressed), text);
+
+    ASSERT_TRUE(gzip_compress("", 0, compressed));
+    EXPECT_EQ(gunzip(compressed), "");
+}
@@ -0,0 +1,68 @@
+#include <gtest/gtest.h>
+#include "server.h"
+
+class ConnectionTableTest : public ::testing::Test {
+protected:
+    ConnectionTable table;
+};
+
+TEST_F(ConnectionTableTest, LookupByFdAndGeneration) {
+    const auto& conn = table.insert(7, nullptr);
+    ASSERT_TRUE(conn);
+    EXPECT_EQ(conn->fd, 7);
+
+    EXPECT_EQ(table.get(7, conn->generation), conn);
+    EXPECT_FALSE(table.get(7, conn->generation + 1));
+    EXPECT_FALSE(table.get(8, conn->generation));
+    EXPECT_FALSE(table.get(-1, 0));
+}
+
+TEST_F(ConnectionTableTest, ReusedFdGetsNewGeneration) {
+    std::shared_ptr<Connection> old_conn = table.insert(5, nullptr);
+    uint32_t old_generation = old_conn->generation;
+
+    table.release(5);
+    EXPECT_FALSE(table.get(5, old_generation));
+
+    const auto& new_conn = table.insert(5, nullptr);
+    EXPECT_NE(new_conn->generation, old_generation);
+    EXPECT_NE(new_conn, old_conn);
+
+    // events still queued for the old socket must not reach the new one
+    EXPECT_FALSE(table.get(5, old_generation));
+    EXPECT_EQ(table.get(5, new_conn->generation), new_conn);
+}
+
+TEST_F(ConnectionTableTest, GrowsForLargeFds) {
+    const auto& conn = table.insert(50000, nullptr);
+    EXPECT_EQ(table.get(50000, conn->generation), conn);
+
+    size_t count = 0;
+    table.for_each([&count](const std::shared_ptr<Connection>&) { count++; });
+    EXPECT_EQ(count, 1u);
+}
+
+TEST_F(ConnectionTableTest, RecyclesReleasedConnections) {
+    table.preallocate(2);
+
+    Connection* first = table.insert(3, nullptr).get();
+    first->buffer = "partial request";
+    first->closed = true;
+    table.release(3);
+
+    const auto& reused = table.insert(4, nullptr);
+    EXPECT_EQ(reused.get(), first);
+    EXPECT_EQ(reused->fd, 4);
+    EXPECT_TRUE(reused->buffer.empty());
+    EXPECT_FALSE(reused->closed);
+}
+
+TEST_F(ConnectionTableTest, KeepsConnectionsHeldByWorkers) {
+    std::shared_ptr<Connection> held = table.insert(3, nullptr);
+    table.release(3);
+
+    // a worker still owns it, so it must not be handed out again
+    const auto& next = table.insert(3, nullptr);
+    EXPECT_NE(next, held);
+    EXPECT_EQ(held->fd, 3);
+}
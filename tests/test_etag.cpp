@@ -0,0 +1,36 @@
+#include <gtest/gtest.h>
+#include "etag.h"
+#include <string>
+
+TEST(EtagTest, FileTagsFollowInodeMtimeAndSize) {
+    struct stat file_stat{};
+    file_stat.st_ino = 42;
+    file_stat.st_size = 1000;
+    file_stat.st_mtim.tv_sec = 784111777;
+
+    std::string tag = file_etag(file_stat);
+    EXPECT_EQ(tag.front(), '"');
+    EXPECT_EQ(tag.back(), '"');
+    EXPECT_EQ(tag, file_etag(file_stat));
+    EXPECT_NE(tag, file_etag(file_stat, true));
+    file_stat.st_mtim.tv_nsec = 1;
+    EXPECT_NE(tag, file_etag(file_stat));
+    file_stat.st_mtim.tv_nsec = 0;
+    file_stat.st_size = 1001;
+    EXPECT_NE(tag, file_etag(file_stat));
+}
+
+TEST(EtagTest, ListMatching) {
+    EXPECT_TRUE(etag_list_matches("\"abc\"", "\"abc\"", true));
+    EXPECT_TRUE(etag_list_matches("\"x\", W/\"abc\"", "\"abc\"", true));
+    EXPECT_TRUE(etag_list_matches("*", "\"abc\"", true));
+    EXPECT_TRUE(etag_list_matches("\"a,b\" , \"abc\"", "\"abc\"", true));
+    EXPECT_FALSE(etag_list_matches("\"abcd\"", "\"abc\"", true));
+    EXPECT_FALSE(etag_list_matches("abc", "\"abc\"", true));
+    EXPECT_FALSE(etag_list_matches("\"abc\"", "", true));
+
+    // strong comparison never matches a weak tag
+    EXPECT_TRUE(etag_list_matches("\"abc\"", "\"abc\"", false));
+    EXPECT_FALSE(etag_list_matches("W/\"abc\"", "\"abc\"", false));
+    EXPECT_FALSE(etag_list_matches("\"abc\"", "W/\"abc\"", false));
+}
@@ -0,0 +1,115 @@
+#include <gtest/gtest.h>
+#include "cache.h"
+#include "eviction_policy.h"
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr size_t ENTRY_SIZE = 16 * 1024;
+
+// A lookup, then a put on a miss, the way the file handler uses the cache
+void request(LRUCache& cache, const std::string& key) {
+    if (!cache.get(key)) {
+        cache.put(key, std::vector<char>(ENTRY_SIZE, 'x'), "text/plain");
+    }
+}
+
+// Builds a hot set in a one-shard 4MB cache, crawls four times that many bytes of cold files,
+// and returns how many hot files are still cached
+size_t hot_files_after_scan(EvictionPolicyType policy) {
+    LRUCache cache(4, 0, policy, 1);
+    for (int round = 0; round < 4; ++round) {
+        for (int i = 0; i < 100; ++i) {
+            request(cache, "/hot-" + std::to_string(i));
+        }
+    }
+    for (int i = 0; i < 1000; ++i) {
+        request(cache, "/cold-" + std::to_string(i));
+    }
+
+    size_t cached = 0;
+    for (int i = 0; i < 100; ++i) {
+        if (cache.get("/hot-" + std::to_string(i))) {
+            ++cached;
+        }
+    }
+    return cached;
+}
+
+} // namespace
+
+TEST(EvictionPolicyTest, ParsesConfigNames) {
+    for (EvictionPolicyType type : {EvictionPolicyType::LRU, EvictionPolicyType::S3_FIFO, EvictionPolicyType::W_TINY_LFU}) {
+        EXPECT_EQ(parse_eviction_policy(eviction_policy_name(type)), type);
+    }
+    EXPECT_EQ(parse_eviction_policy("s3-fifo"), EvictionPolicyType::S3_FIFO);
+    EXPECT_FALSE(parse_eviction_policy("LRU").has_value());
+    EXPECT_FALSE(parse_eviction_policy("arc").has_value());
+    EXPECT_FALSE(parse_eviction_policy("").has_value());
+}
+
+TEST(EvictionPolicyTest, ScanFlushesLru) {
+    EXPECT_LT(hot_files_after_scan(EvictionPolicyType::LRU), 10u);
+}
+
+TEST(EvictionPolicyTest, S3FifoKeepsHotSetThroughScan) {
+    EXPECT_EQ(hot_files_after_scan(EvictionPolicyType::S3_FIFO), 100u);
+}
+
+TEST(EvictionPolicyTest, WTinyLfuKeepsHotSetThroughScan) {
+    EXPECT_EQ(hot_files_after_scan(EvictionPolicyType::W_TINY_LFU), 100u);
+}
+
+TEST(EvictionPolicyTest, AccountingStaysExactUnderEveryPolicy) {
+    for (EvictionPolicyType policy : {EvictionPolicyType::LRU, EvictionPolicyType::S3_FIFO, EvictionPolicyType::W_TINY_LFU}) {
+        LRUCache cache(4, 0, policy, 1);
+        for (int i = 0; i < 600; ++i) {
+            request(cache, "/file-" + std::to_string(i % 300));
+            if (i % 7 == 0) {
+                cache.remove("/file-" + std::to_string(i % 50));
+            }
+            if (i % 11 == 0) {
+                //replacing an entry must not leave its old node queued
+                cache.put("/file-" + std::to_string(i % 300), std::vector<char>(ENTRY_SIZE / 2, 'y'), "text/plain");
+            }
+        }
+
+        size_t hits, misses, entries, memory_usage;
+        cache.get_stats(hits, misses, entries, memory_usage);
+        EXPECT_LE(memory_usage, 4u * 1024 * 1024) << eviction_policy_name(policy);
+        EXPECT_GT(entries, 0u) << eviction_policy_name(policy);
+
+        //every cached entry can still be evicted, so the shard drains completely
+        cache.set_max_size(1);
+        request(cache, "/after-shrink");
+        EXPECT_LE(cache.get_size(), 1u * 1024 * 1024) << eviction_policy_name(policy);
+        EXPECT_NE(cache.get("/after-shrink"), nullptr) << eviction_policy_name(policy);
+    }
+}
+
+TEST(CountMinSketchTest, CountsAndSaturates) {
+    CountMinSketch sketch(1024);
+    for (int i = 0; i < 5; ++i) {
+        sketch.increment(1);
+    }
+    EXPECT_EQ(sketch.estimate(1), 5);
+    EXPECT_EQ(sketch.estimate(2), 0);
+
+    for (int i = 0; i < 100; ++i) {
+        sketch.increment(3);
+    }
+    EXPECT_EQ(sketch.estimate(3), 15);
+}
+
+TEST(CountMinSketchTest, HalvesCountsAsItAges) {
+    //one expected entry, so every 10 increments age the counts
+    CountMinSketch sketch(1);
+    for (int i = 0; i < 8; ++i) {
+        sketch.increment(1);
+    }
+    sketch.increment(2);
+    sketch.increment(2);
+    EXPECT_EQ(sketch.estimate(1), 4);
+    EXPECT_EQ(sketch.estimate(2), 1);
+}
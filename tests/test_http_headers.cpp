@@ -0,0 +1,91 @@
+#include <gtest/gtest.h>
+#include "http_headers.h"
+#include <algorithm>
+#include <cctype>
+
+TEST(HeaderLookupTest, EveryKnownNameResolvesInAnyCase) {
+    for (size_t i = 0; i < KNOWN_HEADER_COUNT; ++i) {
+        HeaderId id = static_cast<HeaderId>(i);
+        std::string name(header_name(id));
+        ASSERT_FALSE(name.empty());
+        EXPECT_EQ(lookup_header(name), id) << name;
+
+        std::string lower = name;
+        std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+        EXPECT_EQ(lookup_header(lower), id) << lower;
+
+        std::string upper = name;
+        std::transform(upper.begin(), upper.end(), upper.begin(), ::toupper);
+        EXPECT_EQ(lookup_header(upper), id) << upper;
+    }
+}
+
+TEST(HeaderLookupTest, OtherNamesAreUnknown) {
+    EXPECT_EQ(lookup_header(""), HeaderId::UNKNOWN);
+    EXPECT_EQ(lookup_header("X-Custom"), HeaderId::UNKNOWN);
+    EXPECT_EQ(lookup_header("Hast"), HeaderId::UNKNOWN);
+    EXPECT_EQ(lookup_header("Content-Lengthy"), HeaderId::UNKNOWN);
+    EXPECT_EQ(lookup_header("Sec-Fetch-Mode"), HeaderId::UNKNOWN);
+    EXPECT_EQ(lookup_header(std::string(200, 'a')), HeaderId::UNKNOWN);
+}
+
+TEST(HeaderMapTest, SetAndGet) {
+    HeaderMap headers;
+    headers.set(HeaderId::HOST, "localhost");
+    headers.set("content-length", "42");
+    headers.set("X-Custom", "one");
+
+    EXPECT_EQ(headers.size(), 3u);
+    EXPECT_EQ(headers.get(HeaderId::HOST), "localhost");
+    EXPECT_EQ(headers.get("HOST"), "localhost");
+    EXPECT_EQ(headers.get(HeaderId::CONTENT_LENGTH), "42");
+    EXPECT_EQ(headers.get("x-custom"), "one");
+    EXPECT_TRUE(headers.has("X-CUSTOM"));
+    EXPECT_FALSE(headers.has(HeaderId::RANGE));
+    EXPECT_EQ(headers.get(HeaderId::RANGE), "");
+    EXPECT_EQ(headers.get("X-Other"), "");
+
+    // setting again replaces the value in place
+    headers.set("Host", "example.com");
+    headers.set("x-custom", "two");
+    EXPECT_EQ(headers.size(), 3u);
+    EXPECT_EQ(headers.get(HeaderId::HOST), "example.com");
+    EXPECT_EQ(headers.get("X-Custom"), "two");
+
+    headers.clear();
+    EXPECT_TRUE(headers.empty());
+    EXPECT_FALSE(headers.has(HeaderId::HOST));
+}
+
+TEST(HeaderMapTest, IteratesInInsertionOrderWithCanonicalNames) {
+    HeaderMap headers;
+    headers.set("content-type", "text/html");
+    headers.set("X-Custom", "1");
+    headers.set(HeaderId::DATE, "today");
+
+    std::string serialized;
+    headers.for_each([&](std::string_view name, std::string_view value) {
+        serialized.append(name).append(": ").append(value).append("\n");
+    });
+    EXPECT_EQ(serialized, "Content-Type: text/html\nX-Custom: 1\nDate: today\n");
+}
+
+TEST(HeaderMapTest, RemoveKeepsTheOtherFieldsReachable) {
+    HeaderMap headers;
+    headers.set(HeaderId::CONTENT_LENGTH, "5");
+    headers.set(HeaderId::TRANSFER_ENCODING, "chunked");
+    headers.set(HeaderId::DATE, "today");
+    headers.set("X-Custom", "1");
+
+    headers.remove(HeaderId::CONTENT_LENGTH);
+    headers.remove(HeaderId::HOST);
+    EXPECT_EQ(headers.size(), 3u);
+    EXPECT_FALSE(headers.has(HeaderId::CONTENT_LENGTH));
+    EXPECT_EQ(headers.get(HeaderId::TRANSFER_ENCODING), "chunked");
+    EXPECT_EQ(headers.get(HeaderId::DATE), "today");
+    EXPECT_EQ(headers.get("x-custom"), "1");
+
+    headers.set(HeaderId::DATE, "tomorrow");
+    EXPECT_EQ(headers.size(), 3u);
+    EXPECT_EQ(headers.get(HeaderId::DATE), "tomorrow");
+}
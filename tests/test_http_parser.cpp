@@ -0,0 +1,209 @@
+#include <gtest/gtest.h>
+#include "http_parser.h"
+#include <vector>
+
+class RequestViewTest : public ::testing::Test {
+protected:
+    RequestView request;
+    size_t consumed = 0;
+};
+
+TEST_F(RequestViewTest, ViewsPointIntoTheBuffer) {
+    std::string raw = "GET /search?q=a%20b HTTP/1.1\r\n"
+                      "Host: localhost\r\n"
+                      "Accept:  text/html \r\n"
+                      "\r\n";
+
+    ASSERT_EQ(RequestView::parse(raw, request, consumed), ParseStatus::COMPLETE);
+    EXPECT_EQ(consumed, raw.size());
+    EXPECT_EQ(request.method, HttpMethod::GET);
+    EXPECT_EQ(request.path, "/search");
+    EXPECT_EQ(request.query, "q=a%20b");
+    EXPECT_EQ(request.version, "HTTP/1.1");
+    EXPECT_EQ(request.header("accept"), "text/html");
+    EXPECT_EQ(request.header("HOST"), "localhost");
+    EXPECT_FALSE(request.has_header("cookie"));
+
+    // nothing is copied
+    EXPECT_GE(request.path.data(), raw.data());
+    EXPECT_LT(request.path.data(), raw.data() + raw.size());
+}
+
+TEST_F(RequestViewTest, IncompleteUntilHeadersAndBodyArrive) {
+    std::string raw = "POST /submit HTTP/1.1\r\n"
+                      "Content-Length: 5\r\n"
+                      "\r\n"
+                      "hello";
+
+    for (size_t size = 0; size < raw.size(); ++size) {
+        EXPECT_EQ(RequestView::parse(std::string_view(raw).substr(0, size), request, consumed),
+                  ParseStatus::INCOMPLETE) << "at " << size << " bytes";
+    }
+
+    ASSERT_EQ(RequestView::parse(raw, request, consumed), ParseStatus::COMPLETE);
+    EXPECT_EQ(request.body, "hello");
+    EXPECT_EQ(request.content_length, 5u);
+}
+
+TEST_F(RequestViewTest, ConsumesOnlyTheFirstPipelinedRequest) {
+    std::string first = "GET /a HTTP/1.1\r\nHost: x\r\n\r\n";
+    std::string raw = first + "GET /b HTTP/1.1\r\nHost: x\r\n\r\n";
+
+    ASSERT_EQ(RequestView::parse(raw, request, consumed), ParseStatus::COMPLETE);
+    EXPECT_EQ(consumed, first.size());
+    EXPECT_EQ(request.path, "/a");
+    EXPECT_TRUE(request.body.empty());
+}
+
+TEST_F(RequestViewTest, RejectsUnframeableRequests) {
+    EXPECT_EQ(RequestView::parse("POST / HTTP/1.1\r\nContent-Length: 12abc\r\n\r\n", request, consumed),
+              ParseStatus::INVALID);
+
+    std::string many_headers = "GET / HTTP/1.1\r\n";
+    for (size_t i = 0; i <= RequestView::MAX_HEADERS; ++i) {
+        many_headers += "X-Header-" + std::to_string(i) + ": value\r\n";
+    }
+    many_headers += "\r\n";
+    EXPECT_EQ(RequestView::parse(many_headers, request, consumed), ParseStatus::INVALID);
+}
+
+TEST_F(RequestViewTest, MalformedRequestLineStillFrames) {
+    ASSERT_EQ(RequestView::parse("INVALID\r\n\r\n", request, consumed), ParseStatus::COMPLETE);
+    EXPECT_EQ(request.method, HttpMethod::UNKNOWN);
+    EXPECT_TRUE(request.path.empty());
+}
+
+class RequestParserTest : public ::testing::Test {
+protected:
+    RequestParser parser;
+};
+
+TEST_F(RequestParserTest, ResumesAcrossReadsAndBufferMoves) {
+    std::string raw = "POST /submit?x=1 HTTP/1.1\r\n"
+                      "Host: localhost\r\n"
+                      "Content-Length: 5\r\n"
+                      "\r\n"
+                      "hello";
+
+    // one byte per read, with the buffer reallocated along the way
+    std::string buffer;
+    for (size_t i = 0; i + 1 < raw.size(); ++i) {
+        buffer += raw[i];
+        if (i % 7 == 0) {
+            buffer.shrink_to_fit();
+        }
+        ASSERT_EQ(parser.parse(buffer), ParseStatus::INCOMPLETE) << "at " << buffer.size() << " bytes";
+    }
+    buffer += raw.back();
+    buffer += "GET /next HTTP/1.1\r\n";
+    buffer.shrink_to_fit();
+
+    ASSERT_EQ(parser.parse(buffer), ParseStatus::COMPLETE);
+    EXPECT_EQ(parser.consumed(), raw.size());
+    const RequestView& request = parser.request();
+    EXPECT_EQ(request.method, HttpMethod::POST);
+    EXPECT_EQ(request.path, "/submit");
+    EXPECT_EQ(request.query, "x=1");
+    EXPECT_EQ(request.header("host"), "localhost");
+    EXPECT_EQ(request.body, "hello");
+    EXPECT_GE(request.path.data(), buffer.data());
+    EXPECT_LT(request.path.data(), buffer.data() + buffer.size());
+
+    // the views follow a reallocation after completion as well
+    buffer.reserve(buffer.capacity() * 4);
+    ASSERT_EQ(parser.parse(buffer), ParseStatus::COMPLETE);
+    EXPECT_EQ(parser.request().header("HOST"), "localhost");
+    EXPECT_EQ(parser.request().body, "hello");
+    EXPECT_GE(parser.request().path.data(), buffer.data());
+
+    // the pipelined request behind it starts from scratch
+    buffer.erase(0, parser.consumed());
+    parser.reset();
+    EXPECT_EQ(parser.parse(buffer), ParseStatus::INCOMPLETE);
+    buffer += "\r\n";
+    ASSERT_EQ(parser.parse(buffer), ParseStatus::COMPLETE);
+    EXPECT_EQ(parser.request().path, "/next");
+}
+
+TEST_F(RequestParserTest, DecodesChunkedBodies) {
+    std::string raw = "POST /upload HTTP/1.1\r\n"
+                      "Transfer-Encoding: chunked\r\n"
+                      "Content-Length: 999\r\n"
+                      "\r\n"
+                      "5;name=value\r\nhello\r\n"
+                      "7\r\n, world\r\n"
+                      "0\r\n"
+                      "X-Trailer: ignored\r\n"
+                      "\r\n";
+    std::string next = "GET / HTTP/1.1\r\n\r\n";
+
+    std::string buffer;
+    for (size_t i = 0; i + 1 < raw.size(); ++i) {
+        buffer += raw[i];
+        ASSERT_EQ(parser.parse(buffer), ParseStatus::INCOMPLETE) << "at " << buffer.size() << " bytes";
+    }
+    buffer += raw.back();
+    buffer += next;
+
+    ASSERT_EQ(parser.parse(buffer), ParseStatus::COMPLETE);
+    EXPECT_EQ(parser.consumed(), raw.size());
+    EXPECT_EQ(parser.request().body, "hello, world");
+    EXPECT_EQ(parser.request().content_length, 12u);
+}
+
+TEST_F(RequestParserTest, RejectsUnframeableBodies) {
+    EXPECT_EQ(parser.parse("POST / HTTP/1.1\r\nTransfer-Encoding: gzip\r\n\r\n"), ParseStatus::INVALID);
+
+    parser.reset();
+    EXPECT_EQ(parser.parse("POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\nzz\r\n"), ParseStatus::INVALID);
+
+    parser.reset();
+    EXPECT_EQ(parser.parse("POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n3\r\nabcd\r\n"), ParseStatus::INVALID);
+
+    parser.reset();
+    EXPECT_EQ(parser.parse("POST / HTTP/1.1\r\nContent-Length: -1\r\n\r\n"), ParseStatus::INVALID);
+}
+
+TEST_F(RequestParserTest, StreamsBodiesToAConsumer) {
+    struct Collector : BodyConsumer {
+        std::string data;
+        bool finished = false;
+        bool consume(const char* bytes, size_t size) override { data.append(bytes, size); return true; }
+        bool finish() override { finished = true; return true; }
+    };
+
+    for (bool chunked : {false, true}) {
+        std::string head = chunked ? "POST /upload HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n"
+                                   : "POST /upload HTTP/1.1\r\nContent-Length: 26\r\n\r\n";
+        std::vector<std::string> pieces = chunked
+            ? std::vector<std::string>{"a\r\nabcdefghij\r\n", "10\r\nklmnop", "qrstuvwxyz\r\n0\r\n\r\n"}
+            : std::vector<std::string>{"abcdefghij", "klmnop", "qrstuvwxyz"};
+        std::string next = "GET /next HTTP/1.1\r\n\r\n";
+
+        parser.reset();
+        Collector collector;
+        std::string buffer = head + pieces[0];
+        ASSERT_EQ(parser.parse(buffer), ParseStatus::INCOMPLETE);
+        ASSERT_TRUE(parser.receiving_body());
+        parser.stream_body(&collector);
+        parser.parse(buffer);
+
+        // only the head stays buffered, however much of the body has gone through
+        for (size_t i = 1; i < pieces.size(); ++i) {
+            parser.discard_streamed(buffer);
+            EXPECT_EQ(buffer.size(), head.size()) << "chunked " << chunked;
+            buffer += pieces[i];
+            if (i + 1 == pieces.size()) {
+                buffer += next;
+            }
+            parser.parse(buffer);
+        }
+
+        ASSERT_EQ(parser.parse(buffer), ParseStatus::COMPLETE) << "chunked " << chunked;
+        parser.discard_streamed(buffer);
+        EXPECT_EQ(collector.data, "abcdefghijklmnopqrstuvwxyz");
+        EXPECT_TRUE(collector.finished);
+        EXPECT_TRUE(parser.request().body.empty());
+        EXPECT_EQ(buffer.substr(parser.consumed()), next);
+    }
+}
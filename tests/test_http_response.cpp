@@ -1,5 +1,9 @@
 #include <gtest/gtest.h>
 #include "http_response.h"
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <unistd.h>
 
 class HttpResponseTest : public ::testing::Test {
 protected:
@@ -43,6 +47,30 @@ TEST_F(HttpResponseTest, StatusTextMapping) {
     EXPECT_EQ(HttpResponse::get_status_text(HttpStatus::NOT_FOUND), "Not Found");
     EXPECT_EQ(HttpResponse::get_status_text(HttpStatus::INTERNAL_SERVER_ERROR), "Internal Server Error");
     EXPECT_EQ(HttpResponse::get_status_text(HttpStatus::BAD_REQUEST), "Bad Request");
+    EXPECT_EQ(HttpResponse::get_status_text(static_cast<HttpStatus>(418)), "Unknown");
+    
+    EXPECT_EQ(HttpResponse(static_cast<HttpStatus>(418)).serialize_headers().substr(0, 22), "HTTP/1.1 418 Unknown\r\n");
+    EXPECT_EQ(HttpResponse::get_mime_type(".PNG"), "image/png");
+}
+
+TEST_F(HttpResponseTest, DateHeaderMatchesStrftime) {
+    time_t before = time(nullptr);
+    std::string date(HttpResponse::current_date());
+    time_t after = time(nullptr);
+    
+    // formatted by hand, so compare against the C library for either second it may be from
+    std::vector<std::string> expected;
+    for (time_t second : {before, after}) {
+        char buffer[64];
+        struct tm tm;
+        gmtime_r(&second, &tm);
+        strftime(buffer, sizeof(buffer), "%a, %d %b %Y %H:%M:%S GMT", &tm);
+        expected.push_back(buffer);
+    }
+    EXPECT_TRUE(date == expected[0] || date == expected[1]) << date;
+    
+    HttpResponse response;
+    EXPECT_EQ(response.get_header(HeaderId::DATE).size(), 29u);
 }
 
 TEST_F(HttpResponseTest, HeaderManagement) {
@@ -67,4 +95,143 @@ TEST_F(HttpResponseTest, FileResponse) {
     std::string response_str = response.to_string();
     EXPECT_TRUE(response_str.find("Content-Type: text/html; charset=utf-8") != std::string::npos);
     EXPECT_TRUE(response_str.find("<h1>Test</h1>") != std::string::npos);
-}
\ No newline at end of file
+}
+
+TEST_F(HttpResponseTest, FileBodyIsNotSerialized) {
+    int fd = open("/dev/null", O_RDONLY | O_CLOEXEC);
+    ASSERT_NE(fd, -1);
+    
+    {
+        HttpResponse response(HttpStatus::OK);
+        response.set_file_body(std::make_shared<OpenFile>(fd), 100, 5000);
+        
+        EXPECT_EQ(response.get_body_size(), 5000u);
+        ASSERT_TRUE(response.get_file_body());
+        EXPECT_EQ(response.get_file_body()->offset, 100);
+        
+        std::string headers = response.serialize_headers();
+        EXPECT_TRUE(headers.find("Content-Length: 5000") != std::string::npos);
+        EXPECT_EQ(headers.substr(headers.size() - 4), "\r\n\r\n");
+        EXPECT_EQ(response.to_string(), headers);
+        
+        // a copy keeps the file open after the original drops it
+        HttpResponse copy = response;
+        response.set_body("");
+        EXPECT_FALSE(response.get_file_body());
+        EXPECT_NE(fcntl(fd, F_GETFD), -1);
+    }
+    
+    // closed together with the last response referencing it
+    EXPECT_EQ(fcntl(fd, F_GETFD), -1);
+}
+
+TEST_F(HttpResponseTest, SharedBodyIsReferencedInPlace) {
+    auto data = std::make_shared<const std::vector<char>>(std::vector<char>{'c', 'a', 'c', 'h', 'e', 'd'});
+    
+    HttpResponse response(HttpStatus::OK);
+    response.set_shared_body(data);
+    EXPECT_EQ(response.get_body_size(), 6u);
+    EXPECT_EQ(data.use_count(), 2);
+    
+    std::vector<iovec> iov;
+    response.append_body_iovecs(iov);
+    ASSERT_EQ(iov.size(), 1u);
+    EXPECT_EQ(iov[0].iov_base, data->data());
+    EXPECT_EQ(iov[0].iov_len, 6u);
+    
+    std::string response_str = response.to_string();
+    EXPECT_TRUE(response_str.find("Content-Length: 6") != std::string::npos);
+    EXPECT_EQ(response_str.substr(response_str.size() - 6), "cached");
+    
+    response.set_body("");
+    EXPECT_EQ(data.use_count(), 1);
+}
+
+TEST_F(HttpResponseTest, SerializedResponseSendsItsStoredHead) {
+    std::vector<char> content = {'b', 'o', 'd', 'y'};
+    HttpResponse original = HttpResponse::create_file_response("app.js", content);
+    original.set_header(HeaderId::X_CACHE, "HIT");
+    
+    auto head = std::make_shared<const std::string>(original.serialize_fixed_headers());
+    EXPECT_EQ(head->rfind("HTTP/1.1 200 OK\r\n", 0), 0u);
+    EXPECT_TRUE(head->find("Content-Length: 4\r\n") != std::string::npos);
+    EXPECT_TRUE(head->find("Date:") == std::string::npos);
+    EXPECT_TRUE(head->find("Connection:") == std::string::npos);
+    
+    auto data = std::make_shared<const std::vector<char>>(content);
+    HttpResponse response = HttpResponse::create_serialized_response(head, data);
+    response.set_keep_alive(true);
+    EXPECT_EQ(response.get_body_size(), 4u);
+    
+    std::string headers;
+    response.serialize_headers(headers);
+    EXPECT_EQ(headers.compare(0, head->size(), *head), 0);
+    EXPECT_EQ(std::string_view(headers).substr(head->size(), 6), "Date: ");
+    EXPECT_TRUE(headers.find("Connection: keep-alive\r\n") != std::string::npos);
+    EXPECT_EQ(headers.find("Content-Length"), headers.rfind("Content-Length"));
+    EXPECT_EQ(headers.substr(headers.size() - 4), "\r\n\r\n");
+    
+    // the body goes out from the shared buffer
+    std::vector<iovec> iov;
+    response.append_body_iovecs(iov);
+    ASSERT_EQ(iov.size(), 1u);
+    EXPECT_EQ(iov[0].iov_base, data->data());
+}
+
+TEST_F(HttpResponseTest, OmittedBodyKeepsItsLength) {
+    HttpResponse response(HttpStatus::OK);
+    response.set_body("twelve bytes");
+    response.omit_body();
+    
+    EXPECT_EQ(response.get_body_size(), 0u);
+    EXPECT_EQ(response.get_header(HeaderId::CONTENT_LENGTH), "12");
+    std::string response_str = response.to_string();
+    EXPECT_EQ(response_str.substr(response_str.size() - 4), "\r\n\r\n");
+}
+
+TEST_F(HttpResponseTest, GeneratedBodyIsChunkedAndRunLazily) {
+    int calls = 0;
+    HttpResponse response(HttpStatus::OK);
+    response.set_body("replaced");
+    response.set_generated_body([&calls](char* buffer, size_t capacity) -> size_t {
+        calls++;
+        if (calls > 2 || capacity < 5) {
+            return 0;
+        }
+        memcpy(buffer, "piece", 5);
+        return 5;
+    });
+    
+    EXPECT_TRUE(response.has_generated_body());
+    EXPECT_EQ(response.get_header(HeaderId::TRANSFER_ENCODING), "chunked");
+    EXPECT_EQ(response.get_header(HeaderId::CONTENT_LENGTH), "");
+    EXPECT_EQ(response.get_body_size(), 0u);
+    EXPECT_EQ(calls, 0);
+    
+    BodyGenerator generator = response.take_generated_body();
+    char buffer[16];
+    std::string body;
+    while (size_t length = generator(buffer, sizeof(buffer))) {
+        body.append(buffer, length);
+    }
+    EXPECT_EQ(body, "piecepiece");
+}
+
+TEST_F(HttpResponseTest, HeadOfAGeneratedBodyNeverRunsIt) {
+    bool ran = false;
+    HttpResponse response(HttpStatus::OK);
+    response.set_generated_body([&ran](char*, size_t) -> size_t {
+        ran = true;
+        return 0;
+    });
+    response.omit_body();
+    
+    EXPECT_FALSE(response.has_generated_body());
+    EXPECT_EQ(response.get_header(HeaderId::TRANSFER_ENCODING), "chunked");
+    EXPECT_FALSE(ran);
+    
+    // any other body replaces the chunked framing
+    response.set_body("fixed");
+    EXPECT_EQ(response.get_header(HeaderId::TRANSFER_ENCODING), "");
+    EXPECT_EQ(response.get_header(HeaderId::CONTENT_LENGTH), "5");
+}
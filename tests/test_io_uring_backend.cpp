@@ -0,0 +1,146 @@
+#include <gtest/gtest.h>
+#include "io_uring_backend.h"
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <cstring>
+#include <string>
+
+class IoUringBackendTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        //kernels without io_uring (ENOSYS), older than 6.0, or sandboxes that filter the syscalls
+        if (!backend.init()) {
+            GTEST_SKIP() << "io_uring is not available here";
+        }
+
+        listen_fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+        ASSERT_GE(listen_fd, 0);
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        ASSERT_EQ(bind(listen_fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)), 0);
+        ASSERT_EQ(listen(listen_fd, 16), 0);
+        socklen_t length = sizeof(address);
+        ASSERT_EQ(getsockname(listen_fd, reinterpret_cast<sockaddr*>(&address), &length), 0);
+        port = ntohs(address.sin_port);
+    }
+
+    void TearDown() override {
+        for (int fd : {client_fd, accepted_fd, listen_fd}) {
+            if (fd >= 0) {
+                close(fd);
+            }
+        }
+    }
+
+    int connect_client() {
+        int fd = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        address.sin_port = htons(port);
+        EXPECT_EQ(connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)), 0);
+        return fd;
+    }
+
+    // Waits up to a second per call for an event on fd that matches
+    template <typename Predicate>
+    bool wait_for(int fd, Predicate matches, IoBackend::Event& found) {
+        for (int attempt = 0; attempt < 10; ++attempt) {
+            int count = backend.wait_for_events(events, 100);
+            for (int i = 0; i < count; ++i) {
+                if (events[i].fd == fd && matches(events[i])) {
+                    found = events[i];
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    IoUringBackend backend;
+    std::vector<IoBackend::Event> events;
+    int listen_fd = -1;
+    int client_fd = -1;
+    int accepted_fd = -1;
+    uint16_t port = 0;
+};
+
+TEST_F(IoUringBackendTest, AcceptsAndReceivesWithoutSyscallsPerConnection) {
+    ASSERT_TRUE(backend.add_listener(listen_fd));
+    client_fd = connect_client();
+
+    IoBackend::Event event{};
+    ASSERT_TRUE(wait_for(listen_fd, [](const IoBackend::Event& e) { return e.accepted_fd >= 0; }, event));
+    accepted_fd = event.accepted_fd;
+
+    //the recv is multishot, every write shows up as its own payload
+    ASSERT_TRUE(backend.add_fd(accepted_fd, EPOLLIN, 7));
+    for (const std::string message : {"GET / HTTP/1.1\r\n\r\n", "second"}) {
+        ASSERT_EQ(write(client_fd, message.data(), message.size()), static_cast<ssize_t>(message.size()));
+        ASSERT_TRUE(wait_for(accepted_fd, [](const IoBackend::Event& e) { return e.payload != nullptr; }, event));
+        EXPECT_EQ(event.generation, 7u);
+        EXPECT_EQ(std::string(event.payload, event.payload_size), message);
+    }
+
+    //a closed peer is reported once the receive sees EOF
+    close(client_fd);
+    client_fd = -1;
+    ASSERT_TRUE(wait_for(accepted_fd, [](const IoBackend::Event& e) { return e.events & EPOLLRDHUP; }, event));
+}
+
+TEST_F(IoUringBackendTest, SubmitsSendsWithTheNextBatch) {
+    ASSERT_TRUE(backend.add_listener(listen_fd));
+    client_fd = connect_client();
+
+    IoBackend::Event event{};
+    ASSERT_TRUE(wait_for(listen_fd, [](const IoBackend::Event& e) { return e.accepted_fd >= 0; }, event));
+    accepted_fd = event.accepted_fd;
+    ASSERT_TRUE(backend.add_fd(accepted_fd, EPOLLIN, 3));
+
+    std::string head = "HTTP/1.1 200 OK\r\nContent-Length: 5\r\n\r\n";
+    std::string body = "hello";
+    iovec iov[] = {{&head[0], head.size()}, {&body[0], body.size()}};
+    msghdr message{};
+    message.msg_iov = iov;
+    message.msg_iovlen = 2;
+
+    //the owner is held until the kernel is done with the buffers
+    auto owner = std::make_shared<int>(0);
+    ASSERT_TRUE(backend.submit_send(accepted_fd, &message, MSG_NOSIGNAL, 3, owner));
+    EXPECT_GT(owner.use_count(), 1);
+
+    ASSERT_TRUE(wait_for(accepted_fd, [](const IoBackend::Event& e) { return e.send_completed; }, event));
+    EXPECT_EQ(event.generation, 3u);
+    EXPECT_EQ(event.send_result, static_cast<int>(head.size() + body.size()));
+    EXPECT_EQ(owner.use_count(), 1);
+
+    std::string received(head.size() + body.size(), '\0');
+    ASSERT_EQ(recv(client_fd, &received[0], received.size(), MSG_WAITALL), static_cast<ssize_t>(received.size()));
+    EXPECT_EQ(received, head + body);
+}
+
+TEST_F(IoUringBackendTest, DropsSendsForRemovedSockets) {
+    ASSERT_TRUE(backend.add_listener(listen_fd));
+    client_fd = connect_client();
+
+    IoBackend::Event event{};
+    ASSERT_TRUE(wait_for(listen_fd, [](const IoBackend::Event& e) { return e.accepted_fd >= 0; }, event));
+    accepted_fd = event.accepted_fd;
+    ASSERT_TRUE(backend.add_fd(accepted_fd, EPOLLIN, 1));
+
+    std::string data = "never sent";
+    iovec iov{&data[0], data.size()};
+    msghdr message{};
+    message.msg_iov = &iov;
+    message.msg_iovlen = 1;
+    auto owner = std::make_shared<int>(0);
+
+    //closed before the reactor got to submit it: no send, no event, the owner is let go
+    ASSERT_TRUE(backend.submit_send(accepted_fd, &message, MSG_NOSIGNAL, 1, owner));
+    ASSERT_TRUE(backend.remove_fd(accepted_fd));
+    EXPECT_FALSE(wait_for(accepted_fd, [](const IoBackend::Event& e) { return e.send_completed; }, event));
+    EXPECT_EQ(owner.use_count(), 1);
+}
@@ -0,0 +1,56 @@
+#include <gtest/gtest.h>
+#include "request_body.h"
+#include <sys/stat.h>
+#include <unistd.h>
+
+TEST(SpooledBodyTest, StaysInMemoryUpToTheLimit) {
+    SpooledBody body(16, 1024, "/tmp");
+    EXPECT_TRUE(body.consume("hello ", 6));
+    EXPECT_TRUE(body.consume("world", 5));
+    EXPECT_TRUE(body.finish());
+
+    EXPECT_TRUE(body.in_memory());
+    EXPECT_EQ(body.size(), 11u);
+    EXPECT_EQ(body.data(), "hello world");
+    EXPECT_EQ(body.file(), nullptr);
+}
+
+TEST(SpooledBodyTest, SpillsToAnUnlinkedTempFile) {
+    std::string expected;
+    SpooledBody body(1000, 1 << 20, "/tmp");
+    for (int i = 0; i < 5000; ++i) {
+        std::string piece = std::to_string(i) + ",";
+        expected += piece;
+        ASSERT_TRUE(body.consume(piece.data(), piece.size())) << body.error();
+    }
+    ASSERT_TRUE(body.finish()) << body.error();
+
+    EXPECT_FALSE(body.in_memory());
+    EXPECT_EQ(body.size(), expected.size());
+    ASSERT_NE(body.file(), nullptr);
+
+    struct stat st;
+    ASSERT_EQ(fstat(body.file()->fd(), &st), 0);
+    EXPECT_EQ(static_cast<size_t>(st.st_size), expected.size());
+    EXPECT_EQ(st.st_nlink, 0u);
+
+    std::string contents(expected.size(), '\0');
+    ASSERT_EQ(pread(body.file()->fd(), &contents[0], contents.size(), 0), static_cast<ssize_t>(contents.size()));
+    EXPECT_EQ(contents, expected);
+}
+
+TEST(SpooledBodyTest, RejectsBodiesOverTheMaximum) {
+    SpooledBody body(4, 10, "/tmp");
+    EXPECT_TRUE(body.consume("0123456789", 10));
+    EXPECT_FALSE(body.consume("x", 1));
+    EXPECT_FALSE(body.error().empty());
+    EXPECT_TRUE(body.too_large());
+}
+
+TEST(SpooledBodyTest, ReportsAMissingTempDir) {
+    SpooledBody body(4, 1024, "/nonexistent/upload/dir");
+    EXPECT_TRUE(body.consume("abc", 3));
+    EXPECT_FALSE(body.consume("defgh", 5));
+    EXPECT_NE(body.error().find("/nonexistent/upload/dir"), std::string::npos);
+    EXPECT_FALSE(body.too_large());
+}
@@ -0,0 +1,147 @@
+#include <gtest/gtest.h>
+#include "server.h"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include <climits>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+// A server on the loopback interface, configured by a config.json in a directory of its own
+class ServerTest : public ::testing::Test {
+protected:
+    void TearDown() override {
+        if (client_fd >= 0) {
+            close(client_fd);
+        }
+        if (server) {
+            server->stop();
+            server.reset();
+        }
+        if (!original_dir.empty()) {
+            ASSERT_EQ(chdir(original_dir.c_str()), 0);
+            std::filesystem::remove_all(work_dir);
+        }
+    }
+
+    void start_server(size_t max_upload_size, const std::string& upload_temp_dir) {
+        char cwd[PATH_MAX];
+        ASSERT_NE(getcwd(cwd, sizeof(cwd)), nullptr);
+        original_dir = cwd;
+        char dir_template[] = "/tmp/server-test-XXXXXX";
+        ASSERT_NE(mkdtemp(dir_template), nullptr);
+        work_dir = dir_template;
+        ASSERT_EQ(chdir(work_dir.c_str()), 0);
+
+        std::ofstream config("config.json");
+        config << "{\n"
+               << "  \"reactor_count\": 1,\n"
+               << "  \"max_upload_size\": " << max_upload_size << ",\n"
+               << "  \"upload_temp_dir\": \"" << upload_temp_dir << "\"\n"
+               << "}\n";
+        config.close();
+
+        port = free_port();
+        server = std::make_unique<Server>(port, "127.0.0.1", 2, 1);
+        ASSERT_TRUE(server->start());
+    }
+
+    static int free_port() {
+        int fd = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+        socklen_t length = sizeof(address);
+        getsockname(fd, reinterpret_cast<sockaddr*>(&address), &length);
+        close(fd);
+        return ntohs(address.sin_port);
+    }
+
+    void connect_client() {
+        client_fd = socket(AF_INET, SOCK_STREAM, 0);
+        timeval timeout{5, 0};
+        setsockopt(client_fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        address.sin_port = htons(port);
+        ASSERT_EQ(connect(client_fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)), 0);
+    }
+
+    // Sends until everything is out or the server stops reading
+    void send_all(const std::string& data) {
+        size_t sent = 0;
+        while (sent < data.size()) {
+            ssize_t result = send(client_fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+            if (result <= 0) {
+                return;
+            }
+            sent += result;
+        }
+    }
+
+    // The response head, empty when none arrives within five seconds
+    std::string read_head() {
+        std::string response;
+        char buffer[4096];
+        while (response.find("\r\n\r\n") == std::string::npos) {
+            ssize_t received = recv(client_fd, buffer, sizeof(buffer), 0);
+            if (received <= 0) {
+                return {};
+            }
+            response.append(buffer, received);
+        }
+        return response.substr(0, response.find("\r\n\r\n"));
+    }
+
+    std::unique_ptr<Server> server;
+    std::string original_dir;
+    std::string work_dir;
+    int port = 0;
+    int client_fd = -1;
+};
+
+TEST_F(ServerTest, RefusesADeclaredBodyOverTheLimitBeforeReadingIt) {
+    start_server(100000, "/tmp");
+    connect_client();
+
+    // not a byte of the body is sent, the head alone is answered
+    send_all("POST /api/upload HTTP/1.1\r\nHost: test\r\nContent-Length: 5000000000\r\n\r\n");
+    std::string head = read_head();
+    EXPECT_EQ(head.rfind("HTTP/1.1 413 ", 0), 0u) << head;
+    EXPECT_NE(head.find("Connection: close"), std::string::npos) << head;
+}
+
+TEST_F(ServerTest, RefusesAChunkedBodyThatOutgrowsTheLimit) {
+    start_server(100000, "/tmp");
+    connect_client();
+
+    std::string request = "POST /api/upload HTTP/1.1\r\nHost: test\r\nTransfer-Encoding: chunked\r\n\r\n";
+    for (int i = 0; i < 20; ++i) {
+        request += "4000\r\n" + std::string(0x4000, 'x') + "\r\n";
+    }
+    request += "0\r\n\r\n";
+    send_all(request);
+
+    std::string head = read_head();
+    EXPECT_EQ(head.rfind("HTTP/1.1 413 ", 0), 0u) << head;
+    EXPECT_NE(head.find("Connection: close"), std::string::npos) << head;
+}
+
+TEST_F(ServerTest, AnswersAnUploadThatCannotBeSpooledWith500) {
+    start_server(10 * 1024 * 1024, "/nonexistent/upload/dir");
+    connect_client();
+
+    // larger than what an upload keeps in memory, so it has to move to a temporary file
+    std::string body(1024 * 1024, 'x');
+    send_all("POST /api/upload HTTP/1.1\r\nHost: test\r\nContent-Length: " + std::to_string(body.size()) + "\r\n\r\n" + body);
+
+    std::string head = read_head();
+    EXPECT_EQ(head.rfind("HTTP/1.1 500 ", 0), 0u) << head;
+    EXPECT_NE(head.find("Connection: close"), std::string::npos) << head;
+}
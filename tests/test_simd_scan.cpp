@@ -0,0 +1,101 @@
+#include <gtest/gtest.h>
+#include "simd_scan.h"
+#include <random>
+#include <vector>
+
+class SimdScanTest : public ::testing::Test {
+protected:
+    void TearDown() override {
+        select_simd_level(detected_simd_level());
+    }
+
+    // every level this CPU can run, scalar first as the reference
+    std::vector<SimdLevel> supported_levels() const {
+        std::vector<SimdLevel> levels;
+        for (SimdLevel level : {SimdLevel::SCALAR, SimdLevel::SSE2, SimdLevel::AVX2}) {
+            if (static_cast<int>(level) <= static_cast<int>(detected_simd_level())) {
+                levels.push_back(level);
+            }
+        }
+        return levels;
+    }
+
+    // header-like text with the interesting bytes sprinkled in at random positions
+    std::string random_text(std::mt19937& rng, size_t size) const {
+        static const char alphabet[] = "abcdefghijklmnopqrstuvwxyz0123456789-/ =;,.%+:\r\n\x01\x7f\xc3";
+        std::uniform_int_distribution<size_t> pick(0, sizeof(alphabet) - 2);
+        std::string text(size, ' ');
+        for (char& c : text) {
+            c = alphabet[pick(rng)];
+        }
+        return text;
+    }
+};
+
+TEST_F(SimdScanTest, KernelsAgreeWithScalar) {
+    std::mt19937 rng(42);
+    for (size_t size = 0; size < 300; ++size) {
+        std::string text = random_text(rng, size);
+        // also plant a header terminator now and then, possibly straddling a vector boundary
+        if (size >= 8 && size % 3 == 0) {
+            text.replace(size / 2, 4, "\r\n\r\n");
+        }
+
+        select_simd_level(SimdLevel::SCALAR);
+        size_t expected_either = scan_for_either(text.data(), text.size(), ':', '\n');
+        size_t expected_end = find_header_end(text.data(), text.size());
+        bool expected_non_printable = has_non_printable(text.data(), text.size());
+
+        for (SimdLevel level : supported_levels()) {
+            ASSERT_TRUE(select_simd_level(level));
+            EXPECT_EQ(scan_for_either(text.data(), text.size(), ':', '\n'), expected_either)
+                << simd_level_name(level) << " size " << size;
+            EXPECT_EQ(find_header_end(text.data(), text.size()), expected_end)
+                << simd_level_name(level) << " size " << size;
+            EXPECT_EQ(has_non_printable(text.data(), text.size()), expected_non_printable)
+                << simd_level_name(level) << " size " << size;
+        }
+    }
+}
+
+TEST_F(SimdScanTest, FindsHeaderEnd) {
+    std::string head = "GET / HTTP/1.1\r\nHost: a-rather-long-host-name.example.com\r\n\r\nbody";
+    for (SimdLevel level : supported_levels()) {
+        select_simd_level(level);
+        EXPECT_EQ(find_header_end(head.data(), head.size()), head.size() - 4);
+        EXPECT_EQ(find_header_end(head.data(), head.size() - 5), 0u);
+    }
+}
+
+TEST_F(SimdScanTest, NonPrintableBytes) {
+    std::string path(100, 'a');
+    for (SimdLevel level : supported_levels()) {
+        select_simd_level(level);
+        EXPECT_FALSE(has_non_printable(path.data(), path.size()));
+        for (char bad : {'\x00', '\t', '\x1f', '\x7f', '\x80', '\xff'}) {
+            std::string tainted = path;
+            tainted[77] = bad;
+            EXPECT_TRUE(has_non_printable(tainted.data(), tainted.size())) << simd_level_name(level);
+        }
+    }
+}
+
+TEST_F(SimdScanTest, UrlDecode) {
+    std::string out;
+    for (SimdLevel level : supported_levels()) {
+        select_simd_level(level);
+
+        url_decode_into("/docs/getting%20started/index.html", out);
+        EXPECT_EQ(out, "/docs/getting started/index.html");
+
+        url_decode_into("a+b%2Bc%2fd", out);
+        EXPECT_EQ(out, "a b+c/d");
+
+        // malformed or truncated escapes stay as they are
+        url_decode_into("100%zz%4", out);
+        EXPECT_EQ(out, "100%zz%4");
+
+        url_decode_into("%41", out);
+        EXPECT_EQ(out, "A");
+    }
+}
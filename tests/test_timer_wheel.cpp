@@ -0,0 +1,96 @@
+#include <gtest/gtest.h>
+#include "timer_wheel.h"
+
+using namespace std::chrono_literals;
+
+class TimerWheelTest : public ::testing::Test {
+protected:
+    TimerWheel::Clock::time_point start = TimerWheel::Clock::now();
+    TimerWheel wheel{100ms, start};
+    std::vector<TimerWheel::Timer> expired;
+};
+
+TEST_F(TimerWheelTest, FiresAtDeadline) {
+    wheel.schedule({5, 1}, start + 1s);
+    EXPECT_EQ(wheel.size(), 1u);
+
+    wheel.advance(start + 900ms, expired);
+    EXPECT_TRUE(expired.empty());
+
+    wheel.advance(start + 1s, expired);
+    ASSERT_EQ(expired.size(), 1u);
+    EXPECT_EQ(expired[0].fd, 5);
+    EXPECT_EQ(expired[0].generation, 1u);
+    EXPECT_EQ(wheel.size(), 0u);
+}
+
+TEST_F(TimerWheelTest, NeverFiresEarly) {
+    wheel.schedule({1, 1}, start + 1050ms);
+
+    wheel.advance(start + 1050ms, expired);
+    EXPECT_TRUE(expired.empty());
+
+    wheel.advance(start + 1100ms, expired);
+    EXPECT_EQ(expired.size(), 1u);
+}
+
+TEST_F(TimerWheelTest, CascadesLongDeadlines) {
+    // beyond one turn of the inner wheel (25.6s at 100ms ticks)
+    wheel.schedule({1, 1}, start + 30s);
+    wheel.schedule({2, 1}, start + 300s);
+
+    wheel.advance(start + 29900ms, expired);
+    EXPECT_TRUE(expired.empty());
+
+    wheel.advance(start + 30s, expired);
+    ASSERT_EQ(expired.size(), 1u);
+    EXPECT_EQ(expired[0].fd, 1);
+
+    expired.clear();
+    wheel.advance(start + 299900ms, expired);
+    EXPECT_TRUE(expired.empty());
+
+    wheel.advance(start + 300s, expired);
+    ASSERT_EQ(expired.size(), 1u);
+    EXPECT_EQ(expired[0].fd, 2);
+}
+
+TEST_F(TimerWheelTest, ClampsDeadlinesBeyondRange) {
+    wheel.schedule({1, 1}, start + 24h);
+
+    // fires early at the end of the wheel's range, callers reschedule
+    wheel.advance(start + 2h, expired);
+    EXPECT_EQ(expired.size(), 1u);
+}
+
+TEST_F(TimerWheelTest, NextTimeoutFollowsEarliestDeadline) {
+    EXPECT_EQ(wheel.next_timeout_ms(start), -1);
+
+    wheel.schedule({1, 1}, start + 30s);
+    wheel.schedule({2, 1}, start + 2s);
+    EXPECT_EQ(wheel.next_timeout_ms(start), 2000);
+    EXPECT_EQ(wheel.next_timeout_ms(start + 1500ms), 500);
+
+    wheel.advance(start + 2s, expired);
+    EXPECT_EQ(expired.size(), 1u);
+
+    // only the outer wheel is populated, wake up at its cascade at the latest
+    int timeout = wheel.next_timeout_ms(start + 2s);
+    EXPECT_GT(timeout, 0);
+    EXPECT_LE(timeout, 28000);
+
+    // rescheduled into the inner wheel while an earlier deadline still waits in the outer one
+    wheel.advance(start + 10s, expired);
+    wheel.schedule({3, 1}, start + 34s);
+    timeout = wheel.next_timeout_ms(start + 10s);
+    EXPECT_GT(timeout, 0);
+    EXPECT_LE(timeout, 20000);
+
+    wheel.advance(start + 30s, expired);
+    EXPECT_EQ(expired.size(), 2u);
+    EXPECT_EQ(wheel.next_timeout_ms(start + 30s), 4000);
+
+    wheel.advance(start + 34s, expired);
+    EXPECT_EQ(expired.size(), 3u);
+    EXPECT_EQ(wheel.next_timeout_ms(start + 34s), -1);
+}